@@ -1,1001 +1,8639 @@
 #include <locale.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define AVALIADOR_AVX2 // Compila o caminho AVX2 do avaliador em lote, escolhido em tempo de execução.
+#endif
+#ifdef __GNUC__
+#define ESPECIALIZADA static inline __attribute__((always_inline)) // Corpo comum do motor; chamado com o tamanho do time constante, vira uma cópia por tamanho de mesa.
+#else
+#define ESPECIALIZADA static inline
+#endif
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#ifdef __linux__
+#include <errno.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
 
 #define NINGUEM_PEDIU_TRUCO -1   // Indica que nenhum time pediu truco na rodada.
 #define TIME_INICIANTE_PARTIDA 1 // Identificador para o Time 1.
 #define TIME_ADVERSARIO 2        // Identificador para o Time 2.
+#define MAX_JOGADORES_TIME 3     // Maior quantidade de jogadores por time (mesa de 6).
+#define PONTOS_PARA_VENCER 12    // Pontuação que encerra a partida.
+#define QTD_CARTAS_BARALHO 40    // Cartas do baralho de truco (sem 8, 9 e 10).
+#define BARALHO_COMPLETO ((1ULL << QTD_CARTAS_BARALHO) - 1) // Conjunto com as 40 cartas.
+#define MAX_THREADS 256          // Maior quantidade de threads de trabalho.
+#define TAMANHO_LOTE_PARTIDAS 64 // Partidas que uma thread pega de cada vez na simulação.
+#define QTD_MAOS_POSSIVEIS 9880  // Combinações de 3 cartas entre as 40 do baralho, C(40, 3).
+#define ARQUIVO_EQUIDADE "truco_equidade.bin" // Tabela de equidade carregada na inicialização, se existir.
+#define MAX_ACOES_LEGAIS 4       // Mais ações de um jogador em um estado: 3 cartas e o pedido de truco.
+#define MAX_NOS_MCTS 65536       // Nós da árvore de busca de uma decisão do robô MCTS.
+#define MAX_PROFUNDIDADE_MCTS 64 // Mais ações em uma mão: 18 cartas e os pedidos e respostas de truco.
+#define PERDA_VIRTUAL_MCTS 1     // Derrotas provisórias somadas a cada nó enquanto uma thread desce por ele.
+#define BITS_TRANSPOSICAO 16     // A tabela de transposição do resolvedor tem 2^16 entradas.
+#define MAX_RESULTADOS_BENCHMARK 32 // Medições guardadas por uma execução de --bench.
+#define TAMANHO_ENTRADA_CONEXAO 256  // Bytes de comandos ainda não processados de uma conexão do servidor.
+#define TAMANHO_SAIDA_CONEXAO 2048   // Bytes de mensagens ainda não enviadas a uma conexão do servidor.
+#define PRAZO_PADRAO_TURNO_MS 30000  // Tempo padrão para um jogador remoto agir antes que o servidor jogue por ele.
+#define LIMITE_BUFFER_HISTORICO 65536 // Registros acumulados por thread antes de gravar no arquivo de histórico.
+#define TAMANHO_LOTE_REGISTROS 65536  // Registros de histórico que uma thread pega de cada vez na análise.
+#define MAX_ARQUIVOS_ANALISE 64       // Arquivos de histórico aceitos por uma execução de --analyze.
+#define LIMITE_BUFFER_EVENTOS 65536   // Bytes de eventos em texto acumulados por thread antes de gravar no arquivo.
+#define TAMANHO_NOME 50               // Maior nome de jogador, com o terminador.
+#define MAX_NOMES_INTERNADOS 1024     // Nomes distintos guardados por 'internar_nome'.
+#define MAX_PARTICIPANTES_TORNEIO 64  // Robôs aceitos por uma execução de --tournament.
+#define ELO_INICIAL 1500.0            // Elo de um robô de força média no torneio.
+#define PISTAS_LOTE 32                // Mãos resolvidas juntas pelo avaliador em lote (32 bytes: um registrador AVX2).
+#define ARQUIVO_APOSTAS "truco_apostas.bin" // Tabela de apostas carregada na inicialização, se existir.
+#define QTD_FAIXAS_FORCA 10           // Faixas de força de mão da tabela de apostas (5 pela maior carta, vezes ter outra carta forte).
+#define QTD_ESTADOS_VAZA 9            // Estados de vaza da tabela de apostas: vaza (1 a 3) vezes atrás, empatado ou à frente.
+#define QTD_NIVEIS_APOSTA 4           // Valores da mão antes de um pedido na tabela de apostas (1, 3, 6 e 9).
+#define MAOS_TABELA_APOSTAS 2000000   // Mãos sorteadas para cada tamanho de mesa ao gerar a tabela de apostas.
+#define ARQUIVO_CFR "truco_cfr.bin"   // Estratégia treinada por --train-cfr, carregada na inicialização, se existir.
+#define QTD_CONJUNTOS_CFR (3 * QTD_FAIXAS_FORCA * QTD_ESTADOS_VAZA * 3 * QTD_NIVEIS_APOSTA * 3 * 2) // Conjuntos de informação da abstração do CFR.
+#define ESCALA_CFR 1024               // Arrependimento de 1 ponto no ponto fixo das tabelas do CFR.
+#define LIMITE_ARREPENDIMENTO (1 << 30) // Maior arrependimento (positivo ou negativo) guardado, longe do estouro de 32 bits.
+
+#define QTD_FAIXAS_LATENCIA 48        // Faixas do histograma de latência das decisões: a faixa i vai de 2^i a 2^(i+1) tiques.
+
+// Com -DINSTRUMENTACAO, cada thread conta e cronometra as fases do jogo (veja --profile);
+// sem ela, as macros abaixo não geram nenhum código.
+#ifdef INSTRUMENTACAO
+#define INICIAR_MEDICAO(nome) uint64_t nome = ler_relogio_instrumentacao()
+#define ENCERRAR_MEDICAO(fase, nome) registrar_medicao(fase, ler_relogio_instrumentacao() - (nome))
+#define CONTAR_FASE(fase) (instrumentacao_thread.contagens[fase]++)
+#else
+#define INICIAR_MEDICAO(nome) ((void)0)
+#define ENCERRAR_MEDICAO(fase, nome) ((void)0)
+#define CONTAR_FASE(fase) ((void)0)
+#endif
 
-static int gerador_semeado = 0;                                                  // Flag para garantir que o gerador de números aleatórios seja semeado apenas uma vez.
 const char NAIPES[] = {'O', 'E', 'C', 'P'};                                      // Array de caracteres representando os naipes das cartas (Ouros, Espadas, Copas, Paus).
 const char SIMBOLOS[] = {'0', '4', '5', '6', '7', 'Q', 'J', 'K', 'A', '2', '3'}; // Array de caracteres representando os símbolos das cartas (valores).
 
-// ---
+// ---
+
+struct carta
+{
+    uint8_t indice; // (numero - 1) * 4 + naipe, de 0 a 39; 'numero' indexa SIMBOLOS e 'naipe' indexa NAIPES.
+};
+
+// Conjuntos de cartas (mãos, cartas jogadas, cartas não vistas) são máscaras de 64 bits,
+// com o bit 'indice' ligado para cada carta presente.
+
+static inline struct carta criar_carta(int numero, int naipe)
+{
+    struct carta carta = {(uint8_t)((numero - 1) * 4 + naipe)};
+    return carta;
+}
+
+static inline int numero_carta(struct carta carta)
+{
+    return carta.indice / 4 + 1;
+}
+
+static inline int naipe_carta(struct carta carta)
+{
+    return carta.indice % 4;
+}
+
+static inline uint64_t bit_carta(struct carta carta)
+{
+    return 1ULL << carta.indice;
+}
+
+// Força de cada carta para cada vira, calculada pelo compilador: a linha é o número da vira - 1
+// e a coluna é o índice da carta. Cartas comuns valem o próprio número (1 a 10, empatando entre
+// naipes) e as manilhas valem 11 a 14, de Ouros a Paus.
+#define MANILHA_DA_VIRA(v) ((v) == 10 ? 1 : (v) + 1)
+#define FORCA_CARTA(v, c) ((c) / 4 + 1 == MANILHA_DA_VIRA(v) ? 11 + (c) % 4 : (c) / 4 + 1)
+#define FORCAS_NUMERO(v, n) FORCA_CARTA(v, 4 * (n)), FORCA_CARTA(v, 4 * (n) + 1), FORCA_CARTA(v, 4 * (n) + 2), FORCA_CARTA(v, 4 * (n) + 3)
+#define FORCAS_VIRA(v) {FORCAS_NUMERO(v, 0), FORCAS_NUMERO(v, 1), FORCAS_NUMERO(v, 2), FORCAS_NUMERO(v, 3), FORCAS_NUMERO(v, 4), \
+                        FORCAS_NUMERO(v, 5), FORCAS_NUMERO(v, 6), FORCAS_NUMERO(v, 7), FORCAS_NUMERO(v, 8), FORCAS_NUMERO(v, 9)}
+
+static const uint8_t FORCAS[10][QTD_CARTAS_BARALHO] = {
+    FORCAS_VIRA(1), FORCAS_VIRA(2), FORCAS_VIRA(3), FORCAS_VIRA(4), FORCAS_VIRA(5),
+    FORCAS_VIRA(6), FORCAS_VIRA(7), FORCAS_VIRA(8), FORCAS_VIRA(9), FORCAS_VIRA(10)};
+
+static inline const uint8_t *forcas_da_vira(struct carta vira)
+{
+    return FORCAS[vira.indice / 4];
+}
+
+static inline int qtd_cartas(uint64_t conjunto)
+{
+    return __builtin_popcountll(conjunto);
+}
+
+static inline struct carta primeira_carta(uint64_t conjunto)
+{
+    struct carta carta = {(uint8_t)__builtin_ctzll(conjunto)};
+    return carta;
+}
+
+// ---
+
+struct gerador
+{
+    uint64_t s[4]; // Estado do xoshiro256**; nunca pode ser todo zero.
+};
+
+// ---
+
+struct baralho
+{
+    struct carta cartas[QTD_CARTAS_BARALHO]; // Permutação das 40 cartas; as não distribuídas ficam no início.
+    int qtd_restantes;                       // Quantidade de cartas ainda não distribuídas.
+};
+
+// Índice de uma distribuição completa (vira e mãos): com 6 jogadores há cerca de 3,4 * 10^23, mais do que cabe em 64 bits.
+typedef unsigned __int128 indice_distribuicao;
+
+// ---
+
+struct distribuicao
+{
+    struct carta vira;                    // A vira.
+    uint64_t maos[2][MAX_JOGADORES_TIME]; // Cartas de cada jogador: [time - 1][ordem em que recebe no time].
+    int qtd_jogadores_cada_time;          // Número de jogadores em cada equipe.
+};
+
+// ---
+
+enum tipo_acao
+{
+    ACAO_JOGAR_CARTA,   // Joga a carta 'carta' da mão.
+    ACAO_PEDIR_TRUCO,   // Pede truco (ou aumenta a aposta) para 'valor' pontos.
+    ACAO_ACEITAR_TRUCO, // Aceita o pedido de truco pendente.
+    ACAO_RECUSAR_TRUCO  // Recusa o pedido de truco pendente (corre).
+};
+
+// ---
+
+struct acao
+{
+    enum tipo_acao tipo; // O que o jogador decidiu fazer.
+    struct carta carta;  // Carta jogada, usada por ACAO_JOGAR_CARTA.
+    int valor;           // Novo valor da mão, usado por ACAO_PEDIR_TRUCO.
+};
+
+// ---
+
+enum resultado_acao
+{
+    ACAO_INVALIDA, // A ação não é permitida no estado atual; nada foi alterado.
+    ACAO_CONTINUA, // A ação foi aplicada e a vaza continua.
+    ACAO_FIM_VAZA, // A ação encerrou uma vaza (rodada interna) sem encerrar a mão.
+    ACAO_FIM_MAO   // A ação encerrou a mão.
+};
+
+// ---
+
+struct estado_mao;
+struct jogador;
+
+/**
+ * @brief Função de decisão de um jogador, chamada sempre que ele precisa agir.
+ *
+ * Jogadores humanos leem do terminal; robôs decidem sem nenhuma entrada ou saída.
+ */
+typedef struct acao (*decisao_jogador)(const struct estado_mao *mao, const struct jogador *jogador);
+
+// ---
+
+struct jogador
+{
+    const char *nome;         // Nome do jogador, guardado uma única vez por 'internar_nome'.
+    decisao_jogador decidir;  // Quem escolhe as ações deste jogador (humano ou robô); NULL se elas chegam pela rede.
+    int conexao;              // No servidor, a conexão de quem joga por este jogador quando 'decidir' é NULL.
+};
+
+// ---
+
+struct estado_mao
+{
+    const struct jogador (*jogadores)[MAX_JOGADORES_TIME]; // Jogadores da partida, [time - 1][índice], sem cópias.
+    uint64_t maos[2][MAX_JOGADORES_TIME];      // Cartas que cada jogador ainda tem, [time - 1][índice].
+    int inicio[2];                             // Índice do jogador de cada time na posição 0 da vaza atual.
+    int qtd_jogadores_cada_time;               // Número de jogadores em cada equipe.
+    struct carta vira;                         // Carta "vira" da mão, que define as manilhas.
+    uint64_t cartas_jogadas;                   // Conjunto das cartas já jogadas nesta mão.
+    const uint8_t *forcas;                     // Linha de FORCAS para a vira desta mão.
+    int valor_partida;                         // Valor atual da mão (1, 3, 6, 9 ou 12).
+    int valor_anterior;                        // Valor antes do último pedido, pago se o truco for recusado.
+    bool aceitou_truco;                        // Indica se o último pedido de truco foi aceito.
+    bool truco_pendente;                       // Indica se há um pedido de truco aguardando resposta.
+    int time_que_pediu_truco;                  // Time que fez o último pedido (ou NINGUEM_PEDIU_TRUCO).
+    int time_que_iniciou;                      // Time que começou a mão.
+    int time_ganhador;                         // Time que começa a vaza atual (ganhou a anterior).
+    int pontos_valendo;                        // Vitórias que a vaza atual vale (2 após empate na primeira).
+    int vitorias_time1;                        // Vitórias da Equipe 1 nas vazas desta mão.
+    int vitorias_time2;                        // Vitórias da Equipe 2 nas vazas desta mão.
+    int fez_primeira;                          // Time que venceu a primeira vaza (0 se empatou).
+    struct gerador *gerador;                   // Gerador usado pelos robôs nas decisões desta mão.
+    int rodadas_jogadas;                       // Número da vaza atual (1 a 3).
+    int jogadas_na_rodada;                     // Cartas já jogadas na vaza atual.
+    struct carta carta_maior_1;                // Maior carta da Equipe 1 na vaza atual.
+    struct carta carta_maior_2;                // Maior carta da Equipe 2 na vaza atual.
+    uint8_t forca_maior_1;                     // Força de 'carta_maior_1'.
+    uint8_t forca_maior_2;                     // Força de 'carta_maior_2'.
+    int maior_posicao_1;                       // Posição do jogador da Equipe 1 com a maior carta.
+    int maior_posicao_2;                       // Posição do jogador da Equipe 2 com a maior carta.
+    int resultado_vaza;                        // Vencedor da última vaza encerrada (0 para empate).
+    int time_vencedor;                         // Vencedor da mão (0 enquanto ela está em andamento).
+    int placar[2];                             // Pontos de cada time na partida quando a mão começou.
+};
+
+// ---
+
+struct estado_jogo
+{
+    uint64_t maos[2][MAX_JOGADORES_TIME]; // Cartas de cada jogador: [time - 1][posição na ordem da vaza atual].
+    uint64_t cartas_jogadas;              // Conjunto das cartas já jogadas nesta mão.
+    uint8_t qtd_jogadores_cada_time;      // Número de jogadores em cada equipe.
+    uint8_t vira;                         // Índice da carta "vira".
+    uint8_t valor_partida;                // Valor atual da mão (1, 3, 6, 9 ou 12); daqui até o fim, 'memoria_jogada' guarda uma cópia.
+    uint8_t valor_anterior;               // Valor antes do último pedido, pago se o truco for recusado.
+    bool aceitou_truco;                   // Indica se o último pedido de truco foi aceito.
+    bool truco_pendente;                  // Indica se há um pedido de truco aguardando resposta.
+    int8_t time_que_pediu_truco;          // Time que fez o último pedido (ou NINGUEM_PEDIU_TRUCO).
+    uint8_t time_que_iniciou;             // Time que começou a mão.
+    uint8_t time_ganhador;                // Time que começa a vaza atual.
+    uint8_t pontos_valendo;               // Vitórias que a vaza atual vale (2 após empate na primeira).
+    uint8_t vitorias_time1;               // Vitórias da Equipe 1 nas vazas desta mão.
+    uint8_t vitorias_time2;               // Vitórias da Equipe 2 nas vazas desta mão.
+    uint8_t fez_primeira;                 // Time que venceu a primeira vaza (0 se empatou).
+    uint8_t rodadas_jogadas;              // Número da vaza atual (1 a 3).
+    uint8_t jogadas_na_rodada;            // Cartas já jogadas na vaza atual.
+    uint8_t forca_maior_1;                // Força da maior carta da Equipe 1 na vaza atual.
+    uint8_t forca_maior_2;                // Força da maior carta da Equipe 2 na vaza atual.
+    uint8_t maior_posicao_1;              // Posição do jogador da Equipe 1 com a maior carta.
+    uint8_t maior_posicao_2;              // Posição do jogador da Equipe 2 com a maior carta.
+    uint8_t resultado_vaza;               // Vencedor da última vaza encerrada (0 para empate).
+    uint8_t time_vencedor;                // Vencedor da mão (0 enquanto ela está em andamento).
+};
+
+// ---
+
+struct memoria_jogada
+{
+    uint8_t escalares[sizeof(struct estado_jogo) - offsetof(struct estado_jogo, valor_partida)]; // Campos a partir de 'valor_partida'.
+    uint8_t carta;       // Carta jogada, ou QTD_CARTAS_BARALHO se a ação não foi uma carta.
+    uint8_t time;        // Time de quem jogou a carta.
+    uint8_t posicao;     // Posição de quem jogou a carta, antes da rotação do fim da vaza.
+    uint8_t rotacao[2];  // Quanto cada time girou no fim da vaza (0 se a vaza continua).
+};
+
+// ---
+
+enum politica_lote
+{
+    POLITICA_LOTE_ALEATORIA,     // Cada jogador joga as cartas em uma ordem sorteada.
+    POLITICA_LOTE_MAIOR_PRIMEIRO // Cada jogador joga da carta mais forte para a mais fraca.
+};
+
+// ---
+
+struct lote_maos
+{
+    _Alignas(32) uint8_t cartas[2][MAX_JOGADORES_TIME][3][PISTAS_LOTE]; // Carta que cada jogador joga em cada vaza: [time - 1][jogador][vaza][pista].
+    _Alignas(32) uint8_t vira[PISTAS_LOTE];                             // Índice da vira de cada pista.
+    _Alignas(32) uint8_t time_que_iniciou[PISTAS_LOTE];                 // Time que começa a mão em cada pista (1 ou 2).
+    int qtd_jogadores_cada_time;                                        // Jogadores de cada equipe, o mesmo em todas as pistas.
+};
+
+// ---
+
+enum tipo_registro
+{
+    REGISTRO_PARTIDA = 1, // Início de partida: 'valor' = jogadores, 'dados' = índice da partida.
+    REGISTRO_SEMENTE,     // Logo após REGISTRO_PARTIDA: 'dados' = semente da execução.
+    REGISTRO_MAO,         // Início de mão: 'carta' = vira, 'time' = time que começa.
+    REGISTRO_CARTAS,      // Cartas recebidas: 'time' e 'posicao' do jogador, 'dados' = conjunto das 3 cartas.
+    REGISTRO_JOGADA,      // Carta jogada: 'time', 'posicao' = assento na vaza, 'carta'.
+    REGISTRO_TRUCO,       // Pedido de truco: 'time', 'valor' = novo valor da mão.
+    REGISTRO_ACEITE,      // Truco aceito: 'time', 'valor' = valor aceito.
+    REGISTRO_RECUSA,      // Truco recusado: 'time', 'valor' = valor pago a quem pediu.
+    REGISTRO_VAZA,        // Fim de vaza: 'time' = vencedor (0 para empate), 'valor' = número da vaza.
+    REGISTRO_FIM_MAO,     // Fim de mão: 'time' = vencedor, 'valor' = pontos ganhos, 'placar' = placar depois da mão.
+    REGISTRO_FIM_PARTIDA  // Fim de partida: 'time' = vencedor, 'placar' = placar final.
+};
+
+// ---
+
+struct registro_historico
+{
+    uint8_t tipo;      // Um 'enum tipo_registro'.
+    uint8_t time;      // Time envolvido (1 ou 2), conforme o tipo.
+    uint8_t posicao;   // Posição ou assento do jogador, conforme o tipo.
+    uint8_t carta;     // Índice de uma carta, conforme o tipo.
+    uint8_t valor;     // Valor pequeno (pontos, jogadores, número da vaza), conforme o tipo.
+    uint8_t reservado; // Sempre zero.
+    uint16_t placar;   // Pontos da Equipe 1 no byte baixo e da Equipe 2 no alto.
+    uint64_t dados;    // Valor de 64 bits (conjunto de cartas, índice, semente), conforme o tipo.
+};
+
+// ---
+
+struct arquivo_historico
+{
+    FILE *arquivo;          // Arquivo aberto para acréscimo.
+    pthread_mutex_t trava;  // Serializa as gravações das threads.
+    long long registros;    // Registros gravados nesta execução.
+    long long perdidos;     // Registros descartados porque um buffer não pôde crescer.
+};
+
+// ---
+
+struct historico
+{
+    struct arquivo_historico *destino;    // Arquivo onde os registros são gravados.
+    struct registro_historico *registros; // Registros ainda não gravados (sempre partidas inteiras, exceto a atual).
+    size_t qtd;                           // Registros em 'registros'.
+    size_t capacidade;                    // Espaço alocado em 'registros'.
+    long long perdidos;                   // Registros descartados por falta de memória, ainda não informados ao arquivo.
+};
+
+// ---
+
+struct estatisticas_historico
+{
+    _Alignas(64) long long registros;      // Registros lidos (cada thread soma no seu, sem compartilhar linha de cache).
+    long long invalidos;                   // Registros de tipo desconhecido, ignorados.
+    long long partidas;                    // Partidas completas.
+    long long maos;                        // Mãos completas.
+    long long maos_vira[10];               // Mãos por número da vira - 1.
+    long long vitorias_inicio_vira[10];    // Mãos vencidas pelo time que começou, por número da vira - 1.
+    long long maos_manilhas[5];            // Mãos de cada time pela quantidade de manilhas recebidas.
+    long long vitorias_manilhas[5];        // Dessas, as vencidas pelo time.
+    long long maos_maior_manilha[5];       // Mãos de cada time pela maior manilha recebida (0 = nenhuma, 1 a 4 = Ouros a Paus).
+    long long vitorias_maior_manilha[5];   // Dessas, as vencidas pelo time.
+    long long pedidos_truco[5];            // Pedidos por nível (1 = truco, 2 = seis, 3 = nove, 4 = doze).
+    long long aceites_truco[5];            // Pedidos aceitos, por nível.
+    long long recusas_truco[5];            // Pedidos recusados, por nível.
+    long long maos_truco_aceito[5];        // Mãos cujo último pedido aceito foi desse nível.
+    long long vitorias_quem_pediu[5];      // Dessas, as vencidas por quem pediu.
+    long long saldo_quem_pediu[5];         // Pontos ganhos menos pontos perdidos por quem pediu, nessas mãos.
+    long long empates_primeira;            // Mãos com a primeira vaza empatada (a segunda passa a valer 2).
+    long long empates_decididos[4];        // Dessas, por vaza em que a mão acabou (0 = truco recusado).
+    long long empates_vitorias_inicio;     // Dessas, as vencidas pelo time que começou.
+};
+
+// ---
+
+enum tipo_evento
+{
+    EVENTO_INICIO_PARTIDA, // A partida começou.
+    EVENTO_INICIO_MAO,     // As cartas foram distribuídas.
+    EVENTO_INICIO_VAZA,    // Uma vaza vai começar.
+    EVENTO_ACAO,           // Um jogador agiu: 'acao', 'time', 'assento' e 'autor'.
+    EVENTO_ACAO_INVALIDA,  // A ação de um jogador foi rejeitada e será pedida de novo.
+    EVENTO_FIM_VAZA,       // A vaza acabou: 'vencedor' (0 para empate).
+    EVENTO_FIM_MAO,        // A mão acabou e o placar foi atualizado: 'vencedor'.
+    EVENTO_FIM_PARTIDA     // A partida acabou: 'vencedor'.
+};
+
+// ---
+
+struct evento
+{
+    enum tipo_evento tipo;           // O que aconteceu.
+    const struct partida *partida;   // A partida, com o placar já atualizado.
+    const struct estado_mao *mao;    // A mão em andamento, ou NULL fora de uma mão.
+    const struct jogador *autor;     // Quem agiu (EVENTO_ACAO).
+    struct acao acao;                // A ação aplicada (EVENTO_ACAO).
+    int time;                        // Time de quem agiu (EVENTO_ACAO).
+    int assento;                     // Assento de quem agiu na vaza (EVENTO_ACAO).
+    int vencedor;                    // Vencedor da vaza, da mão ou da partida, conforme o tipo.
+};
+
+// ---
+
+struct saida_eventos
+{
+    void (*emitir)(struct saida_eventos *saida, const struct evento *evento); // Trata um evento.
+    FILE *arquivo;          // Destino do texto, no fluxo para máquinas.
+    pthread_mutex_t *trava; // Trava do arquivo, se ele é compartilhado entre threads, ou NULL.
+    char *texto;            // Texto ainda não gravado (sempre partidas inteiras, exceto a atual).
+    size_t qtd;             // Bytes em 'texto'.
+    size_t capacidade;      // Espaço alocado em 'texto'.
+};
+
+// ---
+
+struct partida
+{
+    struct jogador jogadores[2][MAX_JOGADORES_TIME]; // Jogadores, registrados uma vez em 'iniciar_partida': [time - 1][índice].
+    int inicio[2];                             // Índice do jogador de cada time na posição 0 da próxima mão.
+    int qtd_jogadores_cada_time;               // Número de jogadores em cada equipe.
+    int pontuacao_time_1;                      // Pontuação global da Equipe 1.
+    int pontuacao_time_2;                      // Pontuação global da Equipe 2.
+    int rodada;                                // Número da mão atual.
+    int proximo_time;                          // Time que começa a próxima mão.
+    int maos_jogadas;                          // Quantidade de mãos disputadas na partida.
+    struct baralho baralho;                    // Baralho reaproveitado a cada mão.
+    struct gerador gerador;                    // Gerador das distribuições de cartas.
+    struct gerador gerador_decisoes;           // Gerador das decisões dos robôs, independente das distribuições.
+    struct saida_eventos *eventos;             // Quem recebe os eventos do jogo, ou NULL para não gerar nenhum.
+    uint64_t semente;                          // Semente da execução.
+    uint64_t indice;                           // Número da partida; com a semente, determina as distribuições.
+    struct historico *historico;               // Onde registrar a partida, ou NULL para não registrar.
+};
+
+// ---
+
+enum tipo_transposicao
+{
+    TRANSPOSICAO_VAZIA,    // Entrada nunca usada.
+    TRANSPOSICAO_EXATA,    // 'valor' é o valor exato do estado.
+    TRANSPOSICAO_INFERIOR, // O valor do estado é no mínimo 'valor' (houve corte beta).
+    TRANSPOSICAO_SUPERIOR  // O valor do estado é no máximo 'valor' (nenhuma jogada passou de alfa).
+};
+
+// ---
+
+struct entrada_transposicao
+{
+    uint64_t chave; // Chave Zobrist completa do estado, para descartar colisões de posição.
+    int8_t valor;   // +1 se o time da vez vence a mão, -1 se perde.
+    uint8_t tipo;   // Um 'enum tipo_transposicao'.
+    uint8_t melhor; // Índice da melhor carta encontrada, tentada primeiro na próxima visita.
+};
+
+// ---
+
+struct resolvedor
+{
+    struct entrada_transposicao tabela[1 << BITS_TRANSPOSICAO]; // Tabela de transposição, reaproveitada entre as mãos.
+    long long nos;                                              // Estados visitados desde 'iniciar_resolvedor'.
+};
+
+// ---
+
+struct configuracao_mcts
+{
+    double segundos_por_decisao; // Tempo máximo de busca de cada decisão (0 para não limitar).
+    int max_playouts;            // Máximo de playouts de cada decisão (0 para não limitar).
+    int threads_por_decisao;     // Threads que expandem a mesma árvore em cada decisão.
+    int peso_manilha_truco;      // Peso das manilhas nas mãos dos adversários que pediram truco (1 para sortear sem inferência).
+};
+
+// ---
+
+#ifdef INSTRUMENTACAO
+enum fase_instrumentacao
+{
+    FASE_DISTRIBUICAO,   // 'embaralhar' e 'embaralhar_por_sorteio'.
+    FASE_TROCA_REPETIDA, // Cada carta sorteada de novo por 'troca_repetida' (só contada).
+    FASE_COMPARACAO,     // Comparações de cartas, no motor e em 'comparar_cartas' (só contadas).
+    FASE_DECISAO,        // Decisões dos jogadores, humanos ou robôs.
+    FASE_VAZA,           // Fim de vaza em 'rodada_truco'.
+    FASE_SAIDA,          // Eventos emitidos e registros de histórico.
+    QTD_FASES_INSTRUMENTACAO
+};
+
+// ---
+
+struct instrumentacao
+{
+    long long contagens[QTD_FASES_INSTRUMENTACAO];          // Vezes em que cada fase foi executada.
+    uint64_t tiques[QTD_FASES_INSTRUMENTACAO];              // Tempo gasto em cada fase, em tiques de 'ler_relogio_instrumentacao'.
+    long long latencias_decisao[QTD_FAIXAS_LATENCIA];      // Decisões por faixa de latência (potências de 2 em tiques).
+};
+
+// ---
+
+#endif
+
+struct estatisticas_mcts
+{
+    long long decisoes; // Decisões tomadas com busca (as jogadas forçadas não contam).
+    long long playouts; // Playouts executados em todas as decisões.
+    double segundos;    // Tempo gasto nas buscas, somado entre as threads de cada busca.
+};
+
+// ---
+
+struct faixa_trabalho
+{
+    _Alignas(64) atomic_llong proximo; // Próximo item ainda não pego desta faixa (em sua própria linha de cache).
+    long long fim;                     // Fim (exclusivo) da faixa.
+};
+
+// ---
+
+struct distribuidor_trabalho
+{
+    struct faixa_trabalho faixas[MAX_THREADS]; // Uma faixa contígua de itens por thread.
+    int qtd_threads;                           // Quantidade de threads (e de faixas).
+    long long tamanho_lote;                    // Quantos itens são pegos de cada vez.
+};
+
+// ---
+
+struct resultado_simulacao
+{
+    _Alignas(64) long long partidas; // Partidas jogadas (cada thread soma no seu, sem compartilhar linha de cache).
+    long long vitorias[3];           // Vitórias por time (índices 1 e 2).
+    long long maos;                  // Mãos jogadas.
+    long long pontos[3];             // Pontos marcados por time, somados em todas as partidas.
+    struct estatisticas_mcts mcts;   // Decisões e playouts do robô MCTS, se ele jogou.
+};
+
+// ---
+
+struct robo_registrado
+{
+    const char *nome;        // Nome usado na linha de comando (--tournament).
+    decisao_jogador decidir; // Política do robô.
+};
+
+// ---
+
+struct participante_torneio
+{
+    const char *nome;        // Nome no torneio; repetições do mesmo robô ganham o sufixo "#n".
+    decisao_jogador decidir; // Política do robô.
+    double forca;            // Força de Bradley-Terry estimada (a média geométrica de todas é 1).
+    double elo;              // A força na escala Elo, com ELO_INICIAL na média.
+    double erro_elo;         // Desvio padrão aproximado de 'elo'.
+    long long partidas;      // Partidas jogadas.
+    long long vitorias;      // Partidas vencidas.
+};
+
+// ---
+
+struct confronto_torneio
+{
+    int a;                      // Participante que é a Equipe 1 nas partidas pares.
+    int b;                      // Participante que é a Equipe 1 nas partidas ímpares.
+    long long primeira_partida; // Índice (com a semente) da distribuição da primeira dupla de partidas.
+    atomic_llong vitorias_a;    // Vitórias de 'a', somadas pelas threads ao fim de cada trecho.
+    atomic_llong partidas;      // Partidas concluídas.
+};
+
+// ---
+
+struct torneio
+{
+    struct participante_torneio participantes[MAX_PARTICIPANTES_TORNEIO]; // Robôs inscritos.
+    int qtd_participantes;                   // Robôs em 'participantes'.
+    struct confronto_torneio *confrontos;    // Confrontos já agendados, de todas as rodadas.
+    int qtd_confrontos;                      // Confrontos em 'confrontos'.
+    int capacidade_confrontos;               // Espaço alocado em 'confrontos'.
+    int numero_jogadores;                    // Jogadores em cada mesa (2, 4 ou 6).
+    uint64_t semente;                        // Semente das distribuições.
+    long long partidas_por_confronto;        // Partidas de cada confronto, metade com cada robô como Equipe 1.
+};
+
+// ---
+
+struct resultado_benchmark
+{
+    const char *nome;     // Identificador estável da medição (por exemplo, "mao_completa").
+    int jogadores;        // Jogadores na mesa (0 quando a medição não depende disso).
+    long long repeticoes; // Operações executadas.
+    double ns_por_op;     // Tempo médio de uma operação, em nanossegundos.
+};
+
+// ---
+
+struct relatorio_benchmark
+{
+    struct resultado_benchmark resultados[MAX_RESULTADOS_BENCHMARK]; // Medições, na ordem em que foram feitas.
+    int qtd;                                                         // Medições registradas.
+};
+
+// ---
+
+struct conexao_servidor
+{
+    bool aberta;                            // Indica se o descritor com este número é um jogador conectado.
+    bool na_fila_envio;                     // Indica se a conexão já está na lista de envios pendentes.
+    bool esperando_escrita;                 // O socket encheu e a conexão espera EPOLLOUT para continuar enviando.
+    int mesa;                               // Mesa em que a conexão joga, ou -1.
+    int time;                               // Time do jogador na mesa (1 ou 2).
+    int qtd_entrada;                        // Bytes em 'entrada'.
+    int qtd_saida;                          // Bytes em 'saida'.
+    char entrada[TAMANHO_ENTRADA_CONEXAO];  // Comandos recebidos, até a próxima quebra de linha.
+    char saida[TAMANHO_SAIDA_CONEXAO];      // Mensagens ainda não enviadas.
+};
+
+// ---
+
+struct mesa_servidor
+{
+    struct partida partida;                       // Partida da mesa; os jogadores remotos têm 'decidir' NULL.
+    struct estado_mao mao;                        // Mão em andamento.
+    int numero_jogadores;                         // Jogadores na mesa (2, 4 ou 6).
+    int humanos;                                  // Conexões esperadas antes de a partida começar; o resto são robôs.
+    int conexoes[2 * MAX_JOGADORES_TIME];         // Conexão de cada lugar, na ordem de entrada (Equipe 1, Equipe 2, ...).
+    int conectados;                               // Lugares já ocupados por conexões.
+    bool em_andamento;                            // A partida começou.
+    double prazo;                                 // Instante em que o servidor joga pelo jogador remoto da vez.
+    int prazo_anterior;                           // Mesa anterior na fila de prazos, ou -1.
+    int prazo_proximo;                            // Próxima mesa na fila de prazos, ou -1.
+    bool na_fila_prazos;                          // A mesa espera uma jogada remota.
+};
+
+// ---
+
+struct servidor
+{
+    int epoll;                          // Descritor do epoll do laço de eventos.
+    int escuta;                         // Socket que aceita novas conexões.
+    struct conexao_servidor *conexoes;  // Estado de cada conexão, indexado pelo descritor.
+    int max_conexoes;                   // Tamanho de 'conexoes' (limite de descritores do processo).
+    int *fila_envio;                    // Conexões com mensagens pendentes nesta volta do laço.
+    int qtd_fila_envio;                 // Conexões em 'fila_envio'.
+    struct mesa_servidor **mesas;       // Mesas alocadas (cada uma fixa na memória, pois a mão aponta para a partida).
+    int qtd_mesas;                      // Mesas alocadas.
+    int *mesas_livres;                  // Pilha de mesas encerradas, prontas para reuso.
+    int qtd_mesas_livres;               // Mesas em 'mesas_livres'.
+    int aguardando[7][7];               // Mesa esperando jogadores para cada (jogadores, humanos), ou -1.
+    int primeiro_prazo;                 // Mesa com o prazo mais próximo, ou -1.
+    int ultimo_prazo;                   // Mesa com o prazo mais distante, ou -1.
+    double segundos_por_turno;          // Prazo de cada jogada remota.
+    uint64_t semente;                   // Semente das distribuições; a n-ésima partida iniciada usa (semente, n).
+    decisao_jogador robo;               // Quem joga pelos lugares sem conexão e pelos jogadores que saíram ou perderam o prazo.
+    long long partidas_iniciadas;       // Partidas já iniciadas no servidor.
+    long long acoes;                    // Ações aplicadas (de jogadores remotos e robôs).
+    long long acoes_remotas;            // Ações recebidas pela rede.
+    long long jogadas_por_tempo;        // Jogadas feitas pelo servidor por estouro de prazo.
+    long long mesas_em_andamento;       // Partidas em andamento agora.
+};
+
+// ---
+
+struct cabecalho_historico
+{
+    char magica[8];            // "TRUCOHS1", identifica o formato do arquivo.
+    uint32_t versao;           // Versão do formato (1).
+    uint32_t tamanho_registro; // sizeof(struct registro_historico), 16 bytes.
+};
+
+// ---
+
+struct cabecalho_equidade
+{
+    char magica[8];       // "TRUCOEQ1", identifica o formato do arquivo.
+    uint32_t qtd_viras;   // Linhas da tabela: uma por número de vira (10).
+    uint32_t qtd_maos;    // Colunas: uma por combinação de 3 cartas (QTD_MAOS_POSSIVEIS).
+    uint32_t escala;      // Valor armazenado para equidade 1.0 (65535).
+    uint32_t reservado;   // Mantém os dados alinhados a 8 bytes.
+};
+
+// ---
+
+enum decisao_aposta
+{
+    APOSTA_CONTINUAR, // Jogar uma carta sem pedir truco.
+    APOSTA_PEDIR,     // Pedir (ou aumentar) o truco.
+    APOSTA_ACEITAR,   // Aceitar o pedido do adversário.
+    APOSTA_RECUSAR,   // Recusar o pedido e entregar a mão.
+    QTD_DECISOES_APOSTA
+};
+
+// ---
+
+struct cabecalho_apostas
+{
+    char magica[8];          // "TRUCOAP1", identifica o formato do arquivo.
+    uint32_t qtd_mesas;      // Tamanhos de mesa (2, 4 e 6 jogadores).
+    uint32_t qtd_faixas;     // Faixas de força de mão (QTD_FAIXAS_FORCA).
+    uint32_t qtd_viras;      // Números de vira (10).
+    uint32_t qtd_estados;    // Estados de vaza (QTD_ESTADOS_VAZA).
+    uint32_t qtd_niveis;     // Valores da mão antes do pedido (QTD_NIVEIS_APOSTA).
+    uint32_t qtd_placares;   // Pontos de cada time antes da mão (0 a PONTOS_PARA_VENCER - 1).
+    uint32_t qtd_decisoes;   // Valores por entrada, um por 'enum decisao_aposta'.
+    uint32_t escala;         // Valor armazenado para probabilidade 1.0 de vencer a partida (65535).
+};
+
+// ---
+
+struct cabecalho_cfr
+{
+    char magica[8];          // "TRUCOCF1", identifica o formato do arquivo.
+    uint32_t qtd_conjuntos;  // Conjuntos de informação (QTD_CONJUNTOS_CFR).
+    uint32_t qtd_acoes;      // Ações por conjunto (2).
+    uint32_t escala;         // Arrependimento de 1 ponto (ESCALA_CFR).
+    uint32_t reservado;      // Mantém os dados alinhados a 8 bytes.
+    uint64_t iteracoes;      // Iterações já treinadas; um novo treino continua daqui.
+};
+
+// ---
+
+struct no_mcts
+{
+    struct acao acao;           // Ação que leva do pai a este nó.
+    int time;                   // Time de quem escolheu a ação; as recompensas são do ponto de vista dele.
+    atomic_int primeiro_filho;  // Primeiro filho na arena, ou -1; os filhos novos entram na frente.
+    int proximo_irmao;          // Próximo irmão na arena, ou -1 (fixo depois que o nó é publicado).
+    atomic_int visitas;         // Vezes em que a ação foi escolhida, mais as perdas virtuais em curso.
+    atomic_int disponibilidade; // Vezes em que a ação era permitida quando o pai foi visitado.
+    atomic_llong soma;          // Soma das recompensas, em pontos da mão (de -12 a 12 por playout).
+};
+
+// ---
+
+struct arvore_mcts
+{
+    struct no_mcts nos[MAX_NOS_MCTS]; // Arena de nós; o nó 0 é a raiz.
+    _Alignas(64) atomic_int qtd_nos;  // Nós reservados na decisão atual (pode passar de MAX_NOS_MCTS).
+    bool compartilhada;               // Se outras threads expandem a árvore ao mesmo tempo.
+};
+
+// ---
+
+struct amostrador_maos
+{
+    uint8_t manilhas[4];                  // Manilhas não vistas, em qualquer ordem.
+    uint8_t comuns[QTD_CARTAS_BARALHO];   // Demais cartas não vistas, em qualquer ordem.
+    int qtd_manilhas;                     // Manilhas não vistas.
+    int qtd_comuns;                       // Demais cartas não vistas.
+    int time_observador;                  // Time de quem amostra.
+    int posicao_observador;               // Posição de quem amostra no estado compacto em que o amostrador foi preparado.
+    int time_favorecido;                  // Time adversário que pediu truco, cujas mãos puxam manilhas com 'peso_manilha', ou 0.
+    int peso_manilha;                     // Peso de cada manilha contra 1 de cada carta comum nas mãos favorecidas.
+};
+
+// ---
+
+struct busca_mcts;
+
+struct ajudante_mcts
+{
+    struct busca_mcts *busca; // Busca atendida pela thread.
+    int indice;               // Índice da thread, de 1 em diante; a thread que decide é a 0.
+    int geracao;              // Última decisão atendida (a atual quando a thread foi criada).
+};
+
+// ---
+
+struct busca_mcts
+{
+    struct arvore_mcts arvore;                      // Árvore da decisão atual.
+    struct estado_jogo raiz;                        // Estado visto por quem decide.
+    struct amostrador_maos amostrador;              // Cartas que quem decide não vê; cada thread sorteia de uma cópia.
+    uint64_t semente;                               // Semente dos geradores das ajudantes nesta decisão.
+    double inicio;                                  // Início da decisão, em 'tempo_atual'.
+    _Alignas(64) atomic_llong reservados;           // Playouts já reservados pelas threads, contra 'max_playouts'.
+    _Alignas(64) atomic_llong concluidos;           // Playouts terminados por todas as threads.
+    pthread_mutex_t trava;                          // Protege os campos abaixo.
+    pthread_cond_t comecar;                         // Sinaliza uma nova decisão às ajudantes.
+    pthread_cond_t terminar;                        // Sinaliza a quem decide que a última ajudante parou.
+    int geracao;                                    // Decisões já despachadas; as ajudantes esperam ela mudar.
+    int ativas;                                     // Ajudantes que ainda buscam na decisão atual.
+    bool encerrar;                                  // Pede às ajudantes que terminem.
+    int qtd_ajudantes;                              // Threads ajudantes já criadas.
+    pthread_t ajudantes[MAX_THREADS];               // As threads ajudantes, reaproveitadas entre as decisões.
+    struct ajudante_mcts argumentos[MAX_THREADS];   // Argumento de cada ajudante.
+};
+
+// ---
+
+struct configuracao_mcts configuracao_mcts = {0.005, 0, 1, 1}; // Orçamento de cada decisão do robô MCTS (padrão: 5 ms, uma thread, sem inferência).
+_Thread_local struct estatisticas_mcts estatisticas_mcts_thread; // Estatísticas do robô MCTS na thread atual.
+#ifdef INSTRUMENTACAO
+_Thread_local struct instrumentacao instrumentacao_thread;      // Contadores da thread atual, somados ao total quando ela termina.
+#endif
+
+// Protótipos das Funções
+
+/**
+ * @brief Inicializa um gerador a partir de uma semente e de um índice (por exemplo, o número da partida).
+ *
+ * O mesmo par (semente, índice) sempre produz a mesma sequência, e índices
+ * diferentes produzem sequências independentes.
+ *
+ * @param gerador Um ponteiro para o gerador a ser inicializado.
+ * @param semente A semente global da execução.
+ * @param indice O índice da sequência desejada.
+ */
+void semear_gerador(struct gerador *gerador, uint64_t semente, uint64_t indice);
+
+/**
+ * @brief Avança o gerador e retorna 64 bits aleatórios (xoshiro256**).
+ * @param gerador Um ponteiro para o gerador.
+ * @return O próximo número da sequência.
+ */
+uint64_t proximo_aleatorio(struct gerador *gerador);
+
+/**
+ * @brief Salta 2^128 posições na sequência do gerador.
+ *
+ * Permite dividir uma sequência em até 2^128 fluxos que nunca se sobrepõem,
+ * um para cada thread ou para cada finalidade.
+ *
+ * @param gerador Um ponteiro para o gerador.
+ */
+void saltar_gerador(struct gerador *gerador);
+
+/**
+ * @brief Sorteia um número uniforme em [0, limite), sem o viés do operador '%'.
+ * @param gerador Um ponteiro para o gerador.
+ * @param limite O limite exclusivo, maior que zero.
+ * @return Um número entre 0 e 'limite' - 1.
+ */
+uint32_t sortear_limitado(struct gerador *gerador, uint32_t limite);
+
+/**
+ * @brief Gera um número aleatório dentro de um intervalo específico.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ * @param max O valor máximo inclusivo.
+ * @return Um número inteiro aleatório entre 0 e 'max'.
+ */
+int gerar_numero_aleatorio(struct gerador *gerador, int max);
+
+/**
+ * @brief Atribui um número aleatório à carta.
+ * @param carta Um ponteiro para a estrutura 'carta'.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ */
+void sorteio_numero_carta(struct carta *carta, struct gerador *gerador);
+
+/**
+ * @brief Atribui um naipe aleatório à carta.
+ * @param carta Um ponteiro para a estrutura 'carta'.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ */
+void sorteio_naipe(struct carta *carta, struct gerador *gerador);
+
+/**
+ * @brief Cria uma nova carta com número e naipe aleatórios.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ * @return A estrutura 'carta' criada.
+ */
+struct carta criar_carta_aleatoria(struct gerador *gerador);
+
+/**
+ * @brief Solicita ao usuário o nome de um jogador e o armazena.
+ * @param jogador Um ponteiro para a estrutura 'jogador'.
+ */
+void adicionar_nome_jogador(struct jogador *jogador);
+
+/**
+ * @brief Guarda um nome uma única vez e devolve sempre o mesmo ponteiro para ele.
+ *
+ * Os jogadores só guardam o ponteiro, então copiar ou comparar jogadores não copia nomes.
+ * Pode ser chamada por várias threads.
+ *
+ * @param nome O nome (cortado em TAMANHO_NOME - 1 caracteres).
+ * @return O nome guardado, válido até o fim do programa.
+ */
+const char *internar_nome(const char *nome);
+
+/**
+ * @brief Monta o baralho com as 40 cartas, em ordem.
+ * @param baralho Um ponteiro para a estrutura 'baralho'.
+ */
+void montar_baralho(struct baralho *baralho);
+
+/**
+ * @brief Compra uma carta aleatória entre as restantes do baralho (um passo do Fisher-Yates).
+ *
+ * Sorteia uma das cartas restantes e a troca com a última delas, que sai do baralho.
+ * Custa sempre o mesmo, sem sorteios repetidos.
+ *
+ * @param baralho Um ponteiro para o baralho, que deve ter ao menos uma carta restante.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ * @return A carta comprada.
+ */
+struct carta comprar_carta(struct baralho *baralho, struct gerador *gerador);
+
+/**
+ * @brief Distribui 3 cartas do baralho para a mão de um jogador.
+ * @param cartas Ponteiro para o conjunto de cartas do jogador.
+ * @param baralho Um ponteiro para o baralho de onde as cartas são compradas.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ */
+void distribuir_cartas_jogador(uint64_t *cartas, struct baralho *baralho, struct gerador *gerador);
+
+/**
+ * @brief Distribui 3 cartas sorteadas para a mão de um jogador, sorteando de novo as repetidas.
+ *
+ * Caminho antigo de distribuição, mantido como referência para o benchmark.
+ *
+ * @param cartas Ponteiro para o conjunto de cartas do jogador.
+ * @param cartas_em_jogo Ponteiro para o conjunto das cartas já distribuídas, para evitar repetições.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ */
+void distribuir_cartas_por_sorteio(uint64_t *cartas, uint64_t *cartas_em_jogo, struct gerador *gerador);
+
+/**
+ * @brief Adiciona jogadores a uma equipe, obtém seus nomes e se cada um é humano ou robô (MCTS).
+ * @param time Um array de estruturas 'jogador'.
+ * @param quantidade_jogadores O número de jogadores na equipe.
+ */
+void adicionar_equipe(struct jogador time[], int quantidade_jogadores);
+
+/**
+ * @brief Exibe uma única carta no formato "númeroNaipe".
+ * @param carta A estrutura 'carta' a ser exibida.
+ */
+void exibir_carta(struct carta carta);
+
+/**
+ * @brief Exibe todas as cartas na mão de um jogador.
+ * @param mao O conjunto de cartas da mão.
+ */
+void exibir_mao(uint64_t mao);
+
+/**
+ * @brief Exibe informações detalhadas de todos os jogadores em uma equipe.
+ * @param time Um array de estruturas 'jogador'.
+ * @param quantidade_jogadores O número de jogadores na equipe.
+ */
+void exibir_time(const struct jogador time[], int quantidade_jogadores);
+
+/**
+ * @brief Exibe a equipe vencedora.
+ * @param time Um array de estruturas 'jogador' representando a equipe vencedora.
+ * @param quantidade_jogadores O número de jogadores na equipe vencedora.
+ */
+void exibir_ganhador(const struct jogador time[], int quantidade_jogadores);
+
+/**
+ * @brief Exibe as pontuações finais de ambas as equipes.
+ * @param pontuacao_time_1 A pontuação final da Equipe 1.
+ * @param pontuacao_time_2 A pontuação final da Equipe 2.
+ */
+void exibir_pontuacao_final(int pontuacao_time_1, int pontuacao_time_2);
+
+/**
+ * @brief Exibe as pontuações atuais de ambas as equipes durante a partida.
+ * @param pontuacao_time_1 A pontuação atual da Equipe 1.
+ * @param pontuacao_time_2 A pontuacao atual da Equipe 2.
+ */
+void exibir_pontuacao_partida(int pontuacao_time_1, int pontuacao_time_2);
+
+/**
+ * @brief Gerencia a conclusão do jogo, anunciando o vencedor e as pontuações finais.
+ * @param time_1 Array de 'jogador' para a Equipe 1.
+ * @param time_2 Array de 'jogador' para a Equipe 2.
+ * @param pontuacao_time_1 Pontuação final da Equipe 1.
+ * @param pontuacao_time_2 Pontuação final da Equipe 2.
+ * @param qtd_jagadores_cada_time Número de jogadores por equipe.
+ */
+void finalizar_jogo(const struct jogador time_1[], const struct jogador time_2[], int pontuacao_time_1, int pontuacao_time_2, int qtd_jagadores_cada_time);
+
+/**
+ * @brief Saída de eventos do modo interativo: imprime o andamento da partida no terminal.
+ * @param saida A saída ('saida_terminal').
+ * @param evento O evento a exibir.
+ */
+void emitir_terminal(struct saida_eventos *saida, const struct evento *evento);
+
+/**
+ * @brief Saída de eventos para máquinas: acumula uma linha de texto por evento e grava entre partidas.
+ * @param saida A saída, preparada com 'iniciar_saida_fluxo'.
+ * @param evento O evento a registrar.
+ */
+void emitir_fluxo(struct saida_eventos *saida, const struct evento *evento);
+
+/**
+ * @brief Prepara uma saída de eventos em texto para máquinas (uma por thread).
+ * @param saida A saída a preencher.
+ * @param arquivo O arquivo de destino.
+ * @param trava A trava do arquivo, se ele é compartilhado entre threads, ou NULL.
+ */
+void iniciar_saida_fluxo(struct saida_eventos *saida, FILE *arquivo, pthread_mutex_t *trava);
+
+/**
+ * @brief Grava o texto acumulado de uma saída de eventos e libera a sua memória.
+ * @param saida A saída preparada com 'iniciar_saida_fluxo'.
+ */
+void liberar_saida_fluxo(struct saida_eventos *saida);
+
+struct saida_eventos saida_terminal = {emitir_terminal, NULL, NULL, NULL, 0, 0}; // Saída do modo interativo.
+
+/**
+ * @brief Encerra a vaza (rodada interna) atual depois que todos os jogadores jogaram.
+ *
+ * Determina a equipe vencedora comparando as maiores cartas de cada time, aplica as
+ * regras de empate, atualiza as vitórias, avança o início de cada time ('inicio')
+ * para que o vencedor comece a próxima vaza e verifica se a mão terminou.
+ *
+ * @param mao Ponteiro para o estado da mão em andamento.
+ * @return ACAO_FIM_MAO se a mão terminou, ou ACAO_FIM_VAZA caso contrário.
+ */
+enum resultado_acao rodada_truco(struct estado_mao *mao);
+
+/**
+ * @brief Solicita a um jogador que escolha uma carta para jogar.
+ * @param cartas As cartas do jogador atual.
+ */
+void pedir_carta_jogar(uint64_t cartas);
+
+/**
+ * @brief Retira uma carta da mão do jogador após ela ter sido jogada.
+ * @param cartas Ponteiro para o conjunto de cartas do jogador.
+ * @param carta_jogada A carta jogada, que deve estar na mão do jogador.
+ */
+void retirar_carta_jogada(uint64_t *cartas, struct carta carta_jogada);
+
+/**
+ * @brief Lê do terminal qual carta o jogador deseja jogar, incluindo a validação da entrada.
+ * @param cartas As cartas do jogador atual.
+ * @return A carta escolhida.
+ */
+struct carta jogar_carta(uint64_t cartas);
+
+/**
+ * @brief Retorna a carta de uma posição do conjunto, contando a partir da menor.
+ * @param conjunto O conjunto de cartas.
+ * @param posicao A posição desejada, de 0 a qtd_cartas(conjunto) - 1.
+ * @return A carta naquela posição.
+ */
+struct carta carta_na_posicao(uint64_t conjunto, int posicao);
+
+/**
+ * @brief Sorteia uma carta uniformemente dentro de um conjunto não vazio.
+ * @param conjunto O conjunto de cartas.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ * @return A carta sorteada.
+ */
+struct carta sortear_carta(uint64_t conjunto, struct gerador *gerador);
+
+/**
+ * @brief Lógica para o pedido de 'truco', atualizando o valor da rodada.
+ * @param qtd_pontos_valendo Ponteiro para o valor atual dos pontos da rodada.
+ */
+void pedir_truco(int *qtd_pontos_valendo);
+
+/**
+ * @brief Lógica para aceitar um pedido de truco.
+ * @param aceitou_truco Ponteiro para um booleano que indica se o truco foi aceito.
+ * @param jogador_que_responde O jogador que responde ao pedido.
+ */
+void aceitar_truco(bool *aceitou_truco, const struct jogador *jogador_que_responde);
+
+/**
+ * @brief Decisão de um jogador humano: escolher entre jogar uma carta ou pedir truco pelo terminal.
+ *
+ * Quando há um pedido de truco pendente, pergunta ao jogador se ele aceita.
+ *
+ * @param mao O estado da mão em andamento.
+ * @param jogador O jogador que deve agir.
+ * @return A ação escolhida pelo jogador.
+ */
+struct acao escolher_acao(const struct estado_mao *mao, const struct jogador *jogador);
+
+/**
+ * @brief Decisão de um robô que escolhe ao acaso entre as ações permitidas, sem entrada ou saída.
+ * @param mao O estado da mão em andamento.
+ * @param jogador O jogador que deve agir.
+ * @return A ação sorteada.
+ */
+struct acao escolher_acao_aleatoria(const struct estado_mao *mao, const struct jogador *jogador);
+
+/**
+ * @brief Decisão de um robô guloso, que olha só para a própria mão e para a vaza atual.
+ *
+ * Ganha a vaza com a menor carta que basta e descarta a mais fraca quando não dá (ou quando
+ * o parceiro já está ganhando). Pede e aceita truco quando tem manilhas, 2 e 3 suficientes.
+ *
+ * @param mao O estado da mão em andamento.
+ * @param jogador O jogador que deve agir.
+ * @return A ação escolhida.
+ */
+struct acao escolher_acao_gulosa(const struct estado_mao *mao, const struct jogador *jogador);
+
+/**
+ * @brief Decisão de um robô que joga as cartas como 'escolher_acao_gulosa', mas nunca pede truco e só aceita com mão muito forte.
+ * @param mao O estado da mão em andamento.
+ * @param jogador O jogador que deve agir.
+ * @return A ação escolhida.
+ */
+struct acao escolher_acao_cautelosa(const struct estado_mao *mao, const struct jogador *jogador);
+
+/**
+ * @brief Decisão de um robô que aposta pela tabela de apostas e joga as cartas como 'escolher_acao_gulosa'.
+ *
+ * Pede, aumenta, aceita ou recusa o truco com uma única consulta à tabela carregada por
+ * 'carregar_tabela_apostas', escolhendo a decisão que mais aumenta a chance de vencer a
+ * partida. Sem a tabela, aposta como 'escolher_acao_gulosa'.
+ *
+ * @param mao O estado da mão em andamento.
+ * @param jogador O jogador que deve agir.
+ * @return A ação escolhida.
+ */
+struct acao escolher_acao_tabela(const struct estado_mao *mao, const struct jogador *jogador);
+
+/**
+ * @brief Decisão de um robô que aposta pela estratégia média treinada por 'treinar_cfr' e joga as cartas como 'escolher_acao_cautelosa'.
+ *
+ * Sorteia cada pedido, aceite e recusa com as probabilidades da estratégia carregada por
+ * 'carregar_tabela_cfr'. Sem ela, aposta como 'escolher_acao_gulosa'.
+ *
+ * @param mao O estado da mão em andamento.
+ * @param jogador O jogador que deve agir.
+ * @return A ação escolhida.
+ */
+struct acao escolher_acao_cfr(const struct estado_mao *mao, const struct jogador *jogador);
+
+/**
+ * @brief Lista as ações permitidas ao jogador da vez.
+ *
+ * Com truco pendente, aceitar ou recusar; senão, cada carta da mão e, quando permitido,
+ * o pedido de truco para o próximo valor.
+ *
+ * @param mao O estado da mão em andamento.
+ * @param acoes Vetor com espaço para MAX_ACOES_LEGAIS ações.
+ * @return A quantidade de ações escritas em 'acoes'.
+ */
+int gerar_acoes_legais(const struct estado_mao *mao, struct acao acoes[]);
+
+/**
+ * @brief Copia as regras e as cartas de uma mão para o estado compacto usado pelas buscas.
+ * @param mao O estado da mão em andamento.
+ * @param jogo O estado compacto a preencher (cerca de 80 bytes, sem ponteiros).
+ */
+void extrair_estado_jogo(const struct estado_mao *mao, struct estado_jogo *jogo);
+
+/**
+ * @brief O assento da vez no estado compacto, como em 'assento_da_vez'.
+ * @param jogo O estado compacto.
+ * @return O assento (0 é quem abriu a vaza atual).
+ */
+static inline int assento_da_vez_jogo(const struct estado_jogo *jogo)
+{
+    if (jogo->truco_pendente)
+        return (jogo->jogadas_na_rodada + 1) % (2 * jogo->qtd_jogadores_cada_time);
+    return jogo->jogadas_na_rodada;
+}
+
+/**
+ * @brief O time de um assento no estado compacto, como em 'time_do_assento'.
+ * @param jogo O estado compacto.
+ * @param assento O assento.
+ * @return O time (1 ou 2).
+ */
+static inline int time_do_assento_jogo(const struct estado_jogo *jogo, int assento)
+{
+    return assento % 2 == 0 ? jogo->time_ganhador : 3 - jogo->time_ganhador;
+}
+
+/**
+ * @brief Lista as ações permitidas ao jogador da vez no estado compacto, na mesma ordem de 'gerar_acoes_legais'.
+ * @param jogo O estado compacto.
+ * @param acoes Vetor com espaço para MAX_ACOES_LEGAIS ações.
+ * @return A quantidade de ações escritas em 'acoes'.
+ */
+int gerar_jogadas(const struct estado_jogo *jogo, struct acao acoes[]);
+
+/**
+ * @brief Aplica uma ação ao estado compacto, com as mesmas regras de 'aplicar_acao'.
+ * @param jogo O estado compacto.
+ * @param acao A ação do jogador da vez.
+ * @param memoria Onde guardar o necessário para 'desfazer_jogada', ou NULL se ela não será desfeita.
+ * @return O efeito da ação; com ACAO_INVALIDA nada é alterado.
+ */
+enum resultado_acao fazer_jogada(struct estado_jogo *jogo, struct acao acao, struct memoria_jogada *memoria);
+
+/**
+ * @brief Desfaz a última ação aplicada com 'fazer_jogada', sem copiar o estado inteiro.
+ * @param jogo O estado compacto.
+ * @param memoria A memória preenchida por 'fazer_jogada'.
+ */
+void desfazer_jogada(struct estado_jogo *jogo, const struct memoria_jogada *memoria);
+
+/**
+ * @brief Decisão aleatória no estado compacto, com os mesmos sorteios de 'escolher_acao_aleatoria'.
+ * @param jogo O estado compacto.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ * @return A ação sorteada.
+ */
+struct acao escolher_jogada_aleatoria(const struct estado_jogo *jogo, struct gerador *gerador);
+
+/**
+ * @brief Prepara o sorteio repetido das mãos que um jogador não vê.
+ *
+ * Guarda as cartas não vistas em dois vetores, manilhas e comuns, para que cada carta
+ * sorteada custe um número aleatório e uma troca, sem percorrer conjuntos nem sortear de novo.
+ * Com 'peso_manilha' maior que 1, se o último truco foi pedido pelos adversários, as mãos
+ * deles são sorteadas primeiro, e nelas cada manilha conta como 'peso_manilha' cartas comuns.
+ * Um pedido do próprio time não muda nada: quem pediu foi o jogador ou o parceiro, e o
+ * pedido do parceiro não diz mais do que o jogador já sabe da sua própria mão.
+ *
+ * @param amostrador O amostrador a preparar.
+ * @param jogo O estado compacto visto pelo jogador.
+ * @param assento O assento do jogador.
+ * @param peso_manilha O peso das manilhas dos adversários que pediram truco (1 para sorteio uniforme).
+ */
+void preparar_amostrador(struct amostrador_maos *amostrador, const struct estado_jogo *jogo, int assento, int peso_manilha);
+
+/**
+ * @brief Sorteia as mãos ocultas de uma cópia do estado a partir do amostrador.
+ *
+ * Cada jogador oculto recebe a quantidade de cartas que tem no estado. O amostrador só é
+ * reordenado e continua servindo para os próximos sorteios; não pode ser usado por duas
+ * threads ao mesmo tempo.
+ *
+ * @param amostrador O amostrador preparado para este estado.
+ * @param jogo Ponteiro para uma cópia do estado compacto, que é alterada.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ */
+void amostrar_maos(struct amostrador_maos *amostrador, struct estado_jogo *jogo, struct gerador *gerador);
+
+/**
+ * @brief Confere o amostrador de mãos ocultas em uma mesa de 4 jogadores com sementes fixas.
+ *
+ * As amostras precisam respeitar as cartas vistas e as quantidades de cada mão, ser uniformes
+ * sem inferência e, com peso, favorecer só os adversários que pediram truco: um pedido do
+ * próprio time deixa a mão do parceiro uniforme.
+ *
+ * @return Verdadeiro se todas as conferências passaram.
+ */
+bool testar_amostrador_maos(void);
+
+/**
+ * @brief Decisão de um robô que usa busca em árvore Monte Carlo sobre conjuntos de informação (IS-MCTS).
+ *
+ * A cada playout, sorteia as mãos ocultas com 'amostrar_maos', desce pela árvore
+ * com UCB entre as ações permitidas naquela amostra, expande uma ação nova e termina a mão
+ * com jogadas aleatórias. Busca até esgotar o orçamento de 'configuracao_mcts' e escolhe a
+ * ação mais visitada. Decide tanto a carta quanto pedir, aumentar, aceitar ou recusar o truco.
+ *
+ * Com 'threads_por_decisao' maior que 1, threads ajudantes da thread atual expandem a mesma
+ * árvore: os contadores dos nós são atômicos, os filhos novos entram por compare-and-swap e
+ * cada nó no caminho de uma thread leva uma perda virtual, para as outras explorarem outros
+ * ramos. O orçamento vale para a decisão inteira; o resultado deixa de ser reproduzível.
+ *
+ * @param mao O estado da mão em andamento.
+ * @param jogador O jogador que deve agir.
+ * @return A ação escolhida.
+ */
+struct acao escolher_acao_mcts(const struct estado_mao *mao, const struct jogador *jogador);
+
+// Robôs que podem ser inscritos em um torneio, pelo nome.
+static const struct robo_registrado ROBOS_REGISTRADOS[] = {
+    {"aleatorio", escolher_acao_aleatoria},
+    {"guloso", escolher_acao_gulosa},
+    {"cauteloso", escolher_acao_cautelosa},
+    {"tabela", escolher_acao_tabela},
+    {"cfr", escolher_acao_cfr},
+    {"mcts", escolher_acao_mcts}};
+
+/**
+ * @brief Prepara um resolvedor, limpando a tabela de transposição.
+ * @param resolvedor Ponteiro para o resolvedor (cerca de 1 MB; cada thread usa o seu).
+ */
+void iniciar_resolvedor(struct resolvedor *resolvedor);
+
+/**
+ * @brief Resolve as vazas restantes de uma mão com todas as cartas conhecidas (informação perfeita).
+ *
+ * Busca minimax com poda alfa-beta entre as duas equipes, ordenando as cartas pela força e
+ * guardando os estados já resolvidos na tabela de transposição, indexada por chaves Zobrist.
+ * Considera apenas as cartas: um truco pendente é tratado como aceito.
+ *
+ * @param resolvedor Ponteiro para o resolvedor já iniciado.
+ * @param mao O estado da mão, com as mãos de todos os jogadores.
+ * @return O time (1 ou 2) que vence a mão com jogo perfeito dos dois lados.
+ */
+int resolver_mao(struct resolvedor *resolvedor, const struct estado_mao *mao);
+
+/**
+ * @brief Distribui mãos aleatórias, resolve cada uma com 'resolver_mao' e exibe quem vence e o tempo por mão.
+ * @param qtd_maos Quantidade de mãos a resolver.
+ * @param numero_jogadores Número total de jogadores na mesa (2, 4 ou 6).
+ * @param semente A semente das distribuições.
+ */
+void analisar_maos_resolvidas(long long qtd_maos, int numero_jogadores, uint64_t semente);
+
+/**
+ * @brief Executa o servidor de mesas: um laço de eventos (epoll) que hospeda muitas partidas ao mesmo tempo.
+ *
+ * Protocolo de texto, uma mensagem por linha. O cliente envia "ENTRAR <jogadores> [humanos]",
+ * "JOGAR <carta>", "TRUCO", "ACEITAR", "CORRER" ou "SAIR"; o servidor responde com
+ * "VEZ JOGAR <valor> <pode_truco> <cartas>" ou "VEZ RESPONDER <valor>" quando é a vez do
+ * jogador e anuncia o andamento com "MESA", "MAO", "JOGOU", "TRUCO", "ACEITOU", "CORREU",
+ * "VAZA", "FIM_MAO", "FIM", "TEMPO" e "ERRO". Quem não age dentro do prazo tem a jogada
+ * feita pelo servidor, e os lugares sem conexão são ocupados por robôs.
+ *
+ * @param endereco Uma porta TCP (por exemplo, "7000") ou o caminho de um socket Unix.
+ * @param segundos_por_turno Prazo de cada jogada remota.
+ * @param semente A semente das distribuições.
+ * @param robo Quem joga pelos lugares sem conexão, pelos jogadores que saem e pelos que perdem o prazo.
+ * @return 0 quando o servidor é interrompido (SIGINT ou SIGTERM), ou 1 se não foi possível iniciá-lo.
+ */
+int executar_servidor(const char *endereco, double segundos_por_turno, uint64_t semente, decisao_jogador robo);
+
+/**
+ * @brief Cliente sintético de carga: abre uma conexão por mesa, joga ao acaso e mede a vazão e a latência.
+ *
+ * A latência de um turno é o tempo entre enviar uma jogada e receber a próxima mensagem "VEZ"
+ * ou "FIM". Ao final, exibe as ações por segundo e os percentis 50 e 99 da latência.
+ *
+ * @param endereco O endereço do servidor, no mesmo formato de 'executar_servidor'.
+ * @param qtd_mesas Quantidade de mesas simultâneas (uma conexão humana em cada).
+ * @param numero_jogadores Jogadores em cada mesa (2, 4 ou 6).
+ * @param segundos Duração do teste.
+ * @param semente A semente das jogadas do cliente.
+ * @return 0 se o teste terminou, ou 1 se não foi possível conectar.
+ */
+int executar_teste_carga(const char *endereco, int qtd_mesas, int numero_jogadores, double segundos, uint64_t semente);
+
+/**
+ * @brief Encerra as threads ajudantes e libera a arena de nós do robô MCTS da thread atual (alocadas na primeira decisão).
+ */
+void liberar_arvore_mcts(void);
+
+/**
+ * @brief Exibe as decisões e a vazão de playouts do robô MCTS.
+ * @param estatisticas As estatísticas acumuladas.
+ */
+void exibir_estatisticas_mcts(const struct estatisticas_mcts *estatisticas);
+
+/**
+ * @brief Aumenta o valor da aposta do truco na partida.
+ * @param valor_partida Ponteiro para o valor atual dos pontos em jogo na rodada, que será incrementado.
+ */
+void aumentar_truco(int *valor_partida);
+
+/**
+ * @brief Retorna o assento (ordem de jogada na vaza) de quem deve agir agora.
+ *
+ * O assento 0 é o primeiro jogador do time que começa a vaza; os times se alternam.
+ * Quando há truco pendente, quem age é o próximo assento, do time adversário.
+ *
+ * @param mao O estado da mão em andamento.
+ * @return O assento do jogador da vez.
+ */
+int assento_da_vez(const struct estado_mao *mao);
+
+/**
+ * @brief Informa a qual time pertence um assento na vaza atual.
+ * @param mao O estado da mão em andamento.
+ * @param assento O assento consultado.
+ * @return O identificador do time (1 ou 2).
+ */
+int time_do_assento(const struct estado_mao *mao, int assento);
+
+/**
+ * @brief Índice (no registro da partida) do jogador de um time que está em uma posição da vaza atual.
+ *
+ * A ordem de cada time é só um deslocamento sobre o registro: girar os jogadores é uma soma.
+ *
+ * @param mao O estado da mão em andamento.
+ * @param time O time (1 ou 2).
+ * @param posicao A posição do jogador no seu time, de 0 (quem joga primeiro) em diante.
+ * @return O índice do jogador em 'mao->jogadores[time - 1]' e 'mao->maos[time - 1]'.
+ */
+static inline int indice_na_posicao(const struct estado_mao *mao, int time, int posicao)
+{
+    int indice = mao->inicio[time - 1] + posicao;
+    return indice >= mao->qtd_jogadores_cada_time ? indice - mao->qtd_jogadores_cada_time : indice;
+}
+
+// Versões do motor com o número de jogadores de cada time ('qtd') fixo. Cada uma é chamada
+// com 'qtd' constante (1, 2 ou 3), e o compilador gera uma cópia para cada tamanho de mesa,
+// com os laços de tamanho conhecido e sem testar o tamanho a cada vaza.
+
+ESPECIALIZADA int indice_na_posicao_fixa(const struct estado_mao *mao, int time, int posicao, const int qtd)
+{
+    int indice = mao->inicio[time - 1] + posicao;
+    return indice >= qtd ? indice - qtd : indice;
+}
+
+ESPECIALIZADA int assento_da_vez_fixa(const struct estado_mao *mao, const int qtd)
+{
+    if (mao->truco_pendente)
+        return (mao->jogadas_na_rodada + 1) % (2 * qtd);
+    return mao->jogadas_na_rodada;
+}
+
+ESPECIALIZADA void embaralhar_fixa(uint64_t maos_1[], uint64_t maos_2[], struct baralho *baralho, struct gerador *gerador, struct carta *vira, const int qtd);
+ESPECIALIZADA int encerrar_mao_fixa(struct partida *partida, const struct estado_mao *mao, const int qtd);
+
+/**
+ * @brief Retorna o jogador sentado em um assento da vaza atual.
+ * @param mao O estado da mão em andamento.
+ * @param assento O assento consultado.
+ * @return Um ponteiro para o jogador, no registro da partida.
+ */
+const struct jogador *jogador_do_assento(const struct estado_mao *mao, int assento);
+
+/**
+ * @brief Retorna as cartas do jogador sentado em um assento da vaza atual.
+ * @param mao O estado da mão em andamento.
+ * @param assento O assento consultado.
+ * @return O conjunto das cartas que o jogador ainda tem.
+ */
+uint64_t cartas_do_assento(const struct estado_mao *mao, int assento);
+
+/**
+ * @brief Verifica se um time pode pedir (ou aumentar) o truco agora.
+ * @param mao O estado da mão em andamento.
+ * @param time O time que deseja pedir.
+ * @return Verdadeiro se o pedido é permitido.
+ */
+bool pode_pedir_truco(const struct estado_mao *mao, int time);
+
+/**
+ * @brief Prepara uma nova mão: aponta para os jogadores da partida, embaralha e distribui as cartas.
+ * @param mao Ponteiro para o estado da mão a ser iniciado.
+ * @param partida A partida em andamento.
+ */
+void iniciar_mao(struct estado_mao *mao, struct partida *partida);
+
+/**
+ * @brief Prepara uma nova mão com uma distribuição já conhecida, sem sortear nada.
+ *
+ * A mão 'maos[t][i]' vai para quem está na posição 'i' do time 't + 1', como em 'iniciar_mao'.
+ *
+ * @param mao Ponteiro para o estado da mão a ser iniciado.
+ * @param partida A partida em andamento.
+ * @param distribuicao A vira e as mãos, com o mesmo número de jogadores da partida.
+ */
+void iniciar_mao_distribuida(struct estado_mao *mao, struct partida *partida, const struct distribuicao *distribuicao);
+
+/**
+ * @brief Aplica a ação do jogador da vez ao estado da mão, sem nenhuma entrada ou saída.
+ * @param mao Ponteiro para o estado da mão em andamento.
+ * @param acao A ação escolhida pelo jogador da vez.
+ * @return O efeito da ação (inválida, continua, fim de vaza ou fim de mão).
+ */
+enum resultado_acao aplicar_acao(struct estado_mao *mao, struct acao acao);
+
+/**
+ * @brief Joga uma mão completa, pedindo as ações a cada jogador, e atualiza a pontuação da partida.
+ * @param partida Ponteiro para a partida em andamento.
+ * @return O time que venceu a mão.
+ */
+int jogar_mao(struct partida *partida);
+
+/**
+ * @brief Soma o valor de uma mão encerrada ao placar e gira os jogadores para a próxima mão.
+ * @param partida Ponteiro para a partida em andamento.
+ * @param mao A mão que acabou de terminar.
+ * @return O time que venceu a mão.
+ */
+int encerrar_mao(struct partida *partida, const struct estado_mao *mao);
+
+/**
+ * @brief Prepara uma partida nova com os times informados.
+ * @param partida Ponteiro para a partida a ser iniciada.
+ * @param time_1 Jogadores da Equipe 1.
+ * @param time_2 Jogadores da Equipe 2.
+ * @param qtd_jogadores_cada_time Número de jogadores em cada equipe.
+ * @param eventos Quem recebe os eventos da partida ('saida_terminal' no modo interativo), ou NULL.
+ * @param semente A semente da execução.
+ * @param indice O número da partida; com a semente, determina todas as distribuições.
+ */
+void iniciar_partida(struct partida *partida, struct jogador time_1[], struct jogador time_2[], int qtd_jogadores_cada_time, struct saida_eventos *eventos, uint64_t semente, uint64_t indice);
+
+/**
+ * @brief Joga mãos até que um dos times alcance PONTOS_PARA_VENCER.
+ * @param partida Ponteiro para a partida já iniciada.
+ * @return O time vencedor da partida.
+ */
+int jogar_partida(struct partida *partida);
+
+/**
+ * @brief Divide os itens [0, qtd_itens) em uma faixa contígua por thread.
+ * @param distribuidor Ponteiro para o distribuidor a ser iniciado.
+ * @param qtd_itens Quantidade total de itens (por exemplo, partidas).
+ * @param qtd_threads Quantidade de threads que vão consumir os itens.
+ * @param tamanho_lote Quantos itens uma thread pega de cada vez.
+ */
+void iniciar_distribuidor(struct distribuidor_trabalho *distribuidor, long long qtd_itens, int qtd_threads, long long tamanho_lote);
+
+/**
+ * @brief Pega o próximo lote de itens para uma thread, sem travas.
+ *
+ * A thread consome primeiro a própria faixa; quando ela acaba, rouba lotes das
+ * faixas das outras threads, de modo que nenhuma fica parada enquanto houver trabalho.
+ *
+ * @param distribuidor Ponteiro para o distribuidor.
+ * @param thread O índice da thread que pede o lote.
+ * @param inicio Ponteiro onde é escrito o primeiro item do lote.
+ * @param fim Ponteiro onde é escrito o fim (exclusivo) do lote.
+ * @return Falso quando não há mais itens em nenhuma faixa.
+ */
+bool pegar_lote(struct distribuidor_trabalho *distribuidor, int thread, long long *inicio, long long *fim);
+
+/**
+ * @brief Executa 'tarefa' em 'qtd_threads' threads e espera todas terminarem.
+ * @param qtd_threads Quantidade de threads (a thread atual é a de índice 0).
+ * @param tarefa A função executada por cada thread, que recebe o índice da thread e o contexto.
+ * @param contexto Ponteiro repassado a todas as threads.
+ */
+void executar_em_paralelo(int qtd_threads, void (*tarefa)(int thread, void *contexto), void *contexto);
+
+/**
+ * @brief Informa quantos processadores lógicos a máquina possui.
+ * @return A quantidade de processadores (ao menos 1).
+ */
+int qtd_processadores(void);
+
+/**
+ * @brief Joga as partidas [inicio, fim) entre robôs e acumula o resultado, sem entrada ou saída.
+ * @param resultado Ponteiro para o resultado acumulado da thread.
+ * @param numero_jogadores Número total de jogadores na mesa (2, 4 ou 6).
+ * @param semente A semente da execução; a partida 'n' usa o par (semente, n).
+ * @param inicio A primeira partida do lote.
+ * @param fim O fim (exclusivo) do lote.
+ * @param decisao_time_1 Robô que joga pela Equipe 1 (a Equipe 2 joga com 'escolher_acao_aleatoria').
+ * @param historico Buffer de histórico da thread, ou NULL para não registrar as partidas.
+ * @param eventos Saída de eventos da thread, ou NULL para não gerar eventos.
+ */
+void simular_lote(struct resultado_simulacao *resultado, int numero_jogadores, uint64_t semente, long long inicio, long long fim, decisao_jogador decisao_time_1, struct historico *historico, struct saida_eventos *eventos);
+
+/**
+ * @brief Executa partidas entre robôs em várias threads, sem entrada ou saída no terminal, e exibe as estatísticas.
+ *
+ * Cada partida depende apenas de (semente, número da partida) e os resultados são somas,
+ * então a saída é a mesma para qualquer quantidade de threads.
+ *
+ * @param qtd_partidas Quantidade de partidas a simular.
+ * @param numero_jogadores Número total de jogadores na mesa (2, 4 ou 6).
+ * @param semente A semente da execução; a partida 'n' usa o par (semente, n).
+ * @param qtd_threads Quantidade de threads de trabalho.
+ * @param decisao_time_1 Robô que joga pela Equipe 1 contra o robô aleatório.
+ * @param destino Arquivo de histórico que recebe as partidas, ou NULL.
+ * @param arquivo_eventos Arquivo que recebe os eventos em texto ('emitir_fluxo'), ou NULL.
+ */
+void simular_partidas(long long qtd_partidas, int numero_jogadores, uint64_t semente, int qtd_threads, decisao_jogador decisao_time_1, struct arquivo_historico *destino, FILE *arquivo_eventos);
+
+/**
+ * @brief Procura um robô em ROBOS_REGISTRADOS.
+ * @param nome O nome do robô.
+ * @return O robô, ou NULL se não há nenhum com esse nome.
+ */
+const struct robo_registrado *buscar_robo(const char *nome);
+
+/**
+ * @brief Inscreve em um torneio os robôs de uma lista separada por vírgulas ("todos" inscreve cada robô registrado).
+ *
+ * O mesmo robô pode aparecer mais de uma vez; a partir da segunda, o nome ganha o sufixo "#n".
+ *
+ * @param torneio Ponteiro para o torneio, zerado.
+ * @param lista Os nomes, por exemplo "guloso,aleatorio,mcts".
+ * @return Verdadeiro se todos os nomes são robôs registrados e couberam no torneio.
+ */
+bool inscrever_robos(struct torneio *torneio, const char *lista);
+
+/**
+ * @brief Joga as partidas [inicio, fim) de um confronto, sem entrada ou saída.
+ *
+ * As partidas 2k e 2k + 1 recebem as mesmas cartas, com os robôs trocando de equipe, o que
+ * tira da comparação boa parte da sorte da distribuição.
+ *
+ * @param torneio O torneio.
+ * @param confronto O confronto.
+ * @param inicio A primeira partida do trecho, contada dentro do confronto.
+ * @param fim O fim (exclusivo) do trecho.
+ * @return Quantas dessas partidas o participante 'a' venceu.
+ */
+long long jogar_confronto(const struct torneio *torneio, const struct confronto_torneio *confronto, long long inicio, long long fim);
+
+/**
+ * @brief Estima as forças (Bradley-Terry) e o Elo dos participantes a partir dos confrontos jogados até agora.
+ *
+ * Usa o algoritmo MM de Hunter, partindo das forças atuais, de modo que cada atualização com
+ * poucas partidas novas converge em poucas iterações. Cada robô recebe uma vitória e uma derrota
+ * contra um adversário médio, para que a estimativa exista mesmo sem vitórias. O erro vem da
+ * informação de Fisher de cada robô, com as forças dos outros fixas.
+ *
+ * @param torneio O torneio; os placares dos confrontos podem estar mudando em outras threads.
+ */
+void estimar_forcas_torneio(struct torneio *torneio);
+
+/**
+ * @brief Executa um torneio entre robôs em várias threads e exibe a classificação com o intervalo de confiança de cada Elo.
+ *
+ * Em todos contra todos, cada par de robôs joga 'partidas_por_confronto' partidas. No sistema suíço,
+ * cada rodada junta os robôs de Elo próximo que ainda não se enfrentaram. As partidas de uma rodada
+ * são divididas entre as threads com 'pegar_lote', e a classificação parcial é exibida enquanto elas
+ * terminam. O resultado depende apenas da semente, não da quantidade de threads.
+ *
+ * @param torneio O torneio, com os participantes inscritos.
+ * @param rodadas_suicas Rodadas do sistema suíço, ou 0 para todos contra todos.
+ * @param qtd_threads Quantidade de threads de trabalho.
+ * @param arquivo_classificacao Arquivo CSV que recebe a classificação final, ou NULL.
+ * @return Verdadeiro se o torneio foi jogado (e a classificação gravada).
+ */
+bool executar_torneio(struct torneio *torneio, int rodadas_suicas, int qtd_threads, const char *arquivo_classificacao);
+
+/**
+ * @brief Abre um arquivo de histórico para acréscimo, gravando o cabeçalho se ele for novo.
+ * @param arquivo Ponteiro para a estrutura a ser preenchida.
+ * @param caminho O arquivo; se já existir, precisa ser um histórico no mesmo formato.
+ * @return Verdadeiro se o arquivo foi aberto.
+ */
+bool abrir_arquivo_historico(struct arquivo_historico *arquivo, const char *caminho);
+
+/**
+ * @brief Fecha um arquivo de histórico (os buffers das threads devem ter sido descarregados antes).
+ *
+ * Avisa se algum registro foi descartado por falta de memória, caso em que o arquivo está incompleto.
+ *
+ * @param arquivo Ponteiro para o arquivo aberto.
+ * @return Verdadeiro se todos os registros foram gravados.
+ */
+bool fechar_arquivo_historico(struct arquivo_historico *arquivo);
+
+/**
+ * @brief Prepara o buffer de registros de uma thread.
+ * @param historico Ponteiro para o buffer.
+ * @param destino O arquivo onde os registros serão gravados.
+ */
+void iniciar_historico(struct historico *historico, struct arquivo_historico *destino);
+
+/**
+ * @brief Acrescenta um registro ao buffer, sem gravar no arquivo.
+ *
+ * Se o buffer não puder crescer, o registro é descartado e contado; a contagem chega ao
+ * arquivo em 'descarregar_historico' e é informada por 'fechar_arquivo_historico'.
+ *
+ * @param historico Ponteiro para o buffer.
+ * @param registro O registro.
+ * @return Falso se o registro foi descartado.
+ */
+bool registrar_historico(struct historico *historico, struct registro_historico registro);
+
+/**
+ * @brief Grava o buffer no arquivo, de uma vez e com a trava, e o esvazia.
+ *
+ * Só deve ser chamada entre partidas, para que os registros de uma partida fiquem contíguos no arquivo.
+ *
+ * @param historico Ponteiro para o buffer.
+ */
+void descarregar_historico(struct historico *historico);
+
+/**
+ * @brief Descarrega o buffer e libera a sua memória.
+ * @param historico Ponteiro para o buffer.
+ */
+void liberar_historico(struct historico *historico);
+
+/**
+ * @brief Acumula as estatísticas das partidas que começam em [inicio, fim) de um histórico mapeado.
+ *
+ * Uma partida que começa dentro do intervalo é lida até o fim, mesmo que passe de 'fim', e as
+ * que começam antes de 'inicio' são puladas; assim, intervalos vizinhos podem ser lidos por
+ * threads diferentes sem dividir nenhuma partida. Não aloca memória nem converte texto.
+ *
+ * @param registros Os registros do arquivo (depois do cabeçalho).
+ * @param qtd Quantidade de registros no arquivo.
+ * @param inicio O primeiro registro do intervalo.
+ * @param fim O fim (exclusivo) do intervalo.
+ * @param estatisticas Estatísticas da thread, acumuladas.
+ */
+void analisar_registros(const struct registro_historico *registros, long long qtd, long long inicio, long long fim, struct estatisticas_historico *estatisticas);
+
+/**
+ * @brief Mapeia os arquivos de histórico para a memória, analisa todos em paralelo e exibe as estatísticas.
+ * @param caminhos Os arquivos gravados com --log.
+ * @param qtd_arquivos Quantidade de arquivos.
+ * @param qtd_threads Quantidade de threads de trabalho.
+ * @return Verdadeiro se todos os arquivos foram lidos.
+ */
+bool analisar_historicos(const char *caminhos[], int qtd_arquivos, int qtd_threads);
+
+/**
+ * @brief Lê o relógio de parede com resolução de nanossegundos.
+ * @return O instante atual, em segundos.
+ */
+double tempo_atual(void);
+
+#ifdef INSTRUMENTACAO
+// O relógio depende só da arquitetura, para que as medições de builds com e sem o avaliador AVX2 sejam comparáveis
+#if defined(__x86_64__) || defined(__i386__)
+#define RELOGIO_INSTRUMENTACAO "rdtsc (ciclos)"
+#else
+#define RELOGIO_INSTRUMENTACAO "timespec_get (ns)"
+#endif
+
+/**
+ * @brief Lê o relógio da instrumentação: o contador de ciclos (rdtsc) em x86, ou nanossegundos nos demais.
+ */
+static inline uint64_t ler_relogio_instrumentacao(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec agora;
+    timespec_get(&agora, TIME_UTC);
+    return (uint64_t)agora.tv_sec * 1000000000u + (uint64_t)agora.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Soma uma medição aos contadores da thread atual; as decisões também entram no histograma.
+ * @param fase A fase medida.
+ * @param tiques A duração, em tiques do relógio da instrumentação.
+ */
+void registrar_medicao(enum fase_instrumentacao fase, uint64_t tiques);
+
+/**
+ * @brief Soma os contadores da thread atual ao total do processo e os zera (chamada ao fim de cada thread de trabalho).
+ */
+void somar_instrumentacao_thread(void);
+
+/**
+ * @brief Marca o início da execução, usado para converter tiques em nanossegundos.
+ */
+void iniciar_instrumentacao(void);
+
+/**
+ * @brief Grava as contagens, os tempos e o histograma de latência das decisões em JSON ou, se o nome termina em ".csv", em CSV.
+ * @param caminho O arquivo a ser gravado.
+ * @return Verdadeiro se o arquivo foi gravado.
+ */
+bool gravar_instrumentacao(const char *caminho);
+#endif
+
+/**
+ * @brief Guarda uma medição no relatório (ignorada se o relatório estiver cheio).
+ * @param relatorio Ponteiro para o relatório.
+ * @param nome Identificador da medição.
+ * @param jogadores Jogadores na mesa (0 quando não se aplica).
+ * @param repeticoes Operações executadas.
+ * @param segundos Tempo total das operações.
+ * @return O tempo médio por operação, em nanossegundos.
+ */
+double registrar_benchmark(struct relatorio_benchmark *relatorio, const char *nome, int jogadores, long long repeticoes, double segundos);
+
+/**
+ * @brief Mede o tempo médio de uma distribuição completa (mãos e vira) para 2, 4 e 6 jogadores,
+ * comparando o baralho com Fisher-Yates parcial ao caminho antigo com sorteio e repetição.
+ * @param relatorio Ponteiro para o relatório onde as medições são guardadas.
+ */
+void executar_benchmark_distribuicao(struct relatorio_benchmark *relatorio);
+
+/**
+ * @brief Mede a vazão de 'comparar_cartas' contra a comparação antiga, por regras, sobre os mesmos pares de cartas.
+ * @param relatorio Ponteiro para o relatório onde as medições são guardadas.
+ */
+void executar_benchmark_comparacao(struct relatorio_benchmark *relatorio);
+
+/**
+ * @brief Mede, para 2, 4 e 6 jogadores, uma vaza, uma mão completa e uma partida de 12 pontos entre robôs aleatórios.
+ *
+ * Todas as distribuições e decisões vêm de sementes fixas, então cada execução faz exatamente o mesmo trabalho.
+ *
+ * @param relatorio Ponteiro para o relatório onde as medições são guardadas.
+ */
+void executar_benchmark_motor(struct relatorio_benchmark *relatorio);
+
+/**
+ * @brief Mede, para 2, 4 e 6 jogadores, mãos jogadas carta a carta contra mãos resolvidas em lote, e confere que os vencedores são os mesmos.
+ * @param relatorio Ponteiro para o relatório onde as medições são guardadas.
+ */
+void executar_benchmark_lote(struct relatorio_benchmark *relatorio);
+
+/**
+ * @brief Grava as medições do relatório em JSON, para comparar execuções com uma referência.
+ * @param relatorio O relatório preenchido pelos benchmarks.
+ * @param caminho O arquivo a ser gravado.
+ * @return Verdadeiro se o arquivo foi gravado.
+ */
+bool gravar_benchmark_json(const struct relatorio_benchmark *relatorio, const char *caminho);
+
+/**
+ * @brief Decide uma mão de duas pessoas em que cada uma joga suas cartas da mais forte para a mais fraca.
+ *
+ * Usa as mesmas regras de 'rodada_truco': empate na primeira faz a vaza seguinte valer 2,
+ * empates seguintes dão vitória aos dois e, com 2 a 2, vence quem fez a primeira
+ * (ou quem começou, se a primeira empatou).
+ *
+ * @param nossas Forças das nossas cartas, em ordem decrescente.
+ * @param deles Forças das cartas do adversário, em ordem decrescente.
+ * @param comecamos Verdadeiro se nós começamos a mão.
+ * @return Verdadeiro se nós vencemos a mão.
+ */
+bool vence_mao_ordenada(const uint8_t nossas[3], const uint8_t deles[3], bool comecamos);
+
+/**
+ * @brief Calcula a equidade exata de uma mão contra uma mão adversária aleatória.
+ *
+ * Enumera todas as mãos possíveis do adversário entre as 36 cartas restantes, agrupadas por
+ * força, e avalia cada uma com 'vence_mao_ordenada', na média entre começar e não começar.
+ *
+ * @param mao O conjunto de 3 cartas da mão.
+ * @param vira A carta "vira", que não pode estar na mão.
+ * @return A probabilidade de vencer a mão, de 0 a 1.
+ */
+double calcular_equidade(uint64_t mao, struct carta vira);
+
+/**
+ * @brief Posição de uma mão de 3 cartas na tabela de equidade, já normalizada para a vira de Ouros.
+ *
+ * Os naipes só importam para as manilhas; por isso, trocar o naipe da vira pelo de Ouros
+ * (apenas nas cartas do mesmo número da vira) não muda a equidade.
+ *
+ * @param mao O conjunto de 3 cartas da mão.
+ * @param vira A carta "vira".
+ * @return O índice da entrada na tabela.
+ */
+size_t indice_equidade(uint64_t mao, struct carta vira);
+
+/**
+ * @brief Quantidade de distribuições distintas (vira e as 3 cartas de cada jogador) para um tamanho de mesa.
+ * @param qtd_jogadores_cada_time O número de jogadores em cada equipe.
+ * @return 40 * C(39, 3) * C(36, 3) * ..., uma combinação de 3 cartas por jogador.
+ */
+indice_distribuicao qtd_distribuicoes(int qtd_jogadores_cada_time);
+
+/**
+ * @brief Número de uma distribuição, de 0 a 'qtd_distribuicoes' - 1, no sistema numérico combinatório.
+ *
+ * A vira é o dígito mais significativo; depois vêm as mãos na ordem em que são distribuídas
+ * (Equipe 1 e Equipe 2 alternadas), cada uma numerada entre as cartas que ainda restam.
+ * Números vizinhos mudam primeiro a última mão, então uma faixa contígua de números é
+ * um bloco de trabalho que pode ser dividido entre threads ou máquinas.
+ *
+ * @param distribuicao A distribuição.
+ * @return O número da distribuição.
+ */
+indice_distribuicao numerar_distribuicao(const struct distribuicao *distribuicao);
+
+/**
+ * @brief Reconstrói a distribuição de um número, o inverso de 'numerar_distribuicao'.
+ * @param indice O número da distribuição.
+ * @param qtd_jogadores_cada_time O número de jogadores em cada equipe.
+ * @param distribuicao Recebe a distribuição.
+ * @return Falso se o número passa de 'qtd_distribuicoes'.
+ */
+bool gerar_distribuicao(indice_distribuicao indice, int qtd_jogadores_cada_time, struct distribuicao *distribuicao);
+
+/**
+ * @brief Passa para a distribuição de número seguinte, sem divisões de 128 bits.
+ *
+ * Na maioria das vezes só a última mão muda, para a próxima combinação na ordem colexicográfica.
+ *
+ * @param distribuicao A distribuição, alterada.
+ * @return Falso se ela já era a última.
+ */
+bool avancar_distribuicao(struct distribuicao *distribuicao);
+
+/**
+ * @brief Confere que 'numerar_distribuicao' inverte 'gerar_distribuicao' e acompanha 'avancar_distribuicao'.
+ *
+ * Para cada tamanho de mesa, testa a primeira e a última distribuição e números sorteados,
+ * e que o número seguinte ao último é recusado. Exibe cada divergência encontrada.
+ *
+ * @return Verdadeiro se não houve divergências.
+ */
+bool testar_numeracao_distribuicoes(void);
+
+/**
+ * @brief Escreve um número de distribuição em decimal.
+ * @param destino Espaço para ao menos 40 caracteres.
+ * @param indice O número.
+ */
+void escrever_indice_distribuicao(char *destino, indice_distribuicao indice);
+
+/**
+ * @brief Lê um número de distribuição em decimal.
+ * @param texto O texto, só com dígitos.
+ * @param indice Recebe o número.
+ * @return Falso se o texto não é um número válido.
+ */
+bool ler_indice_distribuicao(const char *texto, indice_distribuicao *indice);
+
+/**
+ * @brief Resolve com 'resolver_mao' todas as distribuições de números [inicio, fim), em paralelo, e exibe quem vence.
+ *
+ * O Time 1 começa todas as mãos. Ao final, exibe o número por onde continuar, para que uma
+ * análise exaustiva possa ser feita em partes, em várias execuções ou máquinas.
+ *
+ * @param inicio O primeiro número.
+ * @param fim O fim (exclusivo) da faixa.
+ * @param numero_jogadores Número total de jogadores na mesa (2, 4 ou 6).
+ * @param qtd_threads Quantidade de threads de trabalho.
+ * @return Verdadeiro se a faixa foi analisada.
+ */
+bool analisar_distribuicoes(indice_distribuicao inicio, indice_distribuicao fim, int numero_jogadores, int qtd_threads);
+
+/**
+ * @brief Gera a tabela de equidade de todas as mãos para as 10 viras, em paralelo, e grava em um arquivo binário.
+ * @param caminho O arquivo a ser gravado.
+ * @param qtd_threads Quantidade de threads usadas na enumeração.
+ * @return Verdadeiro se o arquivo foi gravado.
+ */
+bool gerar_tabela_equidade(const char *caminho, int qtd_threads);
+
+/**
+ * @brief Mapeia a tabela de equidade do arquivo para a memória (mmap), sem nenhum cálculo.
+ * @param caminho O arquivo gerado por 'gerar_tabela_equidade'.
+ * @return Verdadeiro se a tabela foi carregada.
+ */
+bool carregar_tabela_equidade(const char *caminho);
+
+/**
+ * @brief Consulta a equidade de uma mão de 3 cartas na tabela carregada, em tempo constante.
+ * @param mao O conjunto de 3 cartas da mão.
+ * @param vira A carta "vira".
+ * @return A probabilidade de vencer a mão, de 0 a 1, ou -1 se a tabela não foi carregada.
+ */
+double equidade_mao(uint64_t mao, struct carta vira);
+
+/**
+ * @brief Gera a tabela de apostas e grava em um arquivo binário.
+ *
+ * Joga mãos sorteadas (com as cartas jogadas como 'escolher_acao_cautelosa') para estimar,
+ * em paralelo, a chance de cada faixa de força vencer a mão em cada vira e estado de vaza.
+ * Com ela e a chance de vencer a partida a partir de cada placar, calcula para cada entrada
+ * a probabilidade de vencer a partida depois de cada 'enum decisao_aposta'.
+ *
+ * @param caminho O arquivo a ser gravado.
+ * @param qtd_maos Mãos sorteadas para cada tamanho de mesa.
+ * @param semente A semente das distribuições.
+ * @param qtd_threads Quantidade de threads usadas na simulação.
+ * @return Verdadeiro se o arquivo foi gravado.
+ */
+bool gerar_tabela_apostas(const char *caminho, long long qtd_maos, uint64_t semente, int qtd_threads);
+
+/**
+ * @brief Mapeia a tabela de apostas do arquivo para a memória (mmap), sem nenhum cálculo.
+ * @param caminho O arquivo gerado por 'gerar_tabela_apostas'.
+ * @return Verdadeiro se a tabela foi carregada.
+ */
+bool carregar_tabela_apostas(const char *caminho);
+
+/**
+ * @brief Consulta na tabela carregada o valor de cada decisão de aposta do jogador de um assento.
+ * @param mao O estado da mão em andamento.
+ * @param assento O assento de quem decide.
+ * @param valores Recebe, para cada 'enum decisao_aposta', a chance de o time dele vencer a partida.
+ * @return Falso se a tabela não foi carregada.
+ */
+bool consultar_apostas(const struct estado_mao *mao, int assento, double valores[QTD_DECISOES_APOSTA]);
+
+/**
+ * @brief Treina as apostas por minimização de arrependimento contrafactual (MCCFR com amostragem externa), em paralelo.
+ *
+ * Cada iteração sorteia uma distribuição (alternando 2, 4 e 6 jogadores) e percorre a mão
+ * uma vez por time: todas as apostas do time treinado são abertas e as do adversário são
+ * sorteadas da estratégia atual. As cartas são sempre as do robô cauteloso. As threads
+ * somam arrependimentos e contagens em tabelas compartilhadas de inteiros de 32 bits, de
+ * tamanho fixo, sem travas. A cada 'segundos_checkpoint' as tabelas são gravadas em
+ * 'caminho', e um treino iniciado sobre um checkpoint continua dele.
+ *
+ * @param caminho O arquivo de checkpoint e da estratégia final.
+ * @param qtd_iteracoes Distribuições treinadas nesta execução.
+ * @param segundos_checkpoint Intervalo entre os checkpoints.
+ * @param semente A semente das distribuições.
+ * @param qtd_threads Quantidade de threads de trabalho.
+ * @return Verdadeiro se a estratégia foi gravada.
+ */
+bool treinar_cfr(const char *caminho, long long qtd_iteracoes, double segundos_checkpoint, uint64_t semente, int qtd_threads);
+
+/**
+ * @brief Mapeia a estratégia treinada por 'treinar_cfr' para a memória (mmap).
+ * @param caminho O arquivo gravado pelo treino.
+ * @return Verdadeiro se a estratégia foi carregada.
+ */
+bool carregar_tabela_cfr(const char *caminho);
+
+/**
+ * @brief Embaralha e distribui as cartas para os jogadores e define a carta "vira".
+ *
+ * Recolhe todas as cartas de volta ao baralho e compra apenas as que a mão precisa.
+ * O resultado depende apenas do estado do gerador.
+ *
+ * @param maos_1 Cartas da Equipe 1, na ordem em que os jogadores recebem.
+ * @param maos_2 Cartas da Equipe 2, na ordem em que os jogadores recebem.
+ * @param numero_jogadores_cada_time O número de jogadores em cada equipe.
+ * @param baralho Um ponteiro para o baralho (já montado) usado na distribuição.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ * @param vira Ponteiro para a carta "vira" da rodada.
+ */
+void embaralhar(uint64_t maos_1[], uint64_t maos_2[], int numero_jogadores_cada_time, struct baralho *baralho, struct gerador *gerador, struct carta *vira);
+
+/**
+ * @brief Distribui as cartas e a vira pelo caminho antigo, sorteando cartas até não repetirem.
+ *
+ * Mantido como referência para o benchmark de distribuição.
+ *
+ * @param maos_1 Cartas da Equipe 1, na ordem em que os jogadores recebem.
+ * @param maos_2 Cartas da Equipe 2, na ordem em que os jogadores recebem.
+ * @param numero_jogadores_cada_time O número de jogadores em cada equipe.
+ * @param gerador Um ponteiro para o gerador usado no sorteio.
+ * @param vira Ponteiro para a carta "vira" da rodada.
+ */
+void embaralhar_por_sorteio(uint64_t maos_1[], uint64_t maos_2[], int numero_jogadores_cada_time, struct gerador *gerador, struct carta *vira);
+
+/**
+ * @brief Compara o valor de duas cartas para determinar qual é a maior, considerando a carta "vira".
+ *
+ * Consulta a tabela FORCAS: duas leituras e uma subtração, sem desvios.
+ *
+ * @param a A primeira carta.
+ * @param b A segunda carta.
+ * @param vira A carta "vira" da rodada.
+ * @return Um valor positivo se 'a' for maior, negativo se 'b' for maior e zero se empatarem.
+ */
+int comparar_cartas(struct carta a, struct carta b, struct carta vira);
+
+/**
+ * @brief Compara duas cartas aplicando as regras de manilha diretamente (versão antiga).
+ *
+ * Mantida como referência para o benchmark de comparação.
+ *
+ * @param a A primeira carta.
+ * @param b A segunda carta.
+ * @param vira A carta "vira" da rodada.
+ * @return '>' se 'a' for maior, '<' se 'b' for maior e '=' se empatarem.
+ */
+char comparar_cartas_por_regras(struct carta a, struct carta b, struct carta vira);
+
+/**
+ * @brief Distribui PISTAS_LOTE mãos independentes e decide de antemão a ordem em que cada jogador joga as suas cartas.
+ *
+ * Cada pista recebe sua vira, suas mãos e o time que começa, e guarda as cartas já na ordem da
+ * política, em estrutura de arrays: a carta de um jogador em uma vaza fica lado a lado nas 32 pistas.
+ *
+ * @param lote Ponteiro para o lote a ser preenchido.
+ * @param qtd_jogadores_cada_time O número de jogadores em cada equipe.
+ * @param politica A ordem em que os jogadores jogam as cartas.
+ * @param baralho Um ponteiro para o baralho (já montado) usado na distribuição.
+ * @param gerador Um ponteiro para o gerador usado nos sorteios.
+ */
+void distribuir_lote_maos(struct lote_maos *lote, int qtd_jogadores_cada_time, enum politica_lote politica, struct baralho *baralho, struct gerador *gerador);
+
+/**
+ * @brief Resolve as PISTAS_LOTE mãos de um lote ao mesmo tempo, sem pedidos de truco.
+ *
+ * Como a ordem das cartas de cada jogador já está decidida, uma vaza depende apenas da maior força
+ * de cada time, e não de quem joga primeiro. As forças (com a detecção das manilhas), os vencedores
+ * das vazas, o empate na primeira e o desempate por quem fez a primeira são calculados para todas as
+ * pistas de uma vez, com AVX2 quando o processador tem, ou pista a pista.
+ *
+ * @param lote O lote preenchido por 'distribuir_lote_maos'.
+ * @param vencedores Recebe o time (1 ou 2) que vence a mão em cada pista.
+ */
+void resolver_lote_maos(const struct lote_maos *lote, uint8_t vencedores[PISTAS_LOTE]);
+
+/**
+ * @brief Joga uma pista do lote carta a carta com 'fazer_jogada', como referência para 'resolver_lote_maos'.
+ * @param lote O lote.
+ * @param pista A pista, de 0 a PISTAS_LOTE - 1.
+ * @return O time (1 ou 2) que vence a mão.
+ */
+int jogar_pista_do_lote(const struct lote_maos *lote, int pista);
+
+/**
+ * @brief Gera uma nova carta aleatória e a retorna se ela já não estiver presente no conjunto de cartas em jogo.
+ * @param nova_carta A carta que se deseja verificar e potencialmente substituir.
+ * @param cartas_em_jogo O conjunto das cartas já distribuídas ou em uso no jogo.
+ * @param gerador Um ponteiro para o gerador usado nos novos sorteios.
+ * @return Uma nova estrutura 'carta' que não é repetida.
+ */
+struct carta troca_repetida(struct carta nova_carta, uint64_t cartas_em_jogo, struct gerador *gerador);
+
+/**
+ * @brief Verifica se uma dada carta já existe no conjunto de cartas em jogo.
+ * @param nova_carta A carta a ser verificada.
+ * @param cartas_em_jogo O conjunto das cartas já distribuídas ou em uso no jogo.
+ * @return Verdadeiro se a carta for repetida, Falso caso contrário.
+ */
+bool eh_repetida(struct carta nova_carta, uint64_t cartas_em_jogo);
+
+/**
+ * @brief Compara duas estruturas 'carta' para verificar se são idênticas (mesmo número e naipe).
+ * @param primeira_carta A primeira estrutura 'carta' para comparação.
+ * @param segunda_carta A segunda estrutura 'carta' para comparação.
+ * @return Verdadeiro se as cartas forem iguais, Falso caso contrário.
+ */
+bool cartas_iguais(struct carta primeira_carta, struct carta segunda_carta);
+
+#ifdef INSTRUMENTACAO
+static const char *caminho_instrumentacao = NULL; // Arquivo de --profile.
+
+static void gravar_instrumentacao_ao_sair(void)
+{
+    gravar_instrumentacao(caminho_instrumentacao);
+}
+#endif
+
+/**
+ * @brief Função principal do programa.
+ *
+ * Sem argumentos, inicia uma partida interativa no terminal. Com "--simulate N",
+ * joga N partidas entre robôs sem nenhuma entrada ou saída durante o jogo.
+ */
+int main(int argc, char *argv[])
+{
+    int numero_jogadores = 4;
+    long long qtd_simulacoes = 0;
+    long long qtd_resolver = 0;
+    uint64_t semente = (uint64_t)time(NULL);
+    int qtd_threads = qtd_processadores();
+    const char *arquivo_equidade = ARQUIVO_EQUIDADE;
+    const char *gerar_equidade = NULL;
+    const char *arquivo_apostas = ARQUIVO_APOSTAS;
+    const char *gerar_apostas = NULL;
+    const char *robo_time_1 = NULL;
+    const char *arquivo_cfr = ARQUIVO_CFR;
+    const char *treino_cfr = NULL;
+    long long qtd_iteracoes_cfr = 10000000;
+    double segundos_checkpoint = 60;
+    const char *arquivo_instrumentacao = NULL;
+    bool apostas_carregadas;
+    decisao_jogador decisao_time_1 = escolher_acao_aleatoria;
+    bool executar_benchmarks = false;
+    bool executar_autotestes = false;
+    const char *arquivo_json = NULL;
+    const char *arquivo_log = NULL;
+    const char *arquivo_eventos = NULL;
+    const char *arquivos_analise[MAX_ARQUIVOS_ANALISE];
+    int qtd_arquivos_analise = 0;
+    struct arquivo_historico historico_arquivo;
+    struct historico historico;
+    const char *endereco_servidor = NULL;
+    const char *endereco_teste_carga = NULL;
+    double prazo_turno_ms = PRAZO_PADRAO_TURNO_MS;
+    int qtd_mesas_teste = 10000;
+    double segundos_teste = 10;
+    const char *faixa_exaustiva = NULL;
+    const char *robos_torneio = NULL;
+    long long partidas_por_confronto = 1000;
+    int rodadas_suicas = 0;
+    const char *arquivo_classificacao = NULL;
+    int qtd_jogadores_cada_time;
+
+    setlocale(LC_ALL, "Portuguese");
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--simulate") == 0 && i + 1 < argc)
+            qtd_simulacoes = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc)
+            numero_jogadores = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            semente = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            qtd_threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--equity") == 0 && i + 1 < argc)
+            arquivo_equidade = argv[++i];
+        else if (strcmp(argv[i], "--build-equity") == 0 && i + 1 < argc)
+            gerar_equidade = argv[++i];
+        else if (strcmp(argv[i], "--betting") == 0 && i + 1 < argc)
+            arquivo_apostas = argv[++i];
+        else if (strcmp(argv[i], "--build-betting") == 0 && i + 1 < argc)
+            gerar_apostas = argv[++i];
+        else if (strcmp(argv[i], "--cfr") == 0 && i + 1 < argc)
+            arquivo_cfr = argv[++i];
+        else if (strcmp(argv[i], "--train-cfr") == 0 && i + 1 < argc)
+            treino_cfr = argv[++i];
+        else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            qtd_iteracoes_cfr = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc)
+            segundos_checkpoint = atof(argv[++i]);
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+            arquivo_instrumentacao = argv[++i];
+        else if (strcmp(argv[i], "--bot") == 0 && i + 1 < argc)
+            robo_time_1 = argv[++i];
+        else if (strcmp(argv[i], "--solve") == 0 && i + 1 < argc)
+            qtd_resolver = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--mcts") == 0)
+            decisao_time_1 = escolher_acao_mcts;
+        else if (strcmp(argv[i], "--mcts-ms") == 0 && i + 1 < argc)
+            configuracao_mcts.segundos_por_decisao = atof(argv[++i]) / 1000.0;
+        else if (strcmp(argv[i], "--mcts-playouts") == 0 && i + 1 < argc)
+            configuracao_mcts.max_playouts = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--mcts-threads") == 0 && i + 1 < argc)
+            configuracao_mcts.threads_por_decisao = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--mcts-inference") == 0 && i + 1 < argc)
+            configuracao_mcts.peso_manilha_truco = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc)
+            endereco_servidor = argv[++i];
+        else if (strcmp(argv[i], "--turn-timeout") == 0 && i + 1 < argc)
+            prazo_turno_ms = atof(argv[++i]);
+        else if (strcmp(argv[i], "--load-test") == 0 && i + 1 < argc)
+            endereco_teste_carga = argv[++i];
+        else if (strcmp(argv[i], "--tables") == 0 && i + 1 < argc)
+            qtd_mesas_teste = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            segundos_teste = atof(argv[++i]);
+        else if (strcmp(argv[i], "--bench") == 0)
+            executar_benchmarks = true;
+        else if (strcmp(argv[i], "--self-test") == 0)
+            executar_autotestes = true;
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            arquivo_json = argv[++i];
+        else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc)
+            arquivo_log = argv[++i];
+        else if (strcmp(argv[i], "--events") == 0 && i + 1 < argc)
+            arquivo_eventos = argv[++i];
+        else if (strcmp(argv[i], "--analyze") == 0 && i + 1 < argc && qtd_arquivos_analise < MAX_ARQUIVOS_ANALISE)
+            arquivos_analise[qtd_arquivos_analise++] = argv[++i];
+        else if (strcmp(argv[i], "--exhaustive") == 0 && i + 1 < argc)
+            faixa_exaustiva = argv[++i];
+        else if (strcmp(argv[i], "--tournament") == 0 && i + 1 < argc)
+            robos_torneio = argv[++i];
+        else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc)
+            partidas_por_confronto = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--swiss") == 0 && i + 1 < argc)
+            rodadas_suicas = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--standings") == 0 && i + 1 < argc)
+            arquivo_classificacao = argv[++i];
+        else
+        {
+            printf("Uso: %s [--simulate N] [--players 2|4|6] [--seed S] [--threads T] [--equity ARQ] [--build-equity ARQ] [--betting ARQ] [--build-betting ARQ] [--cfr ARQ] [--solve N] [--bot ROBO] [--mcts] [--mcts-ms MS] [--mcts-playouts N] [--mcts-threads N] [--mcts-inference PESO] [--log ARQ] [--events ARQ] [--profile ARQ] [--bench [--json ARQ]]\n"
+                   "       %s --self-test\n"
+                   "       %s --analyze ARQ [--analyze ARQ ...] [--threads T]\n"
+                   "       %s --exhaustive INICIO:FIM [--players 2|4|6] [--threads T]\n"
+                   "       %s --train-cfr ARQ [--iterations N] [--checkpoint S] [--seed S] [--threads T]\n"
+                   "       %s --tournament ROBO,ROBO,...|todos [--games N] [--swiss R] [--standings ARQ] [--players 2|4|6] [--seed S] [--threads T]\n"
+                   "       %s --serve PORTA|SOCKET [--turn-timeout MS] [--seed S]\n"
+                   "       %s --load-test PORTA|SOCKET [--tables N] [--seconds S] [--players 2|4|6]\n", argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    if (qtd_threads < 1 || qtd_threads > MAX_THREADS)
+    {
+        printf("O número de threads deve estar entre 1 e %d.\n", MAX_THREADS);
+        return 1;
+    }
+
+    if (configuracao_mcts.segundos_por_decisao < 0 || configuracao_mcts.max_playouts < 0 ||
+        (configuracao_mcts.segundos_por_decisao == 0 && configuracao_mcts.max_playouts == 0))
+    {
+        printf("O robô MCTS precisa de um limite de tempo (--mcts-ms) ou de playouts (--mcts-playouts).\n");
+        return 1;
+    }
+
+    if (configuracao_mcts.threads_por_decisao < 1 || configuracao_mcts.threads_por_decisao > MAX_THREADS)
+    {
+        printf("O número de threads de cada decisão do robô MCTS deve estar entre 1 e %d.\n", MAX_THREADS);
+        return 1;
+    }
+
+    if (configuracao_mcts.peso_manilha_truco < 1 || configuracao_mcts.peso_manilha_truco > 100)
+    {
+        printf("O peso das manilhas de quem pediu truco (--mcts-inference) deve estar entre 1 e 100.\n");
+        return 1;
+    }
+
+    if (arquivo_instrumentacao != NULL)
+    {
+#ifdef INSTRUMENTACAO
+        // Grava ao sair, qualquer que seja o modo (simulação, torneio, servidor ou jogo interativo)
+        caminho_instrumentacao = arquivo_instrumentacao;
+        iniciar_instrumentacao();
+        atexit(gravar_instrumentacao_ao_sair);
+#else
+        printf("--profile precisa de um executável compilado com -DINSTRUMENTACAO.\n");
+        return 1;
+#endif
+    }
+
+    if (robo_time_1 != NULL)
+    {
+        const struct robo_registrado *robo = buscar_robo(robo_time_1);
+        if (robo == NULL)
+        {
+            printf("Robô desconhecido: %s. Robôs disponíveis:", robo_time_1);
+            for (size_t i = 0; i < sizeof(ROBOS_REGISTRADOS) / sizeof(ROBOS_REGISTRADOS[0]); i++)
+                printf(" %s", ROBOS_REGISTRADOS[i].nome);
+            printf("\n");
+            return 1;
+        }
+        decisao_time_1 = robo->decidir;
+    }
+
+    if (gerar_equidade != NULL)
+        return gerar_tabela_equidade(gerar_equidade, qtd_threads) ? 0 : 1;
+
+    if (gerar_apostas != NULL)
+        return gerar_tabela_apostas(gerar_apostas, MAOS_TABELA_APOSTAS, semente, qtd_threads) ? 0 : 1;
+
+    if (treino_cfr != NULL)
+    {
+        if (qtd_iteracoes_cfr < 1 || segundos_checkpoint <= 0)
+        {
+            printf("O treino precisa de ao menos uma iteração e de um intervalo de checkpoint positivo.\n");
+            return 1;
+        }
+        return treinar_cfr(treino_cfr, qtd_iteracoes_cfr, segundos_checkpoint, semente, qtd_threads) ? 0 : 1;
+    }
+
+    if (qtd_arquivos_analise > 0)
+        return analisar_historicos(arquivos_analise, qtd_arquivos_analise, qtd_threads) ? 0 : 1;
+
+    if (faixa_exaustiva != NULL)
+    {
+        char inicio_texto[48];
+        const char *separador = strchr(faixa_exaustiva, ':');
+        indice_distribuicao inicio, fim = qtd_distribuicoes(numero_jogadores / 2);
+        size_t tamanho = separador != NULL ? (size_t)(separador - faixa_exaustiva) : 0;
+
+        if (numero_jogadores != 2 && numero_jogadores != 4 && numero_jogadores != 6)
+        {
+            printf("O número de jogadores deve ser 2, 4 ou 6.\n");
+            return 1;
+        }
+        // "INICIO:FIM", com FIM vazio para ir até a última distribuição
+        snprintf(inicio_texto, sizeof(inicio_texto), "%.*s", (int)(tamanho < sizeof(inicio_texto) ? tamanho : sizeof(inicio_texto) - 1), faixa_exaustiva);
+        if (separador == NULL || !ler_indice_distribuicao(inicio_texto, &inicio) ||
+            (separador[1] != '\0' && !ler_indice_distribuicao(separador + 1, &fim)))
+        {
+            printf("A faixa deve ter a forma INICIO:FIM (por exemplo, 0:1000000), com FIM vazio para ir até o final.\n");
+            return 1;
+        }
+        return analisar_distribuicoes(inicio, fim, numero_jogadores, qtd_threads) ? 0 : 1;
+    }
+
+    // Também opcional; sem ela, o robô da tabela aposta como o guloso e o servidor usa o robô aleatório
+    apostas_carregadas = carregar_tabela_apostas(arquivo_apostas);
+    carregar_tabela_cfr(arquivo_cfr);
+
+    if (robos_torneio != NULL)
+    {
+        struct torneio *torneio = calloc(1, sizeof(*torneio));
+        bool sucesso;
+        if (torneio == NULL)
+            return 1;
+        if (numero_jogadores != 2 && numero_jogadores != 4 && numero_jogadores != 6)
+        {
+            printf("O número de jogadores deve ser 2, 4 ou 6.\n");
+            free(torneio);
+            return 1;
+        }
+        if (partidas_por_confronto < 1 || rodadas_suicas < 0)
+        {
+            printf("Cada confronto precisa de ao menos uma partida, e as rodadas suíças não podem ser negativas.\n");
+            free(torneio);
+            return 1;
+        }
+        if (!inscrever_robos(torneio, robos_torneio) || torneio->qtd_participantes < 2)
+        {
+            printf("O torneio precisa de ao menos dois robôs.\n");
+            free(torneio);
+            return 1;
+        }
+        torneio->numero_jogadores = numero_jogadores;
+        torneio->semente = semente;
+        torneio->partidas_por_confronto = partidas_por_confronto;
+        sucesso = executar_torneio(torneio, rodadas_suicas, qtd_threads, arquivo_classificacao);
+        free(torneio);
+        return sucesso ? 0 : 1;
+    }
+
+    if (endereco_servidor != NULL)
+    {
+        if (prazo_turno_ms <= 0)
+        {
+            printf("O prazo de cada jogada deve ser positivo.\n");
+            return 1;
+        }
+        return executar_servidor(endereco_servidor, prazo_turno_ms / 1000.0, semente, apostas_carregadas ? escolher_acao_tabela : escolher_acao_aleatoria);
+    }
+
+    if (endereco_teste_carga != NULL)
+    {
+        if ((numero_jogadores != 2 && numero_jogadores != 4 && numero_jogadores != 6) || qtd_mesas_teste < 1 || segundos_teste <= 0)
+        {
+            printf("O teste de carga precisa de 2, 4 ou 6 jogadores, ao menos uma mesa e duração positiva.\n");
+            return 1;
+        }
+        return executar_teste_carga(endereco_teste_carga, qtd_mesas_teste, numero_jogadores, segundos_teste, semente);
+    }
+
+    if (executar_autotestes)
+    {
+        bool ok = testar_numeracao_distribuicoes();
+        ok = testar_amostrador_maos() && ok;
+        printf(ok ? "Autotestes: todos passaram.\n" : "Autotestes: houve falhas.\n");
+        return ok ? 0 : 1;
+    }
+
+    if (executar_benchmarks)
+    {
+        struct relatorio_benchmark relatorio = {0};
+        executar_benchmark_distribuicao(&relatorio);
+        executar_benchmark_comparacao(&relatorio);
+        executar_benchmark_motor(&relatorio);
+        executar_benchmark_lote(&relatorio);
+        if (arquivo_json != NULL && !gravar_benchmark_json(&relatorio, arquivo_json))
+            return 1;
+        return 0;
+    }
+
+    // A tabela é opcional; sem ela, apenas não há consultas de equidade
+    carregar_tabela_equidade(arquivo_equidade);
+
+    if (arquivo_log != NULL && !abrir_arquivo_historico(&historico_arquivo, arquivo_log))
+        return 1;
+
+    if (qtd_simulacoes > 0 || qtd_resolver > 0)
+    {
+        if (numero_jogadores != 2 && numero_jogadores != 4 && numero_jogadores != 6)
+        {
+            printf("O número de jogadores deve ser 2, 4 ou 6.\n");
+            return 1;
+        }
+        if (qtd_resolver > 0)
+            analisar_maos_resolvidas(qtd_resolver, numero_jogadores, semente);
+        if (qtd_simulacoes > 0)
+        {
+            FILE *eventos = NULL;
+            if (arquivo_eventos != NULL && (eventos = fopen(arquivo_eventos, "w")) == NULL)
+            {
+                printf("Não foi possível abrir %s.\n", arquivo_eventos);
+                return 1;
+            }
+            simular_partidas(qtd_simulacoes, numero_jogadores, semente, qtd_threads, decisao_time_1, arquivo_log != NULL ? &historico_arquivo : NULL, eventos);
+            if (eventos != NULL)
+                fclose(eventos);
+        }
+        if (arquivo_log != NULL && !fechar_arquivo_historico(&historico_arquivo))
+            return 1;
+        return 0;
+    }
+
+    printf("Bem-vindo ao jogo de Truco!\n");
+    do
+    {
+        printf("Por favor, informe o número de jogadores (2, 4 ou 6): ");
+        scanf("%d", &numero_jogadores);
+
+        while (getchar() != '\n')
+            ;
+    } while (numero_jogadores != 2 && numero_jogadores != 4 && numero_jogadores != 6);
+
+    qtd_jogadores_cada_time = numero_jogadores / 2;
+
+    struct jogador time_1_jogadores[MAX_JOGADORES_TIME];
+    struct jogador time_2_jogadores[MAX_JOGADORES_TIME];
+
+    printf("\n--- Configurando o Time 1 ---\n");
+    adicionar_equipe(time_1_jogadores, qtd_jogadores_cada_time);
+
+    printf("\n--- Configurando o Time 2 ---\n");
+    adicionar_equipe(time_2_jogadores, qtd_jogadores_cada_time);
+
+    struct partida partida;
+    iniciar_partida(&partida, time_1_jogadores, time_2_jogadores, qtd_jogadores_cada_time, &saida_terminal, semente, 0);
+    if (arquivo_log != NULL)
+    {
+        iniciar_historico(&historico, &historico_arquivo);
+        partida.historico = &historico;
+    }
+    jogar_partida(&partida);
+    if (arquivo_log != NULL)
+    {
+        liberar_historico(&historico);
+        fechar_arquivo_historico(&historico_arquivo);
+    }
+
+    exibir_estatisticas_mcts(&estatisticas_mcts_thread);
+    liberar_arvore_mcts();
+
+    printf("\n--- Fim do jogo ---\n");
+
+    return 0;
+}
+
+/**
+ * @brief Passo do splitmix64, usado apenas para espalhar a semente pelo estado do xoshiro.
+ */
+static uint64_t misturar_semente(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotacionar(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+void semear_gerador(struct gerador *gerador, uint64_t semente, uint64_t indice)
+{
+    // Mistura o índice antes de combiná-lo, para que índices vizinhos gerem estados sem relação
+    uint64_t x = indice;
+    uint64_t estado = semente ^ misturar_semente(&x);
+    for (int i = 0; i < 4; i++)
+        gerador->s[i] = misturar_semente(&estado);
+}
+
+uint64_t proximo_aleatorio(struct gerador *gerador)
+{
+    uint64_t *s = gerador->s;
+    uint64_t resultado = rotacionar(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotacionar(s[3], 45);
+
+    return resultado;
+}
+
+void saltar_gerador(struct gerador *gerador)
+{
+    static const uint64_t SALTO[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t s[4] = {0, 0, 0, 0};
+
+    for (int i = 0; i < 4; i++)
+        for (int b = 0; b < 64; b++)
+        {
+            if (SALTO[i] & (1ULL << b))
+            {
+                for (int k = 0; k < 4; k++)
+                    s[k] ^= gerador->s[k];
+            }
+            proximo_aleatorio(gerador);
+        }
+
+    for (int k = 0; k < 4; k++)
+        gerador->s[k] = s[k];
+}
+
+uint32_t sortear_limitado(struct gerador *gerador, uint32_t limite)
+{
+    // Método de Lemire: multiplica em vez de dividir e só rejeita na faixa que causaria viés
+    uint64_t m = (uint64_t)(uint32_t)(proximo_aleatorio(gerador) >> 32) * limite;
+    uint32_t resto = (uint32_t)m;
+    if (resto < limite)
+    {
+        uint32_t limiar = -limite % limite;
+        while (resto < limiar)
+        {
+            m = (uint64_t)(uint32_t)(proximo_aleatorio(gerador) >> 32) * limite;
+            resto = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+int gerar_numero_aleatorio(struct gerador *gerador, int max)
+{
+    return (int)sortear_limitado(gerador, (uint32_t)max + 1);
+}
+
+void sorteio_numero_carta(struct carta *carta, struct gerador *gerador)
+{
+    *carta = criar_carta(gerar_numero_aleatorio(gerador, 9) + 1, naipe_carta(*carta));
+}
+
+void sorteio_naipe(struct carta *carta, struct gerador *gerador)
+{
+    *carta = criar_carta(numero_carta(*carta), gerar_numero_aleatorio(gerador, 3));
+}
+
+struct carta criar_carta_aleatoria(struct gerador *gerador)
+{
+    struct carta nova_carta = {0};
+    sorteio_numero_carta(&nova_carta, gerador);
+    sorteio_naipe(&nova_carta, gerador);
+    return nova_carta;
+}
+
+void adicionar_nome_jogador(struct jogador *jogador)
+{
+    char nome[TAMANHO_NOME] = "";
+    printf("Digite o nome do jogador: ");
+    if (fgets(nome, sizeof(nome), stdin) == NULL)
+        nome[0] = '\0';
+    nome[strcspn(nome, "\n")] = '\0';
+    jogador->nome = internar_nome(nome);
+}
+
+static char *nomes_internados[MAX_NOMES_INTERNADOS]; // Tabela hash com endereçamento aberto.
+static pthread_mutex_t trava_nomes = PTHREAD_MUTEX_INITIALIZER;
+
+const char *internar_nome(const char *nome)
+{
+    char cortado[TAMANHO_NOME];
+    uint64_t hash = 14695981039346656037ULL;
+    const char *internado = "?";
+
+    snprintf(cortado, sizeof(cortado), "%s", nome);
+    for (const char *c = cortado; *c != '\0'; c++)
+        hash = (hash ^ (uint8_t)*c) * 1099511628211ULL;
+
+    pthread_mutex_lock(&trava_nomes);
+    for (int i = 0; i < MAX_NOMES_INTERNADOS; i++)
+    {
+        char **entrada = &nomes_internados[(hash + (uint64_t)i) % MAX_NOMES_INTERNADOS];
+        if (*entrada == NULL)
+        {
+            size_t tamanho = strlen(cortado) + 1;
+            *entrada = malloc(tamanho);
+            if (*entrada != NULL)
+            {
+                memcpy(*entrada, cortado, tamanho);
+                internado = *entrada;
+            }
+            break;
+        }
+        if (strcmp(*entrada, cortado) == 0)
+        {
+            internado = *entrada;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&trava_nomes);
+    return internado;
+}
+
+void montar_baralho(struct baralho *baralho)
+{
+    for (int i = 0; i < QTD_CARTAS_BARALHO; i++)
+    {
+        baralho->cartas[i].indice = (uint8_t)i;
+    }
+    baralho->qtd_restantes = QTD_CARTAS_BARALHO;
+}
+
+struct carta comprar_carta(struct baralho *baralho, struct gerador *gerador)
+{
+    int ultima = baralho->qtd_restantes - 1;
+    int sorteada = gerar_numero_aleatorio(gerador, ultima);
+
+    struct carta carta = baralho->cartas[sorteada];
+    baralho->cartas[sorteada] = baralho->cartas[ultima];
+    baralho->cartas[ultima] = carta;
+    baralho->qtd_restantes--;
+    return carta;
+}
+
+void distribuir_cartas_jogador(uint64_t *cartas, struct baralho *baralho, struct gerador *gerador)
+{
+    *cartas = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        *cartas |= bit_carta(comprar_carta(baralho, gerador));
+    }
+}
+
+void distribuir_cartas_por_sorteio(uint64_t *cartas, uint64_t *cartas_em_jogo, struct gerador *gerador)
+{
+    *cartas = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        struct carta nova = criar_carta_aleatoria(gerador);
+        nova = troca_repetida(nova, *cartas_em_jogo, gerador);
+        *cartas |= bit_carta(nova);
+        *cartas_em_jogo |= bit_carta(nova);
+    }
+}
+
+void adicionar_equipe(struct jogador time[], int quantidade_jogadores)
+{
+    for (int i = 0; i < quantidade_jogadores; i++)
+    {
+        adicionar_nome_jogador(&time[i]);
+
+        char resposta = 'A';
+        printf("O jogador é humano ou robô? (H ou R): ");
+        scanf(" %c", &resposta);
+        while (resposta != 'H' && resposta != 'R' && resposta != 'h' && resposta != 'r')
+        {
+            printf("Valor indesejado, digite H ou R: ");
+            scanf(" %c", &resposta);
+        }
+        while (getchar() != '\n')
+            ;
+        time[i].decidir = (resposta == 'R' || resposta == 'r') ? escolher_acao_mcts : escolher_acao;
+    }
+}
+
+void exibir_carta(struct carta carta)
+{
+    printf("%c%c ", SIMBOLOS[numero_carta(carta)], NAIPES[naipe_carta(carta)]);
+}
+
+void exibir_mao(uint64_t mao)
+{
+    printf("Mão: ");
+    for (uint64_t resto = mao; resto != 0; resto &= resto - 1)
+    {
+        exibir_carta(primeira_carta(resto));
+    }
+    printf("\n");
+}
+
+void exibir_time(const struct jogador time[], int quantidade_jogadores)
+{
+    for (int i = 0; i < quantidade_jogadores; i++)
+    {
+        printf("--- Jogador: %s ---\n", time[i].nome);
+    }
+}
+
+void exibir_ganhador(const struct jogador time[], int quantidade_jogadores)
+{
+    printf("\n--- Ganhador do Jogo ---\n");
+    exibir_time(time, quantidade_jogadores);
+}
+
+void exibir_pontuacao_final(int pontuacao_time_1, int pontuacao_time_2)
+{
+    printf("\n------ Pontuação Global ------\n");
+    printf("Time 1: %d pontos\n", pontuacao_time_1);
+    printf("Time 2: %d pontos\n", pontuacao_time_2);
+    printf("------------------------\n\n");
+}
+
+void exibir_pontuacao_partida(int pontuacao_time_1, int pontuacao_time_2)
+{
+    printf("\n------ Pontuação da Partida ------\n");
+    printf("Time 1: %d pontos\n", pontuacao_time_1);
+    printf("Time 2: %d pontos\n", pontuacao_time_2);
+    printf("------------------------\n\n");
+}
+
+void finalizar_jogo(const struct jogador time_1[], const struct jogador time_2[], int pontuacao_time_1, int pontuacao_time_2, int qtd_jagadores_cada_time)
+{
+    if (pontuacao_time_1 > pontuacao_time_2)
+        exibir_ganhador(time_1, qtd_jagadores_cada_time);
+    else
+        exibir_ganhador(time_2, qtd_jagadores_cada_time);
+
+    exibir_pontuacao_final(pontuacao_time_1, pontuacao_time_2);
+}
+
+void emitir_terminal(struct saida_eventos *saida, const struct evento *evento)
+{
+    const struct partida *partida = evento->partida;
+    const struct estado_mao *mao = evento->mao;
+    (void)saida;
+
+    switch (evento->tipo)
+    {
+    case EVENTO_INICIO_PARTIDA:
+    case EVENTO_FIM_MAO:
+        break;
+    case EVENTO_INICIO_MAO:
+        printf("--------Geral--------");
+        exibir_pontuacao_final(partida->pontuacao_time_1, partida->pontuacao_time_2);
+        break;
+    case EVENTO_INICIO_VAZA:
+        printf("-------------- Inicio da rodada interna %d-------------\n", mao->rodadas_jogadas);
+        break;
+    case EVENTO_ACAO_INVALIDA:
+        printf("Ação inválida, tente novamente.\n");
+        break;
+    case EVENTO_ACAO:
+        switch (evento->acao.tipo)
+        {
+        case ACAO_JOGAR_CARTA:
+            printf("%s jogou: ", evento->autor->nome);
+            exibir_carta(evento->acao.carta);
+            printf("\n");
+            break;
+        case ACAO_PEDIR_TRUCO:
+            printf("Agora a rodada vale %d pontos!\n", mao->valor_partida);
+            break;
+        case ACAO_ACEITAR_TRUCO:
+            printf("%s aceitou o truco!\n", evento->autor->nome);
+            break;
+        case ACAO_RECUSAR_TRUCO:
+            printf("%s correu! A mão vale %d ponto(s) para o Time %d.\n", evento->autor->nome, mao->valor_partida, mao->time_vencedor);
+            break;
+        }
+        break;
+    case EVENTO_FIM_VAZA:
+        if (evento->vencedor == 0)
+        {
+            printf("\n\n--------------------------------------------\n");
+            printf("   Empate entre %s (%c%c) e %s (%c%c)\n",
+                   mao->jogadores[0][indice_na_posicao(mao, 1, mao->maior_posicao_1)].nome, SIMBOLOS[numero_carta(mao->carta_maior_1)], NAIPES[naipe_carta(mao->carta_maior_1)],
+                   mao->jogadores[1][indice_na_posicao(mao, 2, mao->maior_posicao_2)].nome, SIMBOLOS[numero_carta(mao->carta_maior_2)], NAIPES[naipe_carta(mao->carta_maior_2)]);
+            printf("--------------------------------------------\n");
+        }
+        else
+        {
+            // O vencedor passa a ser o primeiro do seu time
+            struct carta carta_vencedora = evento->vencedor == 1 ? mao->carta_maior_1 : mao->carta_maior_2;
+            printf("\n\n----------------------------------\n");
+            printf("   Vitória de %s (%c%c)\n",
+                   mao->jogadores[evento->vencedor - 1][indice_na_posicao(mao, evento->vencedor, 0)].nome,
+                   SIMBOLOS[numero_carta(carta_vencedora)], NAIPES[naipe_carta(carta_vencedora)]);
+            printf("----------------------------------\n");
+        }
+        exibir_pontuacao_final(mao->vitorias_time1, mao->vitorias_time2);
+        break;
+    case EVENTO_FIM_PARTIDA:
+        finalizar_jogo(partida->jogadores[0], partida->jogadores[1], partida->pontuacao_time_1, partida->pontuacao_time_2, partida->qtd_jogadores_cada_time);
+        break;
+    }
+}
+
+static void escrever_fluxo(struct saida_eventos *saida, const char *formato, ...)
+{
+    // Nenhuma linha passa de 64 bytes; o buffer cresce antes de formatar
+    if (saida->capacidade - saida->qtd < 64)
+    {
+        size_t capacidade = saida->capacidade == 0 ? LIMITE_BUFFER_EVENTOS + 4096 : 2 * saida->capacidade;
+        char *texto = realloc(saida->texto, capacidade);
+        if (texto == NULL)
+            return;
+        saida->texto = texto;
+        saida->capacidade = capacidade;
+    }
+
+    va_list argumentos;
+    va_start(argumentos, formato);
+    int escritos = vsnprintf(saida->texto + saida->qtd, saida->capacidade - saida->qtd, formato, argumentos);
+    va_end(argumentos);
+    if (escritos > 0)
+        saida->qtd += (size_t)escritos;
+}
+
+static void descarregar_saida_fluxo(struct saida_eventos *saida)
+{
+    if (saida->qtd == 0)
+        return;
+    if (saida->trava != NULL)
+        pthread_mutex_lock(saida->trava);
+    fwrite(saida->texto, 1, saida->qtd, saida->arquivo);
+    if (saida->trava != NULL)
+        pthread_mutex_unlock(saida->trava);
+    saida->qtd = 0;
+}
+
+void emitir_fluxo(struct saida_eventos *saida, const struct evento *evento)
+{
+    const struct partida *partida = evento->partida;
+    const struct estado_mao *mao = evento->mao;
+
+    switch (evento->tipo)
+    {
+    case EVENTO_INICIO_VAZA:
+    case EVENTO_ACAO_INVALIDA:
+        break;
+    case EVENTO_INICIO_PARTIDA:
+        escrever_fluxo(saida, "PARTIDA %llu %d\n", (unsigned long long)partida->indice, 2 * partida->qtd_jogadores_cada_time);
+        break;
+    case EVENTO_INICIO_MAO:
+        escrever_fluxo(saida, "MAO %c%c %d\n", SIMBOLOS[numero_carta(mao->vira)], NAIPES[naipe_carta(mao->vira)], mao->time_que_iniciou);
+        break;
+    case EVENTO_ACAO:
+        switch (evento->acao.tipo)
+        {
+        case ACAO_JOGAR_CARTA:
+            escrever_fluxo(saida, "JOGOU %d %d %c%c\n", evento->time, evento->assento,
+                           SIMBOLOS[numero_carta(evento->acao.carta)], NAIPES[naipe_carta(evento->acao.carta)]);
+            break;
+        case ACAO_PEDIR_TRUCO:
+            escrever_fluxo(saida, "TRUCO %d %d\n", evento->time, mao->valor_partida);
+            break;
+        case ACAO_ACEITAR_TRUCO:
+            escrever_fluxo(saida, "ACEITOU %d %d\n", evento->time, mao->valor_partida);
+            break;
+        case ACAO_RECUSAR_TRUCO:
+            escrever_fluxo(saida, "CORREU %d %d\n", evento->time, mao->valor_partida);
+            break;
+        }
+        break;
+    case EVENTO_FIM_VAZA:
+        escrever_fluxo(saida, "VAZA %d\n", evento->vencedor);
+        break;
+    case EVENTO_FIM_MAO:
+        escrever_fluxo(saida, "FIM_MAO %d %d %d %d\n", evento->vencedor, mao->valor_partida, partida->pontuacao_time_1, partida->pontuacao_time_2);
+        break;
+    case EVENTO_FIM_PARTIDA:
+        escrever_fluxo(saida, "FIM %d %d %d\n", evento->vencedor, partida->pontuacao_time_1, partida->pontuacao_time_2);
+        // Só grava entre partidas, para que as linhas de uma partida fiquem contíguas no arquivo
+        if (saida->qtd >= LIMITE_BUFFER_EVENTOS)
+            descarregar_saida_fluxo(saida);
+        break;
+    }
+}
+
+void iniciar_saida_fluxo(struct saida_eventos *saida, FILE *arquivo, pthread_mutex_t *trava)
+{
+    saida->emitir = emitir_fluxo;
+    saida->arquivo = arquivo;
+    saida->trava = trava;
+    saida->texto = NULL;
+    saida->qtd = 0;
+    saida->capacidade = 0;
+}
+
+void liberar_saida_fluxo(struct saida_eventos *saida)
+{
+    descarregar_saida_fluxo(saida);
+    free(saida->texto);
+    saida->texto = NULL;
+    saida->capacidade = 0;
+}
+
+/**
+ * @brief Gira os dois times para que o jogador do vencedor na 'posicao' abra a próxima vaza.
+ *
+ * O jogador seguinte na mesa é o do outro time na mesma posição, ou na posição seguinte se o
+ * outro time abria a vaza que acabou. Só os deslocamentos mudam; nenhum jogador é copiado.
+ */
+ESPECIALIZADA void avancar_inicio(struct estado_mao *mao, int vencedor, int posicao, const int qtd)
+{
+    int giro_perdedor = mao->time_ganhador == vencedor ? posicao : posicao + 1;
+    mao->inicio[vencedor - 1] = (mao->inicio[vencedor - 1] + posicao) % qtd;
+    mao->inicio[2 - vencedor] = (mao->inicio[2 - vencedor] + giro_perdedor) % qtd;
+}
+
+ESPECIALIZADA enum resultado_acao rodada_truco_fixa(struct estado_mao *mao, const int qtd)
+{
+    // Determina o vencedor da rodada
+    int resultado = mao->forca_maior_1 - mao->forca_maior_2;
+
+    if (resultado == 0)
+    {
+        // Empate
+        if (mao->rodadas_jogadas == 1)
+        {
+            mao->pontos_valendo = 2; // Empate na primeira rodada vale 2 pontos
+        }
+        else
+        {
+            mao->vitorias_time1++;
+            mao->vitorias_time2++;
+        }
+        mao->resultado_vaza = 0;
+    }
+    else if (resultado > 0)
+    {
+        // Time 1 ganhou
+        mao->vitorias_time1 += mao->pontos_valendo;
+
+        // Troca a ordem para que o vencedor comece a próxima rodada
+        avancar_inicio(mao, 1, mao->maior_posicao_1, qtd);
+        mao->time_ganhador = 1;
+        mao->resultado_vaza = 1;
+    }
+    else
+    {
+        // Time 2 ganhou
+        mao->vitorias_time2 += mao->pontos_valendo;
+
+        // Troca a ordem para que o vencedor comece a próxima rodada
+        avancar_inicio(mao, 2, mao->maior_posicao_2, qtd);
+        mao->time_ganhador = 2;
+        mao->resultado_vaza = 2;
+    }
+
+    if (mao->rodadas_jogadas == 1)
+        mao->fez_primeira = mao->resultado_vaza;
+    mao->rodadas_jogadas++;
+    mao->jogadas_na_rodada = 0;
+
+    // Com duas vitórias para cada lado, a mão fica com quem fez a primeira
+    // (ou com quem começou a mão, se a primeira também empatou).
+    if (mao->vitorias_time1 >= 2 && mao->vitorias_time2 >= 2)
+        mao->time_vencedor = mao->fez_primeira != 0 ? mao->fez_primeira : mao->time_que_iniciou;
+    else if (mao->vitorias_time1 >= 2)
+        mao->time_vencedor = 1;
+    else if (mao->vitorias_time2 >= 2)
+        mao->time_vencedor = 2;
+
+    return mao->time_vencedor != 0 ? ACAO_FIM_MAO : ACAO_FIM_VAZA;
+}
+
+enum resultado_acao rodada_truco(struct estado_mao *mao)
+{
+    return rodada_truco_fixa(mao, mao->qtd_jogadores_cada_time);
+}
+
+void pedir_carta_jogar(uint64_t cartas)
+{
+    printf("Qual carta deseja jogar?: \n");
+    int i = 1;
+    for (uint64_t resto = cartas; resto != 0; resto &= resto - 1)
+    {
+        struct carta carta = primeira_carta(resto);
+        printf("Para carta %c%c digite - %d\n", SIMBOLOS[numero_carta(carta)], NAIPES[naipe_carta(carta)], i++);
+    }
+}
+
+void retirar_carta_jogada(uint64_t *cartas, struct carta carta_jogada)
+{
+    *cartas &= ~bit_carta(carta_jogada);
+}
+
+struct carta jogar_carta(uint64_t cartas)
+{
+    int posicao_carta;
+    do
+    {
+        pedir_carta_jogar(cartas); // Exibe as opções
+        scanf("%d", &posicao_carta);
+        if (posicao_carta < 1 || posicao_carta > qtd_cartas(cartas))
+        {
+            printf("Valor inválido, digite novamente se atentando a ele.\n");
+            // Limpa o buffer de entrada
+            while (getchar() != '\n')
+                ;
+        }
+    } while (posicao_carta < 1 || posicao_carta > qtd_cartas(cartas));
+
+    return carta_na_posicao(cartas, posicao_carta - 1); // Ajusta para índice baseado em 0
+}
+
+struct carta carta_na_posicao(uint64_t conjunto, int posicao)
+{
+    // Descarta as 'posicao' menores cartas e fica com a seguinte
+    for (int i = 0; i < posicao; i++)
+        conjunto &= conjunto - 1;
+    return primeira_carta(conjunto);
+}
+
+struct carta sortear_carta(uint64_t conjunto, struct gerador *gerador)
+{
+    return carta_na_posicao(conjunto, (int)sortear_limitado(gerador, (uint32_t)qtd_cartas(conjunto)));
+}
+
+void pedir_truco(int *qtd_pontos_valendo)
+{
+    printf("Quanto deseja pedir: 3, 6, 9 ou 12?\n");
+    scanf("%d", qtd_pontos_valendo);
+    while (*qtd_pontos_valendo != 3 && *qtd_pontos_valendo != 6 && *qtd_pontos_valendo != 9 && *qtd_pontos_valendo != 12)
+    {
+        printf("Você inseriu um valor inválido, os valores válidos são 3, 6, 9 ou 12\n");
+        scanf("%d", qtd_pontos_valendo);
+    }
+}
+
+void aceitar_truco(bool *aceitou_truco, const struct jogador *jogador_que_responde)
+{
+    printf("\n\n--------------------------------------\n");
+    printf("----------Vez de %s----------\n", jogador_que_responde->nome);
+    printf("Deseja aceitar o truco? (S ou N):\n");
+    char resposta = 'A';
+    scanf(" %c", &resposta);
+    while (resposta != 'S' && resposta != 'N' && resposta != 's' && resposta != 'n')
+    {
+        printf("Valor indesejado, digite novamente!!\n");
+        printf("Deseja aceitar o truco? (S ou N):\n");
+        scanf("%c", &resposta);
+    }
+    *aceitou_truco = (resposta == 'S' || resposta == 's');
+}
+
+void aumentar_truco(int *valor_partida)
+{
+    if (*valor_partida == 12)
+        printf("Não é possível pedir pontuação maior que 12\n");
+    else
+        *valor_partida += 3;
+}
+
+struct acao escolher_acao(const struct estado_mao *mao, const struct jogador *jogador)
+{
+    struct acao acao = {ACAO_JOGAR_CARTA, {0}, 0};
+    int opcao = 0;
+
+    if (mao->truco_pendente)
+    {
+        bool aceitou_truco = false;
+        aceitar_truco(&aceitou_truco, jogador);
+        acao.tipo = aceitou_truco ? ACAO_ACEITAR_TRUCO : ACAO_RECUSAR_TRUCO;
+        return acao;
+    }
+
+    while (opcao != 2 && opcao != 3)
+    {
+        printf("\n\n--------------------------------------\n");
+        printf("      Vira da rodada: %c%c\n", SIMBOLOS[numero_carta(mao->vira)], NAIPES[naipe_carta(mao->vira)]);
+        printf("--------------------------------------\n");
+        printf("----------Vez de %s----------\n", jogador->nome);
+        printf("O que você deseja fazer:\n 1:Exibir suas cartas\n 2:Jogar alguma carta\n ");
+        if (mao->aceitou_truco)
+            printf("3:Aumentar valor do truco\n");
+        else
+            printf("3:Pedir truco\n");
+        scanf("%d", &opcao);
+        switch (opcao)
+        {
+        case 1:
+        {
+            uint64_t cartas = cartas_do_assento(mao, assento_da_vez(mao));
+            exibir_mao(cartas);
+            // A tabela é de mãos contra um único adversário; com mais jogadores ela não vale
+            double equidade = mao->qtd_jogadores_cada_time == 1 && qtd_cartas(cartas) == 3 ? equidade_mao(cartas, mao->vira) : -1;
+            if (equidade >= 0)
+                printf("Chance de vencer a mão (contra uma mão qualquer): %.1f%%\n", 100.0 * equidade);
+            break;
+        }
+        case 2:
+        {
+            acao.tipo = ACAO_JOGAR_CARTA;
+            acao.carta = jogar_carta(cartas_do_assento(mao, assento_da_vez(mao)));
+            break;
+        }
+        case 3:
+        {
+            if (!pode_pedir_truco(mao, time_do_assento(mao, assento_da_vez(mao))))
+            {
+                printf("Seu time não pode pedir truco agora.\n");
+                opcao = 0;
+                break;
+            }
+            int valor = mao->valor_partida;
+            if (!mao->aceitou_truco)
+                pedir_truco(&valor);
+            else
+                aumentar_truco(&valor);
+            acao.tipo = ACAO_PEDIR_TRUCO;
+            acao.valor = valor;
+            break;
+        }
+        default:
+            printf("Opção inválida!!!");
+        }
+    }
+    return acao;
+}
+
+struct acao escolher_acao_aleatoria(const struct estado_mao *mao, const struct jogador *jogador)
+{
+    struct acao acao = {ACAO_JOGAR_CARTA, {0}, 0};
+
+    if (mao->truco_pendente)
+    {
+        acao.tipo = gerar_numero_aleatorio(mao->gerador, 1) ? ACAO_ACEITAR_TRUCO : ACAO_RECUSAR_TRUCO;
+        return acao;
+    }
+
+    // Pede truco em cerca de uma a cada oito jogadas em que isso é permitido
+    if (pode_pedir_truco(mao, time_do_assento(mao, assento_da_vez(mao))) && gerar_numero_aleatorio(mao->gerador, 7) == 0)
+    {
+        acao.tipo = ACAO_PEDIR_TRUCO;
+        acao.valor = mao->valor_partida == 1 ? 3 : mao->valor_partida + 3;
+        return acao;
+    }
+
+    (void)jogador;
+    acao.carta = sortear_carta(cartas_do_assento(mao, assento_da_vez(mao)), mao->gerador);
+    return acao;
+}
+
+/**
+ * @brief Decisão comum dos robôs guloso e cauteloso, que só diferem no truco.
+ * @param minimo_pedir Pontos de mão a partir dos quais pede truco (acima de 6 para nunca pedir).
+ * @param minimo_aceitar Pontos de mão a partir dos quais aceita um pedido.
+ */
+static struct acao decidir_pela_forca(const struct estado_mao *mao, int minimo_pedir, int minimo_aceitar)
+{
+    struct acao acao = {ACAO_JOGAR_CARTA, {0}, 0};
+    int assento = assento_da_vez(mao);
+    int time = time_do_assento(mao, assento);
+    uint64_t cartas = cartas_do_assento(mao, assento);
+    int pontos = 0;
+
+    // Cada manilha vale 2 pontos de mão, cada 2 ou 3 vale 1 e estar ganhando a mão vale mais 1
+    for (uint64_t resto = cartas; resto != 0; resto &= resto - 1)
+    {
+        uint8_t forca = mao->forcas[primeira_carta(resto).indice];
+        pontos += forca >= 11 ? 2 : forca >= 9 ? 1 : 0;
+    }
+    if ((time == 1 ? mao->vitorias_time1 - mao->vitorias_time2 : mao->vitorias_time2 - mao->vitorias_time1) > 0)
+        pontos++;
+
+    if (mao->truco_pendente)
+    {
+        acao.tipo = pontos >= minimo_aceitar ? ACAO_ACEITAR_TRUCO : ACAO_RECUSAR_TRUCO;
+        return acao;
+    }
+    if (pontos >= minimo_pedir && pode_pedir_truco(mao, time))
+    {
+        acao.tipo = ACAO_PEDIR_TRUCO;
+        acao.valor = mao->valor_partida == 1 ? 3 : mao->valor_partida + 3;
+        return acao;
+    }
+
+    // Os times se alternam nos assentos: a partir do assento 1 algum adversário já jogou, e a partir do 2 algum parceiro
+    uint8_t forca_deles = 0, forca_nossa = 0;
+    if (assento >= 1)
+        forca_deles = time == 1 ? mao->forca_maior_2 : mao->forca_maior_1;
+    if (assento >= 2)
+        forca_nossa = time == 1 ? mao->forca_maior_1 : mao->forca_maior_2;
+
+    struct carta mais_fraca = primeira_carta(cartas), mais_forte = mais_fraca, menor_que_vence = mais_fraca;
+    bool alguma_vence = false;
+    for (uint64_t resto = cartas; resto != 0; resto &= resto - 1)
+    {
+        struct carta carta = primeira_carta(resto);
+        uint8_t forca = mao->forcas[carta.indice];
+        if (forca < mao->forcas[mais_fraca.indice])
+            mais_fraca = carta;
+        if (forca > mao->forcas[mais_forte.indice])
+            mais_forte = carta;
+        if (forca > forca_deles && (!alguma_vence || forca < mao->forcas[menor_que_vence.indice]))
+        {
+            menor_que_vence = carta;
+            alguma_vence = true;
+        }
+    }
+
+    if (assento == 0)
+        acao.carta = mais_forte;
+    else if (forca_nossa > forca_deles || !alguma_vence)
+        acao.carta = mais_fraca;
+    else
+        acao.carta = menor_que_vence;
+    return acao;
+}
+
+struct acao escolher_acao_gulosa(const struct estado_mao *mao, const struct jogador *jogador)
+{
+    (void)jogador;
+    return decidir_pela_forca(mao, 3, 2);
+}
+
+struct acao escolher_acao_cautelosa(const struct estado_mao *mao, const struct jogador *jogador)
+{
+    (void)jogador;
+    return decidir_pela_forca(mao, 7, 3);
+}
+
+int gerar_acoes_legais(const struct estado_mao *mao, struct acao acoes[])
+{
+    int qtd = 0;
+
+    if (mao->truco_pendente)
+    {
+        acoes[qtd++] = (struct acao){ACAO_ACEITAR_TRUCO, {0}, 0};
+        acoes[qtd++] = (struct acao){ACAO_RECUSAR_TRUCO, {0}, 0};
+        return qtd;
+    }
+
+    int assento = assento_da_vez(mao);
+    for (uint64_t resto = cartas_do_assento(mao, assento); resto != 0; resto &= resto - 1)
+        acoes[qtd++] = (struct acao){ACAO_JOGAR_CARTA, primeira_carta(resto), 0};
+
+    if (pode_pedir_truco(mao, time_do_assento(mao, assento)))
+        acoes[qtd++] = (struct acao){ACAO_PEDIR_TRUCO, {0}, mao->valor_partida == 1 ? 3 : mao->valor_partida + 3};
+    return qtd;
+}
+
+void extrair_estado_jogo(const struct estado_mao *mao, struct estado_jogo *jogo)
+{
+    memset(jogo, 0, sizeof(*jogo));
+    for (int i = 0; i < mao->qtd_jogadores_cada_time; i++)
+    {
+        jogo->maos[0][i] = mao->maos[0][indice_na_posicao(mao, 1, i)];
+        jogo->maos[1][i] = mao->maos[1][indice_na_posicao(mao, 2, i)];
+    }
+    jogo->cartas_jogadas = mao->cartas_jogadas;
+    jogo->qtd_jogadores_cada_time = (uint8_t)mao->qtd_jogadores_cada_time;
+    jogo->vira = mao->vira.indice;
+    jogo->valor_partida = (uint8_t)mao->valor_partida;
+    jogo->valor_anterior = (uint8_t)mao->valor_anterior;
+    jogo->aceitou_truco = mao->aceitou_truco;
+    jogo->truco_pendente = mao->truco_pendente;
+    jogo->time_que_pediu_truco = (int8_t)mao->time_que_pediu_truco;
+    jogo->time_que_iniciou = (uint8_t)mao->time_que_iniciou;
+    jogo->time_ganhador = (uint8_t)mao->time_ganhador;
+    jogo->pontos_valendo = (uint8_t)mao->pontos_valendo;
+    jogo->vitorias_time1 = (uint8_t)mao->vitorias_time1;
+    jogo->vitorias_time2 = (uint8_t)mao->vitorias_time2;
+    jogo->fez_primeira = (uint8_t)mao->fez_primeira;
+    jogo->rodadas_jogadas = (uint8_t)mao->rodadas_jogadas;
+    jogo->jogadas_na_rodada = (uint8_t)mao->jogadas_na_rodada;
+    jogo->forca_maior_1 = mao->forca_maior_1;
+    jogo->forca_maior_2 = mao->forca_maior_2;
+    jogo->maior_posicao_1 = (uint8_t)mao->maior_posicao_1;
+    jogo->maior_posicao_2 = (uint8_t)mao->maior_posicao_2;
+    jogo->resultado_vaza = (uint8_t)mao->resultado_vaza;
+    jogo->time_vencedor = (uint8_t)mao->time_vencedor;
+}
+
+int gerar_jogadas(const struct estado_jogo *jogo, struct acao acoes[])
+{
+    int qtd = 0;
+
+    if (jogo->truco_pendente)
+    {
+        acoes[qtd++] = (struct acao){ACAO_ACEITAR_TRUCO, {0}, 0};
+        acoes[qtd++] = (struct acao){ACAO_RECUSAR_TRUCO, {0}, 0};
+        return qtd;
+    }
+
+    int assento = assento_da_vez_jogo(jogo);
+    int time = time_do_assento_jogo(jogo, assento);
+    for (uint64_t resto = jogo->maos[time - 1][assento / 2]; resto != 0; resto &= resto - 1)
+        acoes[qtd++] = (struct acao){ACAO_JOGAR_CARTA, primeira_carta(resto), 0};
+
+    if (jogo->valor_partida < 12 && jogo->time_que_pediu_truco != time)
+        acoes[qtd++] = (struct acao){ACAO_PEDIR_TRUCO, {0}, jogo->valor_partida == 1 ? 3 : jogo->valor_partida + 3};
+    return qtd;
+}
+
+/**
+ * @brief Gira as mãos de um time em 'deslocamento' posições, como 'avancar_inicio' gira os times da mão.
+ */
+static inline void girar_time_jogo(uint64_t maos[], int deslocamento, int qtd)
+{
+    uint64_t copia[MAX_JOGADORES_TIME];
+    for (int i = 0; i < qtd; i++)
+        copia[i] = maos[i];
+    for (int i = 0; i < qtd; i++)
+        maos[i] = copia[(i + deslocamento) % qtd];
+}
+
+/**
+ * @brief Fim de vaza no estado compacto, com as mesmas regras e a mesma rotação de 'rodada_truco'.
+ */
+static enum resultado_acao encerrar_vaza_jogo(struct estado_jogo *jogo, struct memoria_jogada *memoria)
+{
+    int qtd = jogo->qtd_jogadores_cada_time;
+    int vencedor = jogo->forca_maior_1 > jogo->forca_maior_2 ? 1 : jogo->forca_maior_1 < jogo->forca_maior_2 ? 2 : 0;
+
+    if (vencedor == 0)
+    {
+        if (jogo->rodadas_jogadas == 1)
+            jogo->pontos_valendo = 2;
+        else
+        {
+            jogo->vitorias_time1++;
+            jogo->vitorias_time2++;
+        }
+    }
+    else
+    {
+        // O vencedor passa a abrir a vaza; se o outro time abria a anterior, ele gira uma posição a mais
+        int posicao = vencedor == 1 ? jogo->maior_posicao_1 : jogo->maior_posicao_2;
+        int giro_vencedor = posicao;
+        int giro_perdedor = jogo->time_ganhador == vencedor ? posicao : (posicao + 1) % qtd;
+        int rotacao[2];
+
+        rotacao[vencedor - 1] = giro_vencedor;
+        rotacao[2 - vencedor] = giro_perdedor;
+        girar_time_jogo(jogo->maos[0], rotacao[0], qtd);
+        girar_time_jogo(jogo->maos[1], rotacao[1], qtd);
+        if (memoria != NULL)
+        {
+            memoria->rotacao[0] = (uint8_t)rotacao[0];
+            memoria->rotacao[1] = (uint8_t)rotacao[1];
+        }
+
+        if (vencedor == 1)
+            jogo->vitorias_time1 += jogo->pontos_valendo;
+        else
+            jogo->vitorias_time2 += jogo->pontos_valendo;
+        jogo->time_ganhador = (uint8_t)vencedor;
+    }
+    jogo->resultado_vaza = (uint8_t)vencedor;
+
+    if (jogo->rodadas_jogadas == 1)
+        jogo->fez_primeira = jogo->resultado_vaza;
+    jogo->rodadas_jogadas++;
+    jogo->jogadas_na_rodada = 0;
+
+    if (jogo->vitorias_time1 >= 2 && jogo->vitorias_time2 >= 2)
+        jogo->time_vencedor = jogo->fez_primeira != 0 ? jogo->fez_primeira : jogo->time_que_iniciou;
+    else if (jogo->vitorias_time1 >= 2)
+        jogo->time_vencedor = 1;
+    else if (jogo->vitorias_time2 >= 2)
+        jogo->time_vencedor = 2;
+
+    return jogo->time_vencedor != 0 ? ACAO_FIM_MAO : ACAO_FIM_VAZA;
+}
+
+enum resultado_acao fazer_jogada(struct estado_jogo *jogo, struct acao acao, struct memoria_jogada *memoria)
+{
+    int assento = assento_da_vez_jogo(jogo);
+    int time = time_do_assento_jogo(jogo, assento);
+
+    if (jogo->time_vencedor != 0)
+        return ACAO_INVALIDA;
+
+    switch (acao.tipo)
+    {
+    case ACAO_PEDIR_TRUCO:
+        if (jogo->truco_pendente || jogo->valor_partida >= 12 || jogo->time_que_pediu_truco == time ||
+            acao.valor <= jogo->valor_partida || acao.valor > 12 || acao.valor % 3 != 0)
+            return ACAO_INVALIDA;
+        break;
+    case ACAO_ACEITAR_TRUCO:
+    case ACAO_RECUSAR_TRUCO:
+        if (!jogo->truco_pendente)
+            return ACAO_INVALIDA;
+        break;
+    case ACAO_JOGAR_CARTA:
+        if (jogo->truco_pendente || (jogo->maos[time - 1][assento / 2] & bit_carta(acao.carta)) == 0)
+            return ACAO_INVALIDA;
+        break;
+    }
+
+    if (memoria != NULL)
+    {
+        memcpy(memoria->escalares, &jogo->valor_partida, sizeof(memoria->escalares));
+        memoria->carta = QTD_CARTAS_BARALHO;
+        memoria->rotacao[0] = memoria->rotacao[1] = 0;
+    }
+
+    switch (acao.tipo)
+    {
+    case ACAO_PEDIR_TRUCO:
+        jogo->valor_anterior = jogo->valor_partida;
+        jogo->valor_partida = (uint8_t)acao.valor;
+        jogo->time_que_pediu_truco = (int8_t)time;
+        jogo->aceitou_truco = false;
+        jogo->truco_pendente = true;
+        return ACAO_CONTINUA;
+
+    case ACAO_ACEITAR_TRUCO:
+        jogo->aceitou_truco = true;
+        jogo->truco_pendente = false;
+        return ACAO_CONTINUA;
+
+    case ACAO_RECUSAR_TRUCO:
+        jogo->truco_pendente = false;
+        jogo->valor_partida = jogo->valor_anterior;
+        jogo->time_vencedor = (uint8_t)jogo->time_que_pediu_truco;
+        return ACAO_FIM_MAO;
+
+    case ACAO_JOGAR_CARTA:
+    {
+        uint8_t forca = FORCAS[jogo->vira / 4][acao.carta.indice];
+        jogo->maos[time - 1][assento / 2] &= ~bit_carta(acao.carta);
+        jogo->cartas_jogadas |= bit_carta(acao.carta);
+        if (memoria != NULL)
+        {
+            memoria->carta = acao.carta.indice;
+            memoria->time = (uint8_t)time;
+            memoria->posicao = (uint8_t)(assento / 2);
+        }
+
+        // O primeiro de cada time sempre marca a maior carta
+        if (time == 1 && (assento < 2 || forca > jogo->forca_maior_1))
+        {
+            jogo->forca_maior_1 = forca;
+            jogo->maior_posicao_1 = (uint8_t)(assento / 2);
+        }
+        else if (time == 2 && (assento < 2 || forca > jogo->forca_maior_2))
+        {
+            jogo->forca_maior_2 = forca;
+            jogo->maior_posicao_2 = (uint8_t)(assento / 2);
+        }
+
+        jogo->jogadas_na_rodada++;
+        if (jogo->jogadas_na_rodada < 2 * jogo->qtd_jogadores_cada_time)
+            return ACAO_CONTINUA;
+        return encerrar_vaza_jogo(jogo, memoria);
+    }
+    }
+    return ACAO_INVALIDA;
+}
+
+void desfazer_jogada(struct estado_jogo *jogo, const struct memoria_jogada *memoria)
+{
+    int qtd = jogo->qtd_jogadores_cada_time;
+
+    if (memoria->carta < QTD_CARTAS_BARALHO)
+    {
+        // Desfaz a rotação do fim da vaza antes de devolver a carta à posição de quem a jogou
+        if (memoria->rotacao[0] != 0)
+            girar_time_jogo(jogo->maos[0], qtd - memoria->rotacao[0], qtd);
+        if (memoria->rotacao[1] != 0)
+            girar_time_jogo(jogo->maos[1], qtd - memoria->rotacao[1], qtd);
+        jogo->maos[memoria->time - 1][memoria->posicao] |= 1ULL << memoria->carta;
+        jogo->cartas_jogadas &= ~(1ULL << memoria->carta);
+    }
+    memcpy(&jogo->valor_partida, memoria->escalares, sizeof(memoria->escalares));
+}
+
+struct acao escolher_jogada_aleatoria(const struct estado_jogo *jogo, struct gerador *gerador)
+{
+    struct acao acao = {ACAO_JOGAR_CARTA, {0}, 0};
+
+    if (jogo->truco_pendente)
+    {
+        acao.tipo = gerar_numero_aleatorio(gerador, 1) ? ACAO_ACEITAR_TRUCO : ACAO_RECUSAR_TRUCO;
+        return acao;
+    }
+
+    int assento = assento_da_vez_jogo(jogo);
+    int time = time_do_assento_jogo(jogo, assento);
+    if (jogo->valor_partida < 12 && jogo->time_que_pediu_truco != time && gerar_numero_aleatorio(gerador, 7) == 0)
+    {
+        acao.tipo = ACAO_PEDIR_TRUCO;
+        acao.valor = jogo->valor_partida == 1 ? 3 : jogo->valor_partida + 3;
+        return acao;
+    }
+
+    acao.carta = sortear_carta(jogo->maos[time - 1][assento / 2], gerador);
+    return acao;
+}
+
+void preparar_amostrador(struct amostrador_maos *amostrador, const struct estado_jogo *jogo, int assento, int peso_manilha)
+{
+    amostrador->time_observador = time_do_assento_jogo(jogo, assento);
+    amostrador->posicao_observador = assento / 2;
+    uint64_t nao_vistas = BARALHO_COMPLETO & ~(jogo->maos[amostrador->time_observador - 1][amostrador->posicao_observador] |
+                                              jogo->cartas_jogadas | 1ULL << jogo->vira);
+    amostrador->qtd_manilhas = 0;
+    amostrador->qtd_comuns = 0;
+    for (; nao_vistas != 0; nao_vistas &= nao_vistas - 1)
+    {
+        uint8_t c = (uint8_t)__builtin_ctzll(nao_vistas);
+        if (FORCAS[jogo->vira / 4][c] > 10)
+            amostrador->manilhas[amostrador->qtd_manilhas++] = c;
+        else
+            amostrador->comuns[amostrador->qtd_comuns++] = c;
+    }
+
+    amostrador->peso_manilha = peso_manilha;
+    // Só o pedido dos adversários é informação nova; NINGUEM_PEDIU_TRUCO também cai fora
+    int pediu = jogo->time_que_pediu_truco;
+    amostrador->time_favorecido = peso_manilha > 1 && (pediu == 1 || pediu == 2) && pediu != amostrador->time_observador ? pediu : 0;
+}
+
+// Troca a carta 'i' com a 'ultima' do vetor e devolve a carta, que passa a ficar fora da parte em uso
+static inline uint8_t retirar_carta(uint8_t *cartas, int i, int ultima)
+{
+    uint8_t carta = cartas[i];
+    cartas[i] = cartas[ultima];
+    cartas[ultima] = carta;
+    return carta;
+}
+
+void amostrar_maos(struct amostrador_maos *amostrador, struct estado_jogo *jogo, struct gerador *gerador)
+{
+    // Cada sorteio encolhe só as contagens locais; as cartas retiradas ficam no fim dos vetores
+    int manilhas = amostrador->qtd_manilhas;
+    int comuns = amostrador->qtd_comuns;
+    int primeiro = amostrador->time_favorecido == 2 ? 1 : 0;
+
+    // O time favorecido sorteia primeiro, enquanto há mais manilhas para puxar
+    for (int k = 0; k < 2; k++)
+    {
+        int t = k ^ primeiro;
+        uint32_t peso = t + 1 == amostrador->time_favorecido ? (uint32_t)amostrador->peso_manilha : 1;
+        for (int i = 0; i < jogo->qtd_jogadores_cada_time; i++)
+        {
+            if (t == amostrador->time_observador - 1 && i == amostrador->posicao_observador)
+                continue;
+            uint64_t mao = 0;
+            for (int n = qtd_cartas(jogo->maos[t][i]); n > 0; n--)
+            {
+                uint32_t peso_manilhas = (uint32_t)manilhas * peso;
+                uint32_t sorteio = sortear_limitado(gerador, peso_manilhas + (uint32_t)comuns);
+                uint8_t carta;
+                if (sorteio < peso_manilhas)
+                    carta = retirar_carta(amostrador->manilhas, (int)(sorteio / peso), --manilhas);
+                else
+                    carta = retirar_carta(amostrador->comuns, (int)(sorteio - peso_manilhas), --comuns);
+                mao |= 1ULL << carta;
+            }
+            jogo->maos[t][i] = mao;
+        }
+    }
+}
+
+bool testar_amostrador_maos(void)
+{
+    const int amostras = 200000;
+    struct estado_jogo jogo;
+    struct amostrador_maos amostrador;
+    struct gerador gerador;
+    bool ok = true;
+
+    // Vira 0 (as manilhas são as cartas 4 a 7); quem amostra é o assento 0, da Equipe 1, sem manilhas
+    memset(&jogo, 0, sizeof(jogo));
+    jogo.qtd_jogadores_cada_time = 2;
+    jogo.vira = 0;
+    jogo.time_ganhador = 1;
+    jogo.time_que_iniciou = 1;
+    jogo.maos[0][0] = 1ULL << 20 | 1ULL << 24 | 1ULL << 28;
+    jogo.maos[0][1] = 1ULL << 4 | 1ULL << 9 | 1ULL << 13;
+    jogo.maos[1][0] = 1ULL << 5 | 1ULL << 10 | 1ULL << 14;
+    jogo.maos[1][1] = 1ULL << 6 | 1ULL << 11 | 1ULL << 15;
+    uint64_t nao_vistas = BARALHO_COMPLETO & ~(jogo.maos[0][0] | 1ULL);
+    double esperado = 3.0 * 4 / qtd_cartas(nao_vistas); // Manilhas por mão oculta, sem inferência
+
+    // Sem inferência, com pedido do próprio time e com pedido dos adversários
+    const int casos[3][2] = {{NINGUEM_PEDIU_TRUCO, 1}, {1, 8}, {2, 8}};
+    for (int caso = 0; caso < 3; caso++)
+    {
+        static long long frequencias[2][2][QTD_CARTAS_BARALHO];
+        long long manilhas[2][2] = {{0}};
+        bool validas = true;
+        memset(frequencias, 0, sizeof(frequencias));
+        jogo.time_que_pediu_truco = (int8_t)casos[caso][0];
+        semear_gerador(&gerador, 25, (uint64_t)caso);
+        preparar_amostrador(&amostrador, &jogo, 0, casos[caso][1]);
+
+        for (int n = 0; n < amostras; n++)
+        {
+            struct estado_jogo amostra = jogo;
+            amostrar_maos(&amostrador, &amostra, &gerador);
+            uint64_t usadas = amostra.maos[0][0];
+            if (amostra.maos[0][0] != jogo.maos[0][0])
+                validas = false;
+            for (int t = 0; t < 2; t++)
+                for (int i = 0; i < 2; i++)
+                {
+                    if (t == 0 && i == 0)
+                        continue;
+                    uint64_t mao = amostra.maos[t][i];
+                    if (qtd_cartas(mao) != 3 || (mao & ~nao_vistas) != 0 || (mao & usadas) != 0)
+                        validas = false;
+                    usadas |= mao;
+                    manilhas[t][i] += qtd_cartas(mao & 0xF0ULL);
+                    for (uint64_t resto = mao; resto != 0; resto &= resto - 1)
+                        frequencias[t][i][__builtin_ctzll(resto)]++;
+                }
+        }
+        if (!validas)
+        {
+            printf("Amostrador de mãos: uma amostra repetiu cartas, usou cartas vistas ou mudou a quantidade de uma mão.\n");
+            return false;
+        }
+
+        double parceiro = (double)manilhas[0][1] / amostras;
+        double adversarios = (double)(manilhas[1][0] + manilhas[1][1]) / (2.0 * amostras);
+        if (caso == 0)
+        {
+            // Cada carta não vista cai em cada mão oculta com a mesma chance
+            double chance = 3.0 / qtd_cartas(nao_vistas);
+            for (int t = 0; t < 2; t++)
+                for (int i = 0; i < 2; i++)
+                    for (int c = 0; c < QTD_CARTAS_BARALHO; c++)
+                        if (!(t == 0 && i == 0) && (nao_vistas >> c & 1) && fabs((double)frequencias[t][i][c] / amostras - chance) > 0.005)
+                        {
+                            printf("Amostrador de mãos: sem inferência, a carta %d cai na mão %d/%d com frequência %.4f (esperado %.4f).\n",
+                                   c, t + 1, i, (double)frequencias[t][i][c] / amostras, chance);
+                            ok = false;
+                        }
+        }
+        else if (caso == 1 && (fabs(parceiro - esperado) > 0.01 || fabs(adversarios - esperado) > 0.01))
+        {
+            printf("Amostrador de mãos: o pedido do próprio time mudou as manilhas (parceiro %.3f, adversários %.3f, esperado %.3f).\n",
+                   parceiro, adversarios, esperado);
+            ok = false;
+        }
+        else if (caso == 2 && (adversarios < esperado + 0.2 || parceiro >= esperado))
+        {
+            printf("Amostrador de mãos: o pedido dos adversários não os favoreceu (adversários %.3f, parceiro %.3f, sem inferência %.3f).\n",
+                   adversarios, parceiro, esperado);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static _Thread_local struct busca_mcts *busca_mcts_thread = NULL; // Arena e ajudantes reaproveitadas entre as decisões da thread.
+
+// Numa árvore só desta thread, os contadores são atualizados sem instruções atômicas de leitura e escrita
+static inline void somar_contador(atomic_int *contador, int valor, bool compartilhada)
+{
+    if (compartilhada)
+        atomic_fetch_add_explicit(contador, valor, memory_order_relaxed);
+    else
+        atomic_store_explicit(contador, atomic_load_explicit(contador, memory_order_relaxed) + valor, memory_order_relaxed);
+}
+
+static inline void somar_contador_longo(atomic_llong *contador, long long valor, bool compartilhada)
+{
+    if (compartilhada)
+        atomic_fetch_add_explicit(contador, valor, memory_order_relaxed);
+    else
+        atomic_store_explicit(contador, atomic_load_explicit(contador, memory_order_relaxed) + valor, memory_order_relaxed);
+}
+
+static bool acoes_iguais(struct acao a, struct acao b)
+{
+    return a.tipo == b.tipo && (a.tipo != ACAO_JOGAR_CARTA || cartas_iguais(a.carta, b.carta));
+}
+
+static int buscar_filho(const struct arvore_mcts *arvore, int primeiro, struct acao acao)
+{
+    for (int filho = primeiro; filho >= 0; filho = arvore->nos[filho].proximo_irmao)
+        if (acoes_iguais(arvore->nos[filho].acao, acao))
+            return filho;
+    return -1;
+}
+
+// A thread que desce por um nó conta uma visita perdida, desfeita na retropropagação
+static void aplicar_perda_virtual(struct arvore_mcts *arvore, int no)
+{
+    somar_contador(&arvore->nos[no].visitas, PERDA_VIRTUAL_MCTS, arvore->compartilhada);
+    somar_contador_longo(&arvore->nos[no].soma, -PERDA_VIRTUAL_MCTS * PONTOS_PARA_VENCER, arvore->compartilhada);
+}
+
+static void iniciar_raiz(struct arvore_mcts *arvore)
+{
+    struct no_mcts *raiz = &arvore->nos[0];
+    atomic_store_explicit(&arvore->qtd_nos, 1, memory_order_relaxed);
+    atomic_store_explicit(&raiz->primeiro_filho, -1, memory_order_relaxed);
+    raiz->proximo_irmao = -1;
+    atomic_store_explicit(&raiz->visitas, 0, memory_order_relaxed);
+    atomic_store_explicit(&raiz->disponibilidade, 0, memory_order_relaxed);
+    atomic_store_explicit(&raiz->soma, 0, memory_order_relaxed);
+}
+
+/**
+ * @brief Expande a ação sob o nó 'pai', já com uma disponibilidade e a perda virtual de quem a escolheu.
+ * @return O nó da ação (o de outra thread, se ela o publicou antes), ou -1 se a arena encheu.
+ */
+static int criar_filho(struct arvore_mcts *arvore, int pai, struct acao acao, int time)
+{
+    int no;
+    if (arvore->compartilhada)
+        no = atomic_fetch_add_explicit(&arvore->qtd_nos, 1, memory_order_relaxed);
+    else
+    {
+        no = atomic_load_explicit(&arvore->qtd_nos, memory_order_relaxed);
+        atomic_store_explicit(&arvore->qtd_nos, no + 1, memory_order_relaxed);
+    }
+    if (no >= MAX_NOS_MCTS)
+        return -1;
+
+    struct no_mcts *novo = &arvore->nos[no];
+    novo->acao = acao;
+    novo->time = time;
+    atomic_store_explicit(&novo->primeiro_filho, -1, memory_order_relaxed);
+    atomic_store_explicit(&novo->visitas, PERDA_VIRTUAL_MCTS, memory_order_relaxed);
+    atomic_store_explicit(&novo->disponibilidade, 1, memory_order_relaxed);
+    atomic_store_explicit(&novo->soma, -PERDA_VIRTUAL_MCTS * PONTOS_PARA_VENCER, memory_order_relaxed);
+
+    // Publica o nó na frente da lista de filhos; os campos acima ficam visíveis a quem ler a lista
+    atomic_int *primeiro_filho = &arvore->nos[pai].primeiro_filho;
+    int primeiro = atomic_load_explicit(primeiro_filho, memory_order_acquire);
+    do
+    {
+        int existente = buscar_filho(arvore, primeiro, acao);
+        if (existente >= 0)
+        {
+            // Outra thread expandiu a mesma ação: o nó reservado fica sem uso
+            somar_contador(&arvore->nos[existente].disponibilidade, 1, arvore->compartilhada);
+            aplicar_perda_virtual(arvore, existente);
+            return existente;
+        }
+        novo->proximo_irmao = primeiro;
+    } while (!atomic_compare_exchange_weak_explicit(primeiro_filho, &primeiro, no, memory_order_release, memory_order_acquire));
+    return no;
+}
+
+/**
+ * @brief Um playout do IS-MCTS: amostra, seleção com UCB, expansão, jogo aleatório até o fim e retropropagação.
+ */
+static void iterar_mcts(struct arvore_mcts *arvore, const struct estado_jogo *raiz, struct amostrador_maos *amostrador, struct gerador *gerador)
+{
+    const double exploracao = 0.7;
+    bool compartilhada = arvore->compartilhada;
+    struct estado_jogo estado = *raiz;
+    int caminho[MAX_PROFUNDIDADE_MCTS];
+    int profundidade = 0;
+    int no = 0;
+
+    amostrar_maos(amostrador, &estado, gerador);
+
+    while (estado.time_vencedor == 0 && profundidade < MAX_PROFUNDIDADE_MCTS)
+    {
+        struct acao acoes[MAX_ACOES_LEGAIS];
+        int filhos[MAX_ACOES_LEGAIS];
+        int nao_exploradas[MAX_ACOES_LEGAIS];
+        int qtd_nao_exploradas = 0;
+        int qtd_acoes = gerar_jogadas(&estado, acoes);
+        int primeiro = atomic_load_explicit(&arvore->nos[no].primeiro_filho, memory_order_acquire);
+
+        // Só as ações permitidas nesta amostra concorrem, e só elas ganham disponibilidade
+        for (int i = 0; i < qtd_acoes; i++)
+        {
+            filhos[i] = buscar_filho(arvore, primeiro, acoes[i]);
+            if (filhos[i] < 0)
+                nao_exploradas[qtd_nao_exploradas++] = i;
+            else
+                somar_contador(&arvore->nos[filhos[i]].disponibilidade, 1, compartilhada);
+        }
+
+        if (qtd_nao_exploradas > 0)
+        {
+            // Expande uma ação nova e passa ao jogo aleatório (se a arena encheu, só joga)
+            if (atomic_load_explicit(&arvore->qtd_nos, memory_order_relaxed) < MAX_NOS_MCTS)
+            {
+                int i = nao_exploradas[sortear_limitado(gerador, (uint32_t)qtd_nao_exploradas)];
+                int novo = criar_filho(arvore, no, acoes[i], time_do_assento_jogo(&estado, assento_da_vez_jogo(&estado)));
+                if (novo >= 0)
+                {
+                    fazer_jogada(&estado, acoes[i], NULL);
+                    caminho[profundidade++] = novo;
+                }
+            }
+            break;
+        }
+
+        // As visitas incluem as perdas virtuais das outras threads, então nunca são zero aqui
+        int escolhido = 0;
+        double melhor = -1e300;
+        for (int i = 0; i < qtd_acoes; i++)
+        {
+            const struct no_mcts *filho = &arvore->nos[filhos[i]];
+            double visitas = atomic_load_explicit(&filho->visitas, memory_order_relaxed);
+            double soma = (double)atomic_load_explicit(&filho->soma, memory_order_relaxed) / PONTOS_PARA_VENCER;
+            double disponibilidade = atomic_load_explicit(&filho->disponibilidade, memory_order_relaxed);
+            double ucb = soma / visitas + exploracao * sqrt(log(disponibilidade) / visitas);
+            if (ucb > melhor)
+            {
+                melhor = ucb;
+                escolhido = filhos[i];
+            }
+        }
+        aplicar_perda_virtual(arvore, escolhido);
+        fazer_jogada(&estado, arvore->nos[escolhido].acao, NULL);
+        caminho[profundidade++] = escolhido;
+        no = escolhido;
+    }
+
+    while (estado.time_vencedor == 0)
+        fazer_jogada(&estado, escolher_jogada_aleatoria(&estado, gerador), NULL);
+
+    // Cada nó recebe os pontos da mão do ponto de vista do time que escolheu a ação, no lugar da perda virtual
+    int recompensa = estado.valor_partida;
+    somar_contador(&arvore->nos[0].visitas, 1, compartilhada);
+    for (int i = 0; i < profundidade; i++)
+    {
+        struct no_mcts *atual = &arvore->nos[caminho[i]];
+        somar_contador(&atual->visitas, 1 - PERDA_VIRTUAL_MCTS, compartilhada);
+        somar_contador_longo(&atual->soma, (atual->time == estado.time_vencedor ? recompensa : -recompensa) + PERDA_VIRTUAL_MCTS * PONTOS_PARA_VENCER,
+                             compartilhada);
+    }
+}
+
+/**
+ * @brief Faz playouts na árvore da busca até esgotar o orçamento da decisão, dividido com as outras threads.
+ * @return Os playouts feitos por esta thread.
+ */
+static long long buscar_mcts(struct busca_mcts *busca, struct gerador *gerador)
+{
+    struct amostrador_maos amostrador = busca->amostrador;
+    long long playouts = 0;
+    for (;;)
+    {
+        // Consulta o relógio só a cada 16 playouts
+        if (configuracao_mcts.segundos_por_decisao > 0 && playouts % 16 == 0 && playouts > 0 &&
+            tempo_atual() - busca->inicio >= configuracao_mcts.segundos_por_decisao)
+            break;
+        if (configuracao_mcts.max_playouts > 0)
+        {
+            if (!busca->arvore.compartilhada)
+            {
+                if (playouts >= configuracao_mcts.max_playouts)
+                    break;
+            }
+            else if (atomic_fetch_add_explicit(&busca->reservados, 1, memory_order_relaxed) >= configuracao_mcts.max_playouts)
+                break;
+        }
+        iterar_mcts(&busca->arvore, &busca->raiz, &amostrador, gerador);
+        playouts++;
+    }
+    return playouts;
+}
+
+static void *rodar_ajudante_mcts(void *argumento)
+{
+    struct ajudante_mcts *ajudante = argumento;
+    struct busca_mcts *busca = ajudante->busca;
+
+    pthread_mutex_lock(&busca->trava);
+    for (;;)
+    {
+        while (busca->geracao == ajudante->geracao && !busca->encerrar)
+            pthread_cond_wait(&busca->comecar, &busca->trava);
+        if (busca->encerrar)
+            break;
+        ajudante->geracao = busca->geracao;
+        pthread_mutex_unlock(&busca->trava);
+
+        struct gerador gerador;
+        semear_gerador(&gerador, busca->semente, (uint64_t)ajudante->indice);
+        atomic_fetch_add_explicit(&busca->concluidos, buscar_mcts(busca, &gerador), memory_order_relaxed);
+
+        pthread_mutex_lock(&busca->trava);
+        if (--busca->ativas == 0)
+            pthread_cond_signal(&busca->terminar);
+    }
+    pthread_mutex_unlock(&busca->trava);
+    return NULL;
+}
+
+// Cria na primeira vez a arena da thread atual e as ajudantes que faltam; depois disso, decidir não aloca nada
+static struct busca_mcts *preparar_busca_mcts(int qtd_ajudantes)
+{
+    struct busca_mcts *busca = busca_mcts_thread;
+    if (busca == NULL)
+    {
+        busca = malloc(sizeof(*busca));
+        if (busca == NULL)
+            return NULL;
+        pthread_mutex_init(&busca->trava, NULL);
+        pthread_cond_init(&busca->comecar, NULL);
+        pthread_cond_init(&busca->terminar, NULL);
+        busca->geracao = 0;
+        busca->ativas = 0;
+        busca->encerrar = false;
+        busca->qtd_ajudantes = 0;
+        busca_mcts_thread = busca;
+    }
+
+    // As ajudantes novas esperam a próxima geração, como as antigas
+    while (busca->qtd_ajudantes < qtd_ajudantes)
+    {
+        struct ajudante_mcts *argumento = &busca->argumentos[busca->qtd_ajudantes];
+        argumento->busca = busca;
+        argumento->indice = busca->qtd_ajudantes + 1;
+        argumento->geracao = busca->geracao;
+        if (pthread_create(&busca->ajudantes[busca->qtd_ajudantes], NULL, rodar_ajudante_mcts, argumento) != 0)
+            break;
+        busca->qtd_ajudantes++;
+    }
+    return busca;
+}
+
+struct acao escolher_acao_mcts(const struct estado_mao *mao, const struct jogador *jogador)
+{
+    struct acao acoes[MAX_ACOES_LEGAIS];
+    int qtd_acoes = gerar_acoes_legais(mao, acoes);
+    long long playouts;
+
+    if (qtd_acoes == 1)
+        return acoes[0];
+
+    int qtd_threads = configuracao_mcts.threads_por_decisao;
+    struct busca_mcts *busca = preparar_busca_mcts(qtd_threads - 1);
+    if (busca == NULL)
+        return escolher_acao_aleatoria(mao, jogador);
+    if (qtd_threads > busca->qtd_ajudantes + 1)
+        qtd_threads = busca->qtd_ajudantes + 1;
+
+    struct arvore_mcts *arvore = &busca->arvore;
+    iniciar_raiz(arvore);
+    arvore->compartilhada = qtd_threads > 1;
+    extrair_estado_jogo(mao, &busca->raiz);
+    preparar_amostrador(&busca->amostrador, &busca->raiz, assento_da_vez(mao), configuracao_mcts.peso_manilha_truco);
+    busca->inicio = tempo_atual();
+
+    if (qtd_threads == 1)
+        playouts = buscar_mcts(busca, mao->gerador);
+    else
+    {
+        // As ajudantes sorteiam com geradores próprios, semeados a partir do gerador da mão
+        atomic_store_explicit(&busca->reservados, 0, memory_order_relaxed);
+        atomic_store_explicit(&busca->concluidos, 0, memory_order_relaxed);
+        busca->semente = proximo_aleatorio(mao->gerador);
+        pthread_mutex_lock(&busca->trava);
+        busca->ativas = qtd_threads - 1;
+        busca->geracao++;
+        pthread_cond_broadcast(&busca->comecar);
+        pthread_mutex_unlock(&busca->trava);
+
+        long long proprios = buscar_mcts(busca, mao->gerador);
+
+        pthread_mutex_lock(&busca->trava);
+        while (busca->ativas > 0)
+            pthread_cond_wait(&busca->terminar, &busca->trava);
+        pthread_mutex_unlock(&busca->trava);
+        playouts = proprios + atomic_load_explicit(&busca->concluidos, memory_order_relaxed);
+    }
+
+    // A ação do jogador da vez só depende do que ele vê, então toda ação da raiz é permitida
+    int escolhido = -1;
+    int mais_visitas = 0;
+    for (int filho = atomic_load_explicit(&arvore->nos[0].primeiro_filho, memory_order_acquire); filho >= 0; filho = arvore->nos[filho].proximo_irmao)
+    {
+        int visitas = atomic_load_explicit(&arvore->nos[filho].visitas, memory_order_relaxed);
+        if (escolhido < 0 || visitas > mais_visitas)
+        {
+            escolhido = filho;
+            mais_visitas = visitas;
+        }
+    }
+
+    estatisticas_mcts_thread.decisoes++;
+    estatisticas_mcts_thread.playouts += playouts;
+    // Em tempo de thread, para que a vazão exibida continue sendo a de cada thread da busca
+    estatisticas_mcts_thread.segundos += (tempo_atual() - busca->inicio) * qtd_threads;
+    return escolhido >= 0 ? arvore->nos[escolhido].acao : acoes[0];
+}
+
+void liberar_arvore_mcts(void)
+{
+    struct busca_mcts *busca = busca_mcts_thread;
+    if (busca == NULL)
+        return;
+
+    pthread_mutex_lock(&busca->trava);
+    busca->encerrar = true;
+    pthread_cond_broadcast(&busca->comecar);
+    pthread_mutex_unlock(&busca->trava);
+    for (int t = 0; t < busca->qtd_ajudantes; t++)
+        pthread_join(busca->ajudantes[t], NULL);
+
+    pthread_cond_destroy(&busca->terminar);
+    pthread_cond_destroy(&busca->comecar);
+    pthread_mutex_destroy(&busca->trava);
+    free(busca);
+    busca_mcts_thread = NULL;
+}
+
+void exibir_estatisticas_mcts(const struct estatisticas_mcts *estatisticas)
+{
+    if (estatisticas->decisoes == 0)
+        return;
+    printf("Robô MCTS: %lld decisões, %.0f playouts por decisão, %.0f playouts/s por thread\n",
+           estatisticas->decisoes, (double)estatisticas->playouts / (double)estatisticas->decisoes,
+           estatisticas->segundos > 0 ? (double)estatisticas->playouts / estatisticas->segundos : 0.0);
+}
+
+static uint64_t chaves_zobrist[2][MAX_JOGADORES_TIME][QTD_CARTAS_BARALHO]; // Chave de cada carta em cada posição de cada time.
+static uint64_t chaves_zobrist_vira[QTD_CARTAS_BARALHO];                    // Chave de cada vira.
+static pthread_once_t zobrist_iniciado = PTHREAD_ONCE_INIT;
+
+static void iniciar_chaves_zobrist(void)
+{
+    struct gerador gerador;
+    semear_gerador(&gerador, 0x7275636f, 0);
+    for (int t = 0; t < 2; t++)
+        for (int i = 0; i < MAX_JOGADORES_TIME; i++)
+            for (int c = 0; c < QTD_CARTAS_BARALHO; c++)
+                chaves_zobrist[t][i][c] = proximo_aleatorio(&gerador);
+    for (int c = 0; c < QTD_CARTAS_BARALHO; c++)
+        chaves_zobrist_vira[c] = proximo_aleatorio(&gerador);
+}
+
+/**
+ * @brief Chave Zobrist do estado: as cartas de cada posição, a vira e o placar e a vaza em andamento.
+ */
+static uint64_t chave_estado(const struct estado_jogo *mao)
+{
+    uint64_t chave = chaves_zobrist_vira[mao->vira];
+
+    // As cartas por posição também fixam a ordem dos jogadores, que muda a cada vaza
+    for (int i = 0; i < mao->qtd_jogadores_cada_time; i++)
+    {
+        for (uint64_t resto = mao->maos[0][i]; resto != 0; resto &= resto - 1)
+            chave ^= chaves_zobrist[0][i][primeira_carta(resto).indice];
+        for (uint64_t resto = mao->maos[1][i]; resto != 0; resto &= resto - 1)
+            chave ^= chaves_zobrist[1][i][primeira_carta(resto).indice];
+    }
+
+    // A maior carta de um time só conta depois que ele jogou na vaza atual
+    bool jogou_1 = mao->jogadas_na_rodada >= (mao->time_ganhador == 1 ? 1 : 2);
+    bool jogou_2 = mao->jogadas_na_rodada >= (mao->time_ganhador == 2 ? 1 : 2);
+    uint64_t escalares = (uint64_t)mao->vitorias_time1 | (uint64_t)mao->vitorias_time2 << 4 |
+                         (uint64_t)mao->pontos_valendo << 8 | (uint64_t)mao->fez_primeira << 12 |
+                         (uint64_t)mao->time_ganhador << 16 | (uint64_t)mao->time_que_iniciou << 20;
+    if (jogou_1)
+        escalares |= (uint64_t)mao->forca_maior_1 << 24 | (uint64_t)mao->maior_posicao_1 << 40;
+    if (jogou_2)
+        escalares |= (uint64_t)mao->forca_maior_2 << 32 | (uint64_t)mao->maior_posicao_2 << 44;
+    return chave ^ misturar_semente(&escalares);
+}
+
+void iniciar_resolvedor(struct resolvedor *resolvedor)
+{
+    pthread_once(&zobrist_iniciado, iniciar_chaves_zobrist);
+    memset(resolvedor->tabela, 0, sizeof(resolvedor->tabela));
+    resolvedor->nos = 0;
+}
+
+/**
+ * @brief Negamax com poda alfa-beta: +1 se o time da vez vence a mão, -1 se perde.
+ */
+static int resolver_estado(struct resolvedor *resolvedor, struct estado_jogo *mao, int alfa, int beta)
+{
+    int assento = assento_da_vez_jogo(mao);
+    int time = time_do_assento_jogo(mao, assento);
+    const uint8_t *forcas = FORCAS[mao->vira / 4];
+    uint64_t chave = chave_estado(mao);
+    struct entrada_transposicao *entrada = &resolvedor->tabela[chave & ((1 << BITS_TRANSPOSICAO) - 1)];
+    int alfa_original = alfa;
+    int melhor_indice = -1;
+
+    resolvedor->nos++;
+
+    if (entrada->tipo != TRANSPOSICAO_VAZIA && entrada->chave == chave)
+    {
+        if (entrada->tipo == TRANSPOSICAO_EXATA ||
+            (entrada->tipo == TRANSPOSICAO_INFERIOR && entrada->valor >= beta) ||
+            (entrada->tipo == TRANSPOSICAO_SUPERIOR && entrada->valor <= alfa))
+            return entrada->valor;
+        melhor_indice = entrada->melhor;
+    }
+
+    // Ordena as cartas: a melhor da tabela primeiro; quem abre a vaza tenta da mais forte para a
+    // mais fraca, quem já vence a vaza descarta a mais fraca e quem perde tenta a menor que ganha
+    int nossa = -1, deles = -1;
+    if (mao->jogadas_na_rodada >= (mao->time_ganhador == time ? 1 : 2))
+        nossa = time == 1 ? mao->forca_maior_1 : mao->forca_maior_2;
+    if (mao->jogadas_na_rodada >= (mao->time_ganhador == time ? 2 : 1))
+        deles = time == 1 ? mao->forca_maior_2 : mao->forca_maior_1;
+
+    struct carta cartas[MAX_JOGADORES_TIME];
+    int prioridades[MAX_JOGADORES_TIME];
+    int qtd = 0;
+    for (uint64_t resto = mao->maos[time - 1][assento / 2]; resto != 0; resto &= resto - 1)
+    {
+        struct carta carta = primeira_carta(resto);
+        int forca = forcas[carta.indice];
+        int prioridade;
+        if (carta.indice == melhor_indice)
+            prioridade = 100;
+        else if (deles < 0)
+            prioridade = forca;
+        else if (nossa > deles || forca <= deles)
+            prioridade = -forca;
+        else
+            prioridade = 50 - forca;
+
+        int j = qtd++;
+        while (j > 0 && prioridade > prioridades[j - 1])
+        {
+            cartas[j] = cartas[j - 1];
+            prioridades[j] = prioridades[j - 1];
+            j--;
+        }
+        cartas[j] = carta;
+        prioridades[j] = prioridade;
+    }
+
+    int melhor = -2;
+    for (int i = 0; i < qtd; i++)
+    {
+        struct memoria_jogada memoria;
+        struct acao acao = {ACAO_JOGAR_CARTA, cartas[i], 0};
+        int valor;
+
+        // Cada filho é visitado no próprio estado e desfeito em seguida, sem cópias
+        if (fazer_jogada(mao, acao, &memoria) == ACAO_FIM_MAO)
+            valor = mao->time_vencedor == time ? 1 : -1;
+        else if (time_do_assento_jogo(mao, assento_da_vez_jogo(mao)) == time)
+            valor = resolver_estado(resolvedor, mao, alfa, beta); // Quem venceu a vaza joga de novo
+        else
+            valor = -resolver_estado(resolvedor, mao, -beta, -alfa);
+        desfazer_jogada(mao, &memoria);
+
+        if (valor > melhor)
+        {
+            melhor = valor;
+            melhor_indice = cartas[i].indice;
+        }
+        if (melhor > alfa)
+            alfa = melhor;
+        if (alfa >= beta)
+            break;
+    }
+
+    entrada->chave = chave;
+    entrada->valor = (int8_t)melhor;
+    entrada->melhor = (uint8_t)melhor_indice;
+    if (melhor <= alfa_original)
+        entrada->tipo = TRANSPOSICAO_SUPERIOR;
+    else if (melhor >= beta)
+        entrada->tipo = TRANSPOSICAO_INFERIOR;
+    else
+        entrada->tipo = TRANSPOSICAO_EXATA;
+    return melhor;
+}
+
+int resolver_mao(struct resolvedor *resolvedor, const struct estado_mao *mao)
+{
+    struct estado_jogo estado;
+
+    if (mao->time_vencedor != 0)
+        return mao->time_vencedor;
+
+    extrair_estado_jogo(mao, &estado);
+    estado.truco_pendente = false;
+    int time = time_do_assento_jogo(&estado, assento_da_vez_jogo(&estado));
+    int valor = resolver_estado(resolvedor, &estado, -1, 1);
+    if (valor > 0)
+        return time;
+    return time == 1 ? 2 : 1;
+}
+
+void analisar_maos_resolvidas(long long qtd_maos, int numero_jogadores, uint64_t semente)
+{
+    int qtd_jogadores_cada_time = numero_jogadores / 2;
+    struct jogador time_1[MAX_JOGADORES_TIME];
+    struct jogador time_2[MAX_JOGADORES_TIME];
+    struct resolvedor *resolvedor = malloc(sizeof(*resolvedor));
+    struct partida partida;
+    struct estado_mao mao;
+    long long vitorias_quem_comeca = 0;
+    double segundos = 0;
+
+    if (resolvedor == NULL)
+    {
+        printf("Memória insuficiente para o resolvedor.\n");
+        return;
+    }
+
+    for (int i = 0; i < qtd_jogadores_cada_time; i++)
+    {
+        char nome[TAMANHO_NOME];
+        snprintf(nome, sizeof(nome), "Jogador %d", 2 * i + 1);
+        time_1[i].nome = internar_nome(nome);
+        snprintf(nome, sizeof(nome), "Jogador %d", 2 * i + 2);
+        time_2[i].nome = internar_nome(nome);
+        time_1[i].decidir = escolher_acao_aleatoria;
+        time_2[i].decidir = escolher_acao_aleatoria;
+    }
+
+    iniciar_resolvedor(resolvedor);
+    iniciar_partida(&partida, time_1, time_2, qtd_jogadores_cada_time, NULL, semente, 0);
+    for (long long n = 0; n < qtd_maos; n++)
+    {
+        iniciar_mao(&mao, &partida);
+        double inicio = tempo_atual();
+        vitorias_quem_comeca += resolver_mao(resolvedor, &mao) == mao.time_que_iniciou;
+        segundos += tempo_atual() - inicio;
+    }
+
+    printf("\n------ Mãos resolvidas (informação perfeita) ------\n");
+    printf("Mãos: %lld (%d jogadores, semente %llu)\n", qtd_maos, numero_jogadores, (unsigned long long)semente);
+    printf("Vence quem começa: %lld (%.2f%%)\n", vitorias_quem_comeca, 100.0 * (double)vitorias_quem_comeca / (double)qtd_maos);
+    printf("Estados por mão: %.1f\n", (double)resolvedor->nos / (double)qtd_maos);
+    printf("Tempo: %.3f s (%.2f us por mão)\n", segundos, segundos * 1e6 / (double)qtd_maos);
+    printf("---------------------------------------------------\n");
+    free(resolvedor);
+}
+
+int assento_da_vez(const struct estado_mao *mao)
+{
+    return assento_da_vez_fixa(mao, mao->qtd_jogadores_cada_time);
+}
+
+int time_do_assento(const struct estado_mao *mao, int assento)
+{
+    if (assento % 2 == 0)
+        return mao->time_ganhador;
+    return mao->time_ganhador == 1 ? 2 : 1;
+}
+
+const struct jogador *jogador_do_assento(const struct estado_mao *mao, int assento)
+{
+    int time = time_do_assento(mao, assento);
+    return &mao->jogadores[time - 1][indice_na_posicao(mao, time, assento / 2)];
+}
+
+uint64_t cartas_do_assento(const struct estado_mao *mao, int assento)
+{
+    int time = time_do_assento(mao, assento);
+    return mao->maos[time - 1][indice_na_posicao(mao, time, assento / 2)];
+}
+
+bool pode_pedir_truco(const struct estado_mao *mao, int time)
+{
+    return !mao->truco_pendente && mao->valor_partida < 12 && mao->time_que_pediu_truco != time;
+}
+
+ESPECIALIZADA void iniciar_mao_distribuida_fixa(struct estado_mao *mao, struct partida *partida, const struct distribuicao *distribuicao, const int qtd_jogadores_cada_time)
+{
+    // Os jogadores ficam no registro da partida; a mão só guarda o início de cada time
+    mao->jogadores = partida->jogadores;
+    mao->inicio[0] = partida->inicio[0];
+    mao->inicio[1] = partida->inicio[1];
+    mao->qtd_jogadores_cada_time = qtd_jogadores_cada_time;
+
+    mao->vira = distribuicao->vira;
+    for (int i = 0; i < qtd_jogadores_cada_time; i++)
+    {
+        mao->maos[0][indice_na_posicao_fixa(mao, 1, i, qtd_jogadores_cada_time)] = distribuicao->maos[0][i];
+        mao->maos[1][indice_na_posicao_fixa(mao, 2, i, qtd_jogadores_cada_time)] = distribuicao->maos[1][i];
+    }
+    mao->gerador = &partida->gerador_decisoes;
+    mao->forcas = forcas_da_vira(mao->vira);
+
+    mao->valor_partida = 1;
+    mao->valor_anterior = 1;
+    mao->aceitou_truco = false;
+    mao->truco_pendente = false;
+    mao->time_que_pediu_truco = NINGUEM_PEDIU_TRUCO;
+    mao->time_que_iniciou = partida->proximo_time;
+    mao->time_ganhador = partida->proximo_time;
+    mao->pontos_valendo = 1;
+    mao->cartas_jogadas = 0;
+    mao->vitorias_time1 = 0;
+    mao->vitorias_time2 = 0;
+    mao->fez_primeira = 0;
+    mao->rodadas_jogadas = 1;
+    mao->jogadas_na_rodada = 0;
+    mao->maior_posicao_1 = 0;
+    mao->maior_posicao_2 = 0;
+    mao->resultado_vaza = 0;
+    mao->time_vencedor = 0;
+    mao->placar[0] = partida->pontuacao_time_1;
+    mao->placar[1] = partida->pontuacao_time_2;
+}
+
+ESPECIALIZADA void iniciar_mao_fixa(struct estado_mao *mao, struct partida *partida, const int qtd)
+{
+    struct distribuicao distribuicao;
+
+    distribuicao.qtd_jogadores_cada_time = qtd;
+    embaralhar_fixa(distribuicao.maos[0], distribuicao.maos[1], &partida->baralho, &partida->gerador, &distribuicao.vira, qtd);
+    iniciar_mao_distribuida_fixa(mao, partida, &distribuicao, qtd);
+}
+
+void iniciar_mao(struct estado_mao *mao, struct partida *partida)
+{
+    iniciar_mao_fixa(mao, partida, partida->qtd_jogadores_cada_time);
+}
+
+void iniciar_mao_distribuida(struct estado_mao *mao, struct partida *partida, const struct distribuicao *distribuicao)
+{
+    iniciar_mao_distribuida_fixa(mao, partida, distribuicao, partida->qtd_jogadores_cada_time);
+}
+
+ESPECIALIZADA enum resultado_acao aplicar_acao_fixa(struct estado_mao *mao, struct acao acao, const int qtd)
+{
+    int assento = assento_da_vez_fixa(mao, qtd);
+    int time = time_do_assento(mao, assento);
+
+    if (mao->time_vencedor != 0)
+        return ACAO_INVALIDA;
+
+    switch (acao.tipo)
+    {
+    case ACAO_PEDIR_TRUCO:
+        if (!pode_pedir_truco(mao, time) || acao.valor <= mao->valor_partida || acao.valor > 12 || acao.valor % 3 != 0)
+            return ACAO_INVALIDA;
+        mao->valor_anterior = mao->valor_partida;
+        mao->valor_partida = acao.valor;
+        mao->time_que_pediu_truco = time;
+        mao->aceitou_truco = false;
+        mao->truco_pendente = true;
+        return ACAO_CONTINUA;
+
+    case ACAO_ACEITAR_TRUCO:
+        if (!mao->truco_pendente)
+            return ACAO_INVALIDA;
+        mao->aceitou_truco = true;
+        mao->truco_pendente = false;
+        return ACAO_CONTINUA;
+
+    case ACAO_RECUSAR_TRUCO:
+        if (!mao->truco_pendente)
+            return ACAO_INVALIDA;
+        // Quem corre entrega a mão pelo valor de antes do pedido
+        mao->truco_pendente = false;
+        mao->valor_partida = mao->valor_anterior;
+        mao->time_vencedor = mao->time_que_pediu_truco;
+        return ACAO_FIM_MAO;
+
+    case ACAO_JOGAR_CARTA:
+    {
+        if (mao->truco_pendente)
+            return ACAO_INVALIDA;
+
+        uint64_t *cartas = &mao->maos[time - 1][indice_na_posicao_fixa(mao, time, assento / 2, qtd)];
+        if ((*cartas & bit_carta(acao.carta)) == 0)
+            return ACAO_INVALIDA;
+
+        struct carta carta_jogada = acao.carta;
+        retirar_carta_jogada(cartas, carta_jogada);
+        mao->cartas_jogadas |= bit_carta(carta_jogada);
+
+        // Verifica a maior carta de cada time (o primeiro de cada time sempre marca)
+        uint8_t forca = mao->forcas[carta_jogada.indice];
+        CONTAR_FASE(FASE_COMPARACAO);
+        if (time == 1)
+        {
+            if (assento < 2 || forca > mao->forca_maior_1)
+            {
+                mao->carta_maior_1 = carta_jogada;
+                mao->forca_maior_1 = forca;
+                mao->maior_posicao_1 = assento / 2;
+            }
+        }
+        else
+        {
+            if (assento < 2 || forca > mao->forca_maior_2)
+            {
+                mao->carta_maior_2 = carta_jogada;
+                mao->forca_maior_2 = forca;
+                mao->maior_posicao_2 = assento / 2;
+            }
+        }
+
+        mao->jogadas_na_rodada++;
+        if (mao->jogadas_na_rodada < 2 * qtd)
+            return ACAO_CONTINUA;
+        INICIAR_MEDICAO(inicio_vaza);
+        enum resultado_acao resultado = rodada_truco_fixa(mao, qtd);
+        ENCERRAR_MEDICAO(FASE_VAZA, inicio_vaza);
+        return resultado;
+    }
+    }
+    return ACAO_INVALIDA;
+}
+
+enum resultado_acao aplicar_acao(struct estado_mao *mao, struct acao acao)
+{
+    switch (mao->qtd_jogadores_cada_time)
+    {
+    case 1:
+        return aplicar_acao_fixa(mao, acao, 1);
+    case 2:
+        return aplicar_acao_fixa(mao, acao, 2);
+    default:
+        return aplicar_acao_fixa(mao, acao, 3);
+    }
+}
+
+static uint16_t placar_historico(const struct partida *partida)
+{
+    return (uint16_t)(partida->pontuacao_time_1 | partida->pontuacao_time_2 << 8);
+}
+
+/**
+ * @brief Registra o início da mão: a vira e as cartas de cada jogador.
+ */
+static void registrar_inicio_mao(struct historico *historico, const struct estado_mao *mao)
+{
+    struct registro_historico inicio = {REGISTRO_MAO, (uint8_t)mao->time_que_iniciou, 0, mao->vira.indice, 0, 0, 0, 0};
+    registrar_historico(historico, inicio);
+    for (int i = 0; i < mao->qtd_jogadores_cada_time; i++)
+    {
+        struct registro_historico cartas_1 = {REGISTRO_CARTAS, 1, (uint8_t)i, 0, 0, 0, 0, mao->maos[0][indice_na_posicao(mao, 1, i)]};
+        struct registro_historico cartas_2 = {REGISTRO_CARTAS, 2, (uint8_t)i, 0, 0, 0, 0, mao->maos[1][indice_na_posicao(mao, 2, i)]};
+        registrar_historico(historico, cartas_1);
+        registrar_historico(historico, cartas_2);
+    }
+}
+
+/**
+ * @brief Registra uma ação já aplicada e, se ela fechou uma vaza, o resultado da vaza.
+ */
+static void registrar_acao_mao(struct historico *historico, const struct estado_mao *mao, int time, int assento, struct acao acao, enum resultado_acao resultado)
+{
+    struct registro_historico registro = {0, (uint8_t)time, (uint8_t)assento, 0, (uint8_t)mao->valor_partida, 0, 0, 0};
+
+    switch (acao.tipo)
+    {
+    case ACAO_JOGAR_CARTA:
+        registro.tipo = REGISTRO_JOGADA;
+        registro.carta = acao.carta.indice;
+        registro.valor = 0;
+        break;
+    case ACAO_PEDIR_TRUCO:
+        registro.tipo = REGISTRO_TRUCO;
+        break;
+    case ACAO_ACEITAR_TRUCO:
+        registro.tipo = REGISTRO_ACEITE;
+        break;
+    case ACAO_RECUSAR_TRUCO:
+        registro.tipo = REGISTRO_RECUSA;
+        break;
+    }
+    registrar_historico(historico, registro);
+
+    if (acao.tipo == ACAO_JOGAR_CARTA && resultado != ACAO_CONTINUA)
+    {
+        struct registro_historico vaza = {REGISTRO_VAZA, (uint8_t)mao->resultado_vaza, 0, 0, (uint8_t)(mao->rodadas_jogadas - 1), 0, 0, 0};
+        registrar_historico(historico, vaza);
+    }
+}
+
+static inline void emitir_evento(struct partida *partida, enum tipo_evento tipo, const struct estado_mao *mao, int vencedor)
+{
+    // Sem saída, nenhum evento é montado: o custo é um único teste
+    if (partida->eventos == NULL)
+        return;
+    struct evento evento = {tipo, partida, mao, NULL, {ACAO_JOGAR_CARTA, {0}, 0}, 0, 0, vencedor};
+    INICIAR_MEDICAO(inicio);
+    partida->eventos->emitir(partida->eventos, &evento);
+    ENCERRAR_MEDICAO(FASE_SAIDA, inicio);
+}
+
+ESPECIALIZADA int jogar_mao_fixa(struct partida *partida, const int qtd)
+{
+    struct estado_mao mao;
+    enum resultado_acao resultado = ACAO_CONTINUA;
+    int rodada_anunciada = 0;
+
+    iniciar_mao_fixa(&mao, partida, qtd);
+    if (partida->historico != NULL)
+        registrar_inicio_mao(partida->historico, &mao);
+    emitir_evento(partida, EVENTO_INICIO_MAO, &mao, 0);
+
+    while (resultado != ACAO_FIM_MAO)
+    {
+        int assento = assento_da_vez_fixa(&mao, qtd);
+        int time = time_do_assento(&mao, assento);
+        const struct jogador *jogador = &mao.jogadores[time - 1][indice_na_posicao_fixa(&mao, time, assento / 2, qtd)];
+
+        if (rodada_anunciada != mao.rodadas_jogadas)
+        {
+            rodada_anunciada = mao.rodadas_jogadas;
+            emitir_evento(partida, EVENTO_INICIO_VAZA, &mao, 0);
+        }
+
+        INICIAR_MEDICAO(inicio_decisao);
+        struct acao acao = jogador->decidir(&mao, jogador);
+        ENCERRAR_MEDICAO(FASE_DECISAO, inicio_decisao);
+
+        resultado = aplicar_acao_fixa(&mao, acao, qtd);
+        if (resultado == ACAO_INVALIDA)
+        {
+            emitir_evento(partida, EVENTO_ACAO_INVALIDA, &mao, 0);
+            continue;
+        }
+        if (partida->historico != NULL)
+            registrar_acao_mao(partida->historico, &mao, time, assento, acao, resultado);
+
+        // O jogador fica no registro da partida, então o ponteiro continua válido depois do fim da vaza
+        if (partida->eventos != NULL)
+        {
+            struct evento evento = {EVENTO_ACAO, partida, &mao, jogador, acao, time, assento, 0};
+            INICIAR_MEDICAO(inicio_saida);
+            partida->eventos->emitir(partida->eventos, &evento);
+            ENCERRAR_MEDICAO(FASE_SAIDA, inicio_saida);
+        }
+        if (acao.tipo == ACAO_JOGAR_CARTA && resultado != ACAO_CONTINUA)
+            emitir_evento(partida, EVENTO_FIM_VAZA, &mao, mao.resultado_vaza);
+    }
+
+    int vencedor = encerrar_mao_fixa(partida, &mao, qtd);
+    if (partida->historico != NULL)
+    {
+        struct registro_historico registro = {REGISTRO_FIM_MAO, (uint8_t)vencedor, 0, 0, (uint8_t)mao.valor_partida, 0, placar_historico(partida), 0};
+        registrar_historico(partida->historico, registro);
+    }
+    emitir_evento(partida, EVENTO_FIM_MAO, &mao, vencedor);
+    return vencedor;
+}
+
+int jogar_mao(struct partida *partida)
+{
+    switch (partida->qtd_jogadores_cada_time)
+    {
+    case 1:
+        return jogar_mao_fixa(partida, 1);
+    case 2:
+        return jogar_mao_fixa(partida, 2);
+    default:
+        return jogar_mao_fixa(partida, 3);
+    }
+}
+
+ESPECIALIZADA int encerrar_mao_fixa(struct partida *partida, const struct estado_mao *mao, const int qtd)
+{
+    if (mao->time_vencedor == 1)
+        partida->pontuacao_time_1 += mao->valor_partida;
+    else
+        partida->pontuacao_time_2 += mao->valor_partida;
+    partida->maos_jogadas++;
+
+    // Alterna o time que começa e gira os jogadores para a próxima mão
+    partida->rodada++;
+    if (partida->rodada % 2 == 0)
+    {
+        partida->proximo_time = 2;
+        partida->inicio[0] = (partida->inicio[0] + 1) % qtd;
+    }
+    else
+    {
+        partida->proximo_time = 1;
+        partida->inicio[1] = (partida->inicio[1] + 1) % qtd;
+    }
+
+    return mao->time_vencedor;
+}
+
+int encerrar_mao(struct partida *partida, const struct estado_mao *mao)
+{
+    return encerrar_mao_fixa(partida, mao, partida->qtd_jogadores_cada_time);
+}
+
+void iniciar_partida(struct partida *partida, struct jogador time_1[], struct jogador time_2[], int qtd_jogadores_cada_time, struct saida_eventos *eventos, uint64_t semente, uint64_t indice)
+{
+    // Registra os jogadores uma única vez; daqui em diante, girar é só mudar 'inicio'
+    for (int i = 0; i < qtd_jogadores_cada_time; i++)
+    {
+        partida->jogadores[0][i] = time_1[i];
+        partida->jogadores[1][i] = time_2[i];
+    }
+    partida->inicio[0] = 0;
+    partida->inicio[1] = 0;
+    partida->qtd_jogadores_cada_time = qtd_jogadores_cada_time;
+    partida->pontuacao_time_1 = 0;
+    partida->pontuacao_time_2 = 0;
+    partida->rodada = 1;
+    partida->proximo_time = 1;
+    partida->maos_jogadas = 0;
+    partida->eventos = eventos;
+    partida->semente = semente;
+    partida->indice = indice;
+    partida->historico = NULL;
+    montar_baralho(&partida->baralho);
+
+    // As decisões usam um fluxo separado, para que as cartas não dependam de quem está jogando
+    semear_gerador(&partida->gerador, semente, indice);
+    partida->gerador_decisoes = partida->gerador;
+    saltar_gerador(&partida->gerador_decisoes);
+}
+
+ESPECIALIZADA int jogar_partida_fixa(struct partida *partida, const int qtd)
+{
+    if (partida->historico != NULL)
+    {
+        struct registro_historico partida_iniciada = {REGISTRO_PARTIDA, 0, 0, 0, (uint8_t)(2 * partida->qtd_jogadores_cada_time), 0, 0, partida->indice};
+        struct registro_historico semente = {REGISTRO_SEMENTE, 0, 0, 0, 0, 0, 0, partida->semente};
+        registrar_historico(partida->historico, partida_iniciada);
+        registrar_historico(partida->historico, semente);
+    }
+    emitir_evento(partida, EVENTO_INICIO_PARTIDA, NULL, 0);
+
+    while (partida->pontuacao_time_1 < PONTOS_PARA_VENCER && partida->pontuacao_time_2 < PONTOS_PARA_VENCER)
+        jogar_mao_fixa(partida, qtd);
+
+    int vencedor = partida->pontuacao_time_1 >= PONTOS_PARA_VENCER ? 1 : 2;
+    if (partida->historico != NULL)
+    {
+        struct registro_historico fim = {REGISTRO_FIM_PARTIDA, (uint8_t)vencedor, 0, 0, 0, 0, placar_historico(partida), 0};
+        registrar_historico(partida->historico, fim);
+        // Só grava entre partidas, para que cada uma fique contígua no arquivo
+        if (partida->historico->qtd >= LIMITE_BUFFER_HISTORICO)
+            descarregar_historico(partida->historico);
+    }
+    emitir_evento(partida, EVENTO_FIM_PARTIDA, NULL, vencedor);
+    return vencedor;
+}
+
+int jogar_partida(struct partida *partida)
+{
+    // O tamanho da mesa é escolhido uma vez por partida; daí em diante o motor é o da mesa
+    switch (partida->qtd_jogadores_cada_time)
+    {
+    case 1:
+        return jogar_partida_fixa(partida, 1);
+    case 2:
+        return jogar_partida_fixa(partida, 2);
+    default:
+        return jogar_partida_fixa(partida, 3);
+    }
+}
+
+void iniciar_distribuidor(struct distribuidor_trabalho *distribuidor, long long qtd_itens, int qtd_threads, long long tamanho_lote)
+{
+    distribuidor->qtd_threads = qtd_threads;
+    distribuidor->tamanho_lote = tamanho_lote;
+    for (int t = 0; t < qtd_threads; t++)
+    {
+        atomic_init(&distribuidor->faixas[t].proximo, qtd_itens * t / qtd_threads);
+        distribuidor->faixas[t].fim = qtd_itens * (t + 1) / qtd_threads;
+    }
+}
+
+bool pegar_lote(struct distribuidor_trabalho *distribuidor, int thread, long long *inicio, long long *fim)
+{
+    // Começa pela própria faixa e, quando ela acaba, percorre as das outras threads
+    for (int i = 0; i < distribuidor->qtd_threads; i++)
+    {
+        struct faixa_trabalho *faixa = &distribuidor->faixas[(thread + i) % distribuidor->qtd_threads];
+        if (atomic_load_explicit(&faixa->proximo, memory_order_relaxed) >= faixa->fim)
+            continue;
+
+        long long pego = atomic_fetch_add_explicit(&faixa->proximo, distribuidor->tamanho_lote, memory_order_relaxed);
+        if (pego < faixa->fim)
+        {
+            *inicio = pego;
+            *fim = pego + distribuidor->tamanho_lote < faixa->fim ? pego + distribuidor->tamanho_lote : faixa->fim;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct argumento_thread
+{
+    void (*tarefa)(int thread, void *contexto);
+    void *contexto;
+    int thread;
+};
+
+static void *rodar_thread(void *argumento)
+{
+    struct argumento_thread *arg = argumento;
+    arg->tarefa(arg->thread, arg->contexto);
+#ifdef INSTRUMENTACAO
+    somar_instrumentacao_thread();
+#endif
+    return NULL;
+}
+
+void executar_em_paralelo(int qtd_threads, void (*tarefa)(int thread, void *contexto), void *contexto)
+{
+    pthread_t threads[MAX_THREADS];
+    struct argumento_thread argumentos[MAX_THREADS];
+
+    for (int t = 1; t < qtd_threads; t++)
+    {
+        argumentos[t].tarefa = tarefa;
+        argumentos[t].contexto = contexto;
+        argumentos[t].thread = t;
+        pthread_create(&threads[t], NULL, rodar_thread, &argumentos[t]);
+    }
+
+    tarefa(0, contexto);
+
+    for (int t = 1; t < qtd_threads; t++)
+        pthread_join(threads[t], NULL);
+}
+
+int qtd_processadores(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO informacoes;
+    GetSystemInfo(&informacoes);
+    int qtd = (int)informacoes.dwNumberOfProcessors;
+#else
+    int qtd = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (qtd < 1)
+        return 1;
+    return qtd > MAX_THREADS ? MAX_THREADS : qtd;
+}
+
+void simular_lote(struct resultado_simulacao *resultado, int numero_jogadores, uint64_t semente, long long inicio, long long fim, decisao_jogador decisao_time_1, struct historico *historico, struct saida_eventos *eventos)
+{
+    int qtd_jogadores_cada_time = numero_jogadores / 2;
+    struct jogador time_1[MAX_JOGADORES_TIME];
+    struct jogador time_2[MAX_JOGADORES_TIME];
+    struct partida partida;
+    struct estatisticas_mcts antes = estatisticas_mcts_thread;
+
+    for (int i = 0; i < qtd_jogadores_cada_time; i++)
+    {
+        char nome[TAMANHO_NOME];
+        snprintf(nome, sizeof(nome), "Robô %d", 2 * i + 1);
+        time_1[i].nome = internar_nome(nome);
+        snprintf(nome, sizeof(nome), "Robô %d", 2 * i + 2);
+        time_2[i].nome = internar_nome(nome);
+        time_1[i].decidir = decisao_time_1;
+        time_2[i].decidir = escolher_acao_aleatoria;
+    }
+
+    for (long long n = inicio; n < fim; n++)
+    {
+        iniciar_partida(&partida, time_1, time_2, qtd_jogadores_cada_time, eventos, semente, (uint64_t)n);
+        partida.historico = historico;
+        resultado->vitorias[jogar_partida(&partida)]++;
+        resultado->maos += partida.maos_jogadas;
+        resultado->pontos[1] += partida.pontuacao_time_1;
+        resultado->pontos[2] += partida.pontuacao_time_2;
+        resultado->partidas++;
+    }
+
+    resultado->mcts.decisoes += estatisticas_mcts_thread.decisoes - antes.decisoes;
+    resultado->mcts.playouts += estatisticas_mcts_thread.playouts - antes.playouts;
+    resultado->mcts.segundos += estatisticas_mcts_thread.segundos - antes.segundos;
+}
+
+struct contexto_simulacao
+{
+    struct distribuidor_trabalho distribuidor;
+    struct resultado_simulacao resultados[MAX_THREADS];
+    int numero_jogadores;
+    uint64_t semente;
+    decisao_jogador decisao_time_1;
+    struct arquivo_historico *destino;
+    FILE *arquivo_eventos;
+    pthread_mutex_t trava_eventos;
+};
+
+static void tarefa_simulacao(int thread, void *contexto)
+{
+    struct contexto_simulacao *simulacao = contexto;
+    struct historico historico;
+    struct saida_eventos eventos;
+    long long inicio, fim;
+
+    // Cada thread acumula os próprios registros e só trava o arquivo para gravar um bloco de partidas
+    iniciar_historico(&historico, simulacao->destino);
+    iniciar_saida_fluxo(&eventos, simulacao->arquivo_eventos, &simulacao->trava_eventos);
+    while (pegar_lote(&simulacao->distribuidor, thread, &inicio, &fim))
+        simular_lote(&simulacao->resultados[thread], simulacao->numero_jogadores, simulacao->semente, inicio, fim, simulacao->decisao_time_1,
+                     simulacao->destino != NULL ? &historico : NULL, simulacao->arquivo_eventos != NULL ? &eventos : NULL);
+    liberar_historico(&historico);
+    liberar_saida_fluxo(&eventos);
+    liberar_arvore_mcts();
+}
+
+void simular_partidas(long long qtd_partidas, int numero_jogadores, uint64_t semente, int qtd_threads, decisao_jogador decisao_time_1, struct arquivo_historico *destino, FILE *arquivo_eventos)
+{
+    struct contexto_simulacao *simulacao = calloc(1, sizeof(*simulacao));
+    struct resultado_simulacao total = {0};
+    double inicio, segundos;
+
+    if (simulacao == NULL)
+    {
+        printf("Memória insuficiente para a simulação.\n");
+        return;
+    }
+
+    simulacao->numero_jogadores = numero_jogadores;
+    simulacao->semente = semente;
+    simulacao->decisao_time_1 = decisao_time_1;
+    simulacao->destino = destino;
+    simulacao->arquivo_eventos = arquivo_eventos;
+    pthread_mutex_init(&simulacao->trava_eventos, NULL);
+    iniciar_distribuidor(&simulacao->distribuidor, qtd_partidas, qtd_threads, TAMANHO_LOTE_PARTIDAS);
+
+    inicio = tempo_atual();
+    executar_em_paralelo(qtd_threads, tarefa_simulacao, simulacao);
+    segundos = tempo_atual() - inicio;
+    pthread_mutex_destroy(&simulacao->trava_eventos);
+
+    // Junta os resultados de cada thread só no final, sem travas durante a simulação
+    for (int t = 0; t < qtd_threads; t++)
+    {
+        total.partidas += simulacao->resultados[t].partidas;
+        total.maos += simulacao->resultados[t].maos;
+        for (int time = 1; time <= 2; time++)
+        {
+            total.vitorias[time] += simulacao->resultados[t].vitorias[time];
+            total.pontos[time] += simulacao->resultados[t].pontos[time];
+        }
+        total.mcts.decisoes += simulacao->resultados[t].mcts.decisoes;
+        total.mcts.playouts += simulacao->resultados[t].mcts.playouts;
+        total.mcts.segundos += simulacao->resultados[t].mcts.segundos;
+    }
+    free(simulacao);
+
+    printf("\n------ Simulação ------\n");
+    printf("Partidas: %lld (%d jogadores, semente %llu, %d threads)\n", total.partidas, numero_jogadores, (unsigned long long)semente, qtd_threads);
+    printf("Vitórias do Time 1: %lld (%.2f%%)\n", total.vitorias[1], 100.0 * (double)total.vitorias[1] / (double)total.partidas);
+    printf("Vitórias do Time 2: %lld (%.2f%%)\n", total.vitorias[2], 100.0 * (double)total.vitorias[2] / (double)total.partidas);
+    printf("Mãos por partida: %.2f\n", (double)total.maos / (double)total.partidas);
+    printf("Pontos: Time 1 %lld, Time 2 %lld\n", total.pontos[1], total.pontos[2]);
+    printf("Tempo: %.3f s (%.0f partidas/s)\n", segundos, segundos > 0 ? (double)total.partidas / segundos : 0.0);
+    exibir_estatisticas_mcts(&total.mcts);
+    printf("------------------------\n");
+}
+
+const struct robo_registrado *buscar_robo(const char *nome)
+{
+    for (size_t i = 0; i < sizeof(ROBOS_REGISTRADOS) / sizeof(ROBOS_REGISTRADOS[0]); i++)
+        if (strcmp(ROBOS_REGISTRADOS[i].nome, nome) == 0)
+            return &ROBOS_REGISTRADOS[i];
+    return NULL;
+}
+
+bool inscrever_robos(struct torneio *torneio, const char *lista)
+{
+    char nome[TAMANHO_NOME];
+
+    if (strcmp(lista, "todos") == 0)
+    {
+        for (size_t i = 0; i < sizeof(ROBOS_REGISTRADOS) / sizeof(ROBOS_REGISTRADOS[0]); i++)
+        {
+            torneio->participantes[i].nome = ROBOS_REGISTRADOS[i].nome;
+            torneio->participantes[i].decidir = ROBOS_REGISTRADOS[i].decidir;
+        }
+        torneio->qtd_participantes = (int)(sizeof(ROBOS_REGISTRADOS) / sizeof(ROBOS_REGISTRADOS[0]));
+        return true;
+    }
+
+    for (const char *resto = lista; *resto != '\0';)
+    {
+        size_t tamanho = strcspn(resto, ",");
+        snprintf(nome, sizeof(nome), "%.*s", (int)(tamanho < sizeof(nome) ? tamanho : sizeof(nome) - 1), resto);
+        resto += tamanho + (resto[tamanho] == ',');
+
+        const struct robo_registrado *robo = buscar_robo(nome);
+        if (robo == NULL)
+        {
+            printf("Robô desconhecido: %s. Robôs registrados:", nome);
+            for (size_t i = 0; i < sizeof(ROBOS_REGISTRADOS) / sizeof(ROBOS_REGISTRADOS[0]); i++)
+                printf(" %s", ROBOS_REGISTRADOS[i].nome);
+            printf(".\n");
+            return false;
+        }
+        if (torneio->qtd_participantes == MAX_PARTICIPANTES_TORNEIO)
+        {
+            printf("O torneio aceita no máximo %d robôs.\n", MAX_PARTICIPANTES_TORNEIO);
+            return false;
+        }
+
+        // A segunda inscrição do mesmo robô vira "nome#2", e assim por diante
+        int repeticoes = 1;
+        for (int i = 0; i < torneio->qtd_participantes; i++)
+            repeticoes += torneio->participantes[i].decidir == robo->decidir;
+        char rotulo[TAMANHO_NOME];
+        if (repeticoes > 1)
+            snprintf(rotulo, sizeof(rotulo), "%s#%d", robo->nome, repeticoes);
+        else
+            snprintf(rotulo, sizeof(rotulo), "%s", robo->nome);
+
+        struct participante_torneio *participante = &torneio->participantes[torneio->qtd_participantes++];
+        participante->nome = internar_nome(rotulo);
+        participante->decidir = robo->decidir;
+    }
+    return torneio->qtd_participantes > 0;
+}
+
+long long jogar_confronto(const struct torneio *torneio, const struct confronto_torneio *confronto, long long inicio, long long fim)
+{
+    int qtd_jogadores_cada_time = torneio->numero_jogadores / 2;
+    const struct participante_torneio *a = &torneio->participantes[confronto->a];
+    const struct participante_torneio *b = &torneio->participantes[confronto->b];
+    struct jogador jogadores_a[MAX_JOGADORES_TIME];
+    struct jogador jogadores_b[MAX_JOGADORES_TIME];
+    struct partida partida;
+    long long vitorias_a = 0;
+
+    for (int i = 0; i < qtd_jogadores_cada_time; i++)
+    {
+        jogadores_a[i] = (struct jogador){a->nome, a->decidir, -1};
+        jogadores_b[i] = (struct jogador){b->nome, b->decidir, -1};
+    }
+
+    for (long long n = inicio; n < fim; n++)
+    {
+        // As duas partidas de cada dupla usam a mesma semente, então recebem as mesmas cartas
+        bool a_comeca = n % 2 == 0;
+        iniciar_partida(&partida, a_comeca ? jogadores_a : jogadores_b, a_comeca ? jogadores_b : jogadores_a,
+                        qtd_jogadores_cada_time, NULL, torneio->semente, (uint64_t)(confronto->primeira_partida + n / 2));
+        int vencedor = jogar_partida(&partida);
+        vitorias_a += (vencedor == 1) == a_comeca;
+    }
+    return vitorias_a;
+}
+
+void estimar_forcas_torneio(struct torneio *torneio)
+{
+    int qtd = torneio->qtd_participantes;
+    double vitorias[MAX_PARTICIPANTES_TORNEIO];
+    static double partidas_par[MAX_PARTICIPANTES_TORNEIO][MAX_PARTICIPANTES_TORNEIO]; // Só a thread 0 estima, então pode ser estática.
+
+    // Uma cópia dos placares, que as outras threads continuam somando
+    memset(partidas_par, 0, sizeof(partidas_par));
+    for (int i = 0; i < qtd; i++)
+    {
+        torneio->participantes[i].partidas = 0;
+        torneio->participantes[i].vitorias = 0;
+    }
+    for (int c = 0; c < torneio->qtd_confrontos; c++)
+    {
+        struct confronto_torneio *confronto = &torneio->confrontos[c];
+        long long partidas = atomic_load_explicit(&confronto->partidas, memory_order_acquire);
+        long long vitorias_a = atomic_load_explicit(&confronto->vitorias_a, memory_order_relaxed);
+        partidas_par[confronto->a][confronto->b] += (double)partidas;
+        partidas_par[confronto->b][confronto->a] += (double)partidas;
+        torneio->participantes[confronto->a].partidas += partidas;
+        torneio->participantes[confronto->b].partidas += partidas;
+        torneio->participantes[confronto->a].vitorias += vitorias_a;
+        torneio->participantes[confronto->b].vitorias += partidas - vitorias_a;
+    }
+    for (int i = 0; i < qtd; i++)
+    {
+        vitorias[i] = (double)torneio->participantes[i].vitorias + 1.0;
+        if (!(torneio->participantes[i].forca > 0))
+            torneio->participantes[i].forca = 1.0;
+    }
+
+    for (int iteracao = 0; iteracao < 10000; iteracao++)
+    {
+        double maior_mudanca = 0, soma_log = 0;
+        for (int i = 0; i < qtd; i++)
+        {
+            double forca = torneio->participantes[i].forca;
+            double denominador = 2.0 / (forca + 1.0); // A vitória e a derrota contra o adversário médio
+            for (int j = 0; j < qtd; j++)
+                if (partidas_par[i][j] > 0)
+                    denominador += partidas_par[i][j] / (forca + torneio->participantes[j].forca);
+            double nova = vitorias[i] / denominador;
+            maior_mudanca = fmax(maior_mudanca, fabs(log(nova / forca)));
+            torneio->participantes[i].forca = nova;
+            soma_log += log(nova);
+        }
+        // Só as razões entre as forças importam; a média geométrica fica em 1
+        double escala = exp(soma_log / qtd);
+        for (int i = 0; i < qtd; i++)
+            torneio->participantes[i].forca /= escala;
+        if (maior_mudanca < 1e-10)
+            break;
+    }
+
+    for (int i = 0; i < qtd; i++)
+    {
+        double forca = torneio->participantes[i].forca;
+        double p = forca / (forca + 1.0);
+        double informacao = 2.0 * p * (1.0 - p);
+        for (int j = 0; j < qtd; j++)
+        {
+            if (partidas_par[i][j] == 0)
+                continue;
+            p = forca / (forca + torneio->participantes[j].forca);
+            informacao += partidas_par[i][j] * p * (1.0 - p);
+        }
+        torneio->participantes[i].elo = ELO_INICIAL + 400.0 * log10(forca);
+        torneio->participantes[i].erro_elo = 400.0 / log(10.0) / sqrt(informacao);
+    }
+}
+
+struct contexto_torneio
+{
+    struct distribuidor_trabalho distribuidor;
+    struct torneio *torneio;
+    int primeiro_confronto;   // Primeiro confronto da rodada; os itens são as partidas dos confrontos seguintes.
+    long long partidas_antes; // Partidas das rodadas anteriores, para o progresso.
+    long long partidas_total; // Partidas do torneio inteiro, para o progresso.
+    double inicio;            // Início do torneio.
+    double ultimo_relatorio;  // Última classificação parcial exibida.
+};
+
+/**
+ * @brief Ordena os participantes pelo Elo, do maior para o menor.
+ */
+static void ordenar_por_elo(const struct torneio *torneio, int ordem[])
+{
+    for (int i = 0; i < torneio->qtd_participantes; i++)
+    {
+        int j = i;
+        for (; j > 0 && torneio->participantes[ordem[j - 1]].elo < torneio->participantes[i].elo; j--)
+            ordem[j] = ordem[j - 1];
+        ordem[j] = i;
+    }
+}
+
+/**
+ * @brief Exibe uma linha com o andamento e o líder provisório (chamada só pela thread 0).
+ */
+static void relatar_progresso_torneio(struct contexto_torneio *contexto)
+{
+    struct torneio *torneio = contexto->torneio;
+    long long partidas = 0;
+    double agora = tempo_atual();
+    int ordem[MAX_PARTICIPANTES_TORNEIO];
+
+    if (agora - contexto->ultimo_relatorio < 1.0)
+        return;
+    contexto->ultimo_relatorio = agora;
+
+    estimar_forcas_torneio(torneio);
+    for (int i = 0; i < torneio->qtd_participantes; i++)
+        partidas += torneio->participantes[i].partidas;
+    partidas /= 2;
+    ordenar_por_elo(torneio, ordem);
+    printf("%5.1f%% | %lld partidas | %.0f partidas/s | 1º %s %.0f ± %.0f\n",
+           100.0 * (double)partidas / (double)contexto->partidas_total, partidas, (double)partidas / (agora - contexto->inicio),
+           torneio->participantes[ordem[0]].nome, torneio->participantes[ordem[0]].elo, 1.96 * torneio->participantes[ordem[0]].erro_elo);
+    fflush(stdout);
+}
+
+static void tarefa_torneio(int thread, void *contexto)
+{
+    struct contexto_torneio *rodada = contexto;
+    struct torneio *torneio = rodada->torneio;
+    long long por_confronto = torneio->partidas_por_confronto;
+    long long inicio, fim;
+
+    while (pegar_lote(&rodada->distribuidor, thread, &inicio, &fim))
+    {
+        // Um lote pode cobrir o fim de um confronto e o começo do seguinte
+        for (long long n = inicio; n < fim;)
+        {
+            struct confronto_torneio *confronto = &torneio->confrontos[rodada->primeiro_confronto + n / por_confronto];
+            long long fim_trecho = (n / por_confronto + 1) * por_confronto;
+            if (fim_trecho > fim)
+                fim_trecho = fim;
+            long long vitorias_a = jogar_confronto(torneio, confronto, n % por_confronto, n % por_confronto + fim_trecho - n);
+            atomic_fetch_add_explicit(&confronto->vitorias_a, vitorias_a, memory_order_relaxed);
+            atomic_fetch_add_explicit(&confronto->partidas, fim_trecho - n, memory_order_release);
+            n = fim_trecho;
+        }
+        if (thread == 0)
+            relatar_progresso_torneio(rodada);
+    }
+    liberar_arvore_mcts();
+}
+
+/**
+ * @brief Acrescenta um confronto entre os participantes 'a' e 'b' à agenda.
+ */
+static bool agendar_confronto(struct torneio *torneio, int a, int b)
+{
+    if (torneio->qtd_confrontos == torneio->capacidade_confrontos)
+    {
+        int capacidade = torneio->capacidade_confrontos > 0 ? 2 * torneio->capacidade_confrontos : 256;
+        struct confronto_torneio *confrontos = realloc(torneio->confrontos, (size_t)capacidade * sizeof(*confrontos));
+        if (confrontos == NULL)
+            return false;
+        torneio->confrontos = confrontos;
+        torneio->capacidade_confrontos = capacidade;
+    }
+    struct confronto_torneio *confronto = &torneio->confrontos[torneio->qtd_confrontos];
+    confronto->a = a;
+    confronto->b = b;
+    confronto->primeira_partida = (long long)torneio->qtd_confrontos * ((torneio->partidas_por_confronto + 1) / 2);
+    atomic_init(&confronto->vitorias_a, 0);
+    atomic_init(&confronto->partidas, 0);
+    torneio->qtd_confrontos++;
+    return true;
+}
+
+/**
+ * @brief Agenda uma rodada suíça: o melhor Elo ainda livre enfrenta o próximo que ele não enfrentou.
+ *
+ * Se todos os livres já foram enfrentados, repete um confronto; com número ímpar, o último fica de fora.
+ */
+static bool agendar_rodada_suica(struct torneio *torneio)
+{
+    int ordem[MAX_PARTICIPANTES_TORNEIO];
+    bool pareado[MAX_PARTICIPANTES_TORNEIO] = {false};
+    int qtd = torneio->qtd_participantes;
+
+    ordenar_por_elo(torneio, ordem);
+    for (int i = 0; i < qtd; i++)
+    {
+        if (pareado[ordem[i]])
+            continue;
+        int escolhido = -1;
+        for (int j = i + 1; j < qtd; j++)
+        {
+            if (pareado[ordem[j]])
+                continue;
+            if (escolhido < 0)
+                escolhido = j;
+            bool ja_enfrentou = false;
+            for (int c = 0; c < torneio->qtd_confrontos && !ja_enfrentou; c++)
+                ja_enfrentou = (torneio->confrontos[c].a == ordem[i] && torneio->confrontos[c].b == ordem[j]) ||
+                               (torneio->confrontos[c].a == ordem[j] && torneio->confrontos[c].b == ordem[i]);
+            if (!ja_enfrentou)
+            {
+                escolhido = j;
+                break;
+            }
+        }
+        if (escolhido < 0)
+            break;
+        pareado[ordem[i]] = pareado[ordem[escolhido]] = true;
+        if (!agendar_confronto(torneio, ordem[i], ordem[escolhido]))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Exibe a classificação e, se pedido, grava em CSV.
+ */
+static bool exibir_classificacao(struct torneio *torneio, const char *arquivo_classificacao)
+{
+    int ordem[MAX_PARTICIPANTES_TORNEIO];
+    FILE *arquivo = NULL;
+
+    if (arquivo_classificacao != NULL)
+    {
+        arquivo = fopen(arquivo_classificacao, "w");
+        if (arquivo == NULL)
+        {
+            printf("Não foi possível gravar %s.\n", arquivo_classificacao);
+            return false;
+        }
+        fprintf(arquivo, "posicao,robo,elo,erro,ic95_inferior,ic95_superior,partidas,vitorias\n");
+    }
+
+    ordenar_por_elo(torneio, ordem);
+    printf("Pos  Robô                  Elo            IC 95%%     Partidas  Vitórias\n");
+    for (int i = 0; i < torneio->qtd_participantes; i++)
+    {
+        const struct participante_torneio *participante = &torneio->participantes[ordem[i]];
+        double margem = 1.96 * participante->erro_elo;
+        printf("%3d  %-16s %8.1f  [%6.1f, %6.1f] %12lld %8.2f%%\n", i + 1, participante->nome, participante->elo,
+               participante->elo - margem, participante->elo + margem, participante->partidas,
+               participante->partidas > 0 ? 100.0 * (double)participante->vitorias / (double)participante->partidas : 0.0);
+        if (arquivo != NULL)
+            fprintf(arquivo, "%d,%s,%.2f,%.2f,%.2f,%.2f,%lld,%lld\n", i + 1, participante->nome, participante->elo, participante->erro_elo,
+                    participante->elo - margem, participante->elo + margem, participante->partidas, participante->vitorias);
+    }
+    if (arquivo != NULL && fclose(arquivo) != 0)
+    {
+        printf("Não foi possível gravar %s.\n", arquivo_classificacao);
+        return false;
+    }
+    return true;
+}
+
+bool executar_torneio(struct torneio *torneio, int rodadas_suicas, int qtd_threads, const char *arquivo_classificacao)
+{
+    struct contexto_torneio *rodada = calloc(1, sizeof(*rodada));
+    int qtd = torneio->qtd_participantes;
+    double segundos;
+    bool sucesso = true;
+
+    if (rodada == NULL)
+    {
+        printf("Memória insuficiente para o torneio.\n");
+        return false;
+    }
+
+    for (int i = 0; i < qtd; i++)
+        torneio->participantes[i].forca = 1.0;
+    estimar_forcas_torneio(torneio);
+
+    rodada->torneio = torneio;
+    rodada->partidas_total = torneio->partidas_por_confronto * (rodadas_suicas > 0 ? (long long)rodadas_suicas * (qtd / 2) : (long long)qtd * (qtd - 1) / 2);
+    rodada->inicio = tempo_atual();
+    rodada->ultimo_relatorio = rodada->inicio;
+
+    printf("\n------ Torneio ------\n");
+    printf("Robôs: %d | %s | %lld partidas por confronto (%d jogadores, semente %llu, %d threads)\n", qtd,
+           rodadas_suicas > 0 ? "sistema suíço" : "todos contra todos", torneio->partidas_por_confronto, torneio->numero_jogadores,
+           (unsigned long long)torneio->semente, qtd_threads);
+
+    // Todos contra todos é uma única rodada com todos os pares
+    for (int numero = 1; sucesso && numero <= (rodadas_suicas > 0 ? rodadas_suicas : 1); numero++)
+    {
+        rodada->primeiro_confronto = torneio->qtd_confrontos;
+        if (rodadas_suicas > 0)
+            sucesso = agendar_rodada_suica(torneio);
+        else
+            for (int a = 0; a < qtd && sucesso; a++)
+                for (int b = a + 1; b < qtd && sucesso; b++)
+                    sucesso = agendar_confronto(torneio, a, b);
+        if (!sucesso)
+        {
+            printf("Memória insuficiente para o torneio.\n");
+            break;
+        }
+
+        long long partidas = (long long)(torneio->qtd_confrontos - rodada->primeiro_confronto) * torneio->partidas_por_confronto;
+        iniciar_distribuidor(&rodada->distribuidor, partidas, qtd_threads, TAMANHO_LOTE_PARTIDAS);
+        executar_em_paralelo(qtd_threads, tarefa_torneio, rodada);
+        rodada->partidas_antes += partidas;
+
+        // A estimativa entre as rodadas é a que define os pares da rodada seguinte
+        estimar_forcas_torneio(torneio);
+        if (rodadas_suicas > 0)
+            printf("Rodada %d: %d confrontos\n", numero, torneio->qtd_confrontos - rodada->primeiro_confronto);
+    }
+    segundos = tempo_atual() - rodada->inicio;
+
+    if (sucesso)
+    {
+        // A classificação final parte do zero, para não depender das estimativas parciais
+        for (int i = 0; i < qtd; i++)
+            torneio->participantes[i].forca = 1.0;
+        estimar_forcas_torneio(torneio);
+        printf("Partidas: %lld | Tempo: %.3f s (%.0f partidas/s)\n", rodada->partidas_antes, segundos,
+               segundos > 0 ? (double)rodada->partidas_antes / segundos : 0.0);
+        sucesso = exibir_classificacao(torneio, arquivo_classificacao);
+        printf("---------------------\n");
+    }
+
+    free(rodada);
+    free(torneio->confrontos);
+    torneio->confrontos = NULL;
+    torneio->qtd_confrontos = torneio->capacidade_confrontos = 0;
+    return sucesso;
+}
+
+bool abrir_arquivo_historico(struct arquivo_historico *arquivo, const char *caminho)
+{
+    struct cabecalho_historico cabecalho = {"TRUCOHS1", 1, sizeof(struct registro_historico)};
+    struct cabecalho_historico existente;
+
+    // Um arquivo existente só recebe registros se estiver no mesmo formato
+    FILE *leitura = fopen(caminho, "rb");
+    if (leitura != NULL)
+    {
+        size_t lidos = fread(&existente, sizeof(existente), 1, leitura);
+        fclose(leitura);
+        if (lidos == 1 && memcmp(&existente, &cabecalho, sizeof(cabecalho)) != 0)
+        {
+            printf("%s não é um histórico no formato atual.\n", caminho);
+            return false;
+        }
+    }
+
+    arquivo->arquivo = fopen(caminho, "ab");
+    if (arquivo->arquivo == NULL)
+    {
+        printf("Não foi possível abrir %s.\n", caminho);
+        return false;
+    }
+    if (ftell(arquivo->arquivo) == 0 && fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo->arquivo) != 1)
+    {
+        fclose(arquivo->arquivo);
+        printf("Não foi possível gravar %s.\n", caminho);
+        return false;
+    }
+    pthread_mutex_init(&arquivo->trava, NULL);
+    arquivo->registros = 0;
+    arquivo->perdidos = 0;
+    return true;
+}
+
+bool fechar_arquivo_historico(struct arquivo_historico *arquivo)
+{
+    fclose(arquivo->arquivo);
+    pthread_mutex_destroy(&arquivo->trava);
+    if (arquivo->perdidos > 0)
+    {
+        printf("Faltou memória para %lld registros do histórico; as partidas afetadas estão incompletas no arquivo.\n", arquivo->perdidos);
+        return false;
+    }
+    return true;
+}
+
+void iniciar_historico(struct historico *historico, struct arquivo_historico *destino)
+{
+    historico->destino = destino;
+    historico->registros = NULL;
+    historico->qtd = 0;
+    historico->capacidade = 0;
+    historico->perdidos = 0;
+}
+
+bool registrar_historico(struct historico *historico, struct registro_historico registro)
+{
+    // O buffer cresce só quando uma partida passa do limite; na prática isso acontece poucas vezes
+    if (historico->qtd == historico->capacidade)
+    {
+        size_t capacidade = historico->capacidade == 0 ? LIMITE_BUFFER_HISTORICO + 1024 : 2 * historico->capacidade;
+        struct registro_historico *registros = realloc(historico->registros, capacidade * sizeof(*registros));
+        if (registros == NULL)
+        {
+            historico->perdidos++;
+            return false;
+        }
+        historico->registros = registros;
+        historico->capacidade = capacidade;
+    }
+    historico->registros[historico->qtd++] = registro;
+    return true;
+}
+
+void descarregar_historico(struct historico *historico)
+{
+    if (historico->qtd == 0 && historico->perdidos == 0)
+        return;
+    INICIAR_MEDICAO(inicio);
+    pthread_mutex_lock(&historico->destino->trava);
+    if (historico->qtd > 0)
+        fwrite(historico->registros, sizeof(struct registro_historico), historico->qtd, historico->destino->arquivo);
+    historico->destino->registros += (long long)historico->qtd;
+    historico->destino->perdidos += historico->perdidos;
+    pthread_mutex_unlock(&historico->destino->trava);
+    historico->qtd = 0;
+    historico->perdidos = 0;
+    ENCERRAR_MEDICAO(FASE_SAIDA, inicio);
+}
+
+void liberar_historico(struct historico *historico)
+{
+    descarregar_historico(historico);
+    free(historico->registros);
+    historico->registros = NULL;
+    historico->capacidade = 0;
+}
+
+void analisar_registros(const struct registro_historico *registros, long long qtd, long long inicio, long long fim, struct estatisticas_historico *estatisticas)
+{
+    long long i = inicio;
+
+    // Pula o resto da partida que começou no intervalo anterior
+    while (i < qtd && registros[i].tipo != REGISTRO_PARTIDA)
+        i++;
+
+    while (i < fim)
+    {
+        int vira = 0, time_inicio = 1, vazas = 0, nivel_pedido = 0, nivel_aceito = 0, time_aceito = 0;
+        int manilhas[3] = {0}, maior_manilha[3] = {0};
+        int placar_anterior[3] = {0};
+        bool empatou_primeira = false;
+        uint64_t conjunto_manilhas = 0;
+
+        estatisticas->registros++;
+        for (i++; i < qtd && registros[i].tipo != REGISTRO_PARTIDA; i++)
+        {
+            const struct registro_historico *registro = &registros[i];
+            int nivel = registro->valor / 3;
+            if (nivel > 4)
+                nivel = 4;
+
+            estatisticas->registros++;
+            switch (registro->tipo)
+            {
+            case REGISTRO_SEMENTE:
+            case REGISTRO_JOGADA:
+                break;
+            case REGISTRO_MAO:
+                vira = registro->carta / 4;
+                time_inicio = registro->time;
+                conjunto_manilhas = 0xFULL << (4 * (MANILHA_DA_VIRA(vira + 1) - 1));
+                vazas = nivel_pedido = nivel_aceito = time_aceito = 0;
+                empatou_primeira = false;
+                manilhas[1] = manilhas[2] = maior_manilha[1] = maior_manilha[2] = 0;
+                break;
+            case REGISTRO_CARTAS:
+            {
+                uint64_t suas = registro->dados & conjunto_manilhas;
+                int time = registro->time == 2 ? 2 : 1;
+                manilhas[time] += qtd_cartas(suas);
+                if (suas != 0 && (63 - __builtin_clzll(suas)) % 4 + 1 > maior_manilha[time])
+                    maior_manilha[time] = (63 - __builtin_clzll(suas)) % 4 + 1;
+                break;
+            }
+            case REGISTRO_TRUCO:
+                estatisticas->pedidos_truco[nivel]++;
+                nivel_pedido = nivel;
+                break;
+            case REGISTRO_ACEITE:
+                estatisticas->aceites_truco[nivel]++;
+                nivel_aceito = nivel;
+                time_aceito = registro->time == 1 ? 2 : 1; // Quem pediu é o outro time
+                break;
+            case REGISTRO_RECUSA:
+                estatisticas->recusas_truco[nivel_pedido]++;
+                break;
+            case REGISTRO_VAZA:
+                vazas = registro->valor;
+                if (vazas == 1 && registro->time == 0)
+                    empatou_primeira = true;
+                break;
+            case REGISTRO_FIM_MAO:
+            {
+                int vencedor = registro->time == 2 ? 2 : 1;
+                int placar[3] = {0, registro->placar & 0xFF, registro->placar >> 8};
+                int pontos = placar[vencedor] - placar_anterior[vencedor];
+                placar_anterior[1] = placar[1];
+                placar_anterior[2] = placar[2];
+
+                estatisticas->maos++;
+                estatisticas->maos_vira[vira]++;
+                estatisticas->vitorias_inicio_vira[vira] += vencedor == time_inicio;
+                for (int time = 1; time <= 2; time++)
+                {
+                    int k = manilhas[time] > 4 ? 4 : manilhas[time];
+                    estatisticas->maos_manilhas[k]++;
+                    estatisticas->vitorias_manilhas[k] += vencedor == time;
+                    estatisticas->maos_maior_manilha[maior_manilha[time]]++;
+                    estatisticas->vitorias_maior_manilha[maior_manilha[time]] += vencedor == time;
+                }
+                if (nivel_aceito > 0)
+                {
+                    estatisticas->maos_truco_aceito[nivel_aceito]++;
+                    estatisticas->vitorias_quem_pediu[nivel_aceito] += vencedor == time_aceito;
+                    estatisticas->saldo_quem_pediu[nivel_aceito] += vencedor == time_aceito ? pontos : -pontos;
+                }
+                if (empatou_primeira)
+                {
+                    // Sem vaza depois da primeira, a mão acabou em um truco recusado
+                    estatisticas->empates_primeira++;
+                    estatisticas->empates_decididos[vazas > 1 ? (vazas > 3 ? 3 : vazas) : 0]++;
+                    estatisticas->empates_vitorias_inicio += vencedor == time_inicio;
+                }
+                break;
+            }
+            case REGISTRO_FIM_PARTIDA:
+                estatisticas->partidas++;
+                break;
+            default:
+                estatisticas->invalidos++;
+                break;
+            }
+        }
+    }
+}
+
+struct contexto_analise
+{
+    struct distribuidor_trabalho distribuidor;
+    struct estatisticas_historico estatisticas[MAX_THREADS];
+    const struct registro_historico *registros;
+    long long qtd;
+};
+
+static void tarefa_analise(int thread, void *contexto)
+{
+    struct contexto_analise *analise = contexto;
+    long long inicio, fim;
+
+    while (pegar_lote(&analise->distribuidor, thread, &inicio, &fim))
+        analisar_registros(analise->registros, analise->qtd, inicio, fim, &analise->estatisticas[thread]);
+}
+
+static double percentual(long long parte, long long total)
+{
+    return total > 0 ? 100.0 * (double)parte / (double)total : 0;
+}
+
+static void exibir_estatisticas_historico(const struct estatisticas_historico *total, long long bytes, double segundos)
+{
+    const char *NOMES_MANILHAS[] = {"nenhuma", "Ouros", "Espadas", "Copas", "Paus"};
+    const char *NOMES_NIVEIS[] = {"", "truco (3)", "seis (6)", "nove (9)", "doze (12)"};
+
+    printf("\n------ Análise do histórico ------\n");
+    printf("Registros: %lld (%lld inválidos), %lld partidas, %lld mãos\n", total->registros, total->invalidos, total->partidas, total->maos);
+    printf("Tempo: %.3f s (%.0f milhões de registros/s, %.2f GB/s)\n", segundos,
+           segundos > 0 ? total->registros / segundos / 1e6 : 0, segundos > 0 ? bytes / segundos / 1e9 : 0);
+
+    printf("\nVitórias do time que começa a mão, por vira:\n");
+    for (int v = 0; v < 10; v++)
+        printf("  %c: %6.2f%% de %lld mãos\n", SIMBOLOS[v + 1], percentual(total->vitorias_inicio_vira[v], total->maos_vira[v]), total->maos_vira[v]);
+
+    printf("\nVitórias de um time pela quantidade de manilhas recebidas:\n");
+    for (int k = 0; k < 5; k++)
+        if (total->maos_manilhas[k] > 0)
+            printf("  %d: %6.2f%% de %lld mãos\n", k, percentual(total->vitorias_manilhas[k], total->maos_manilhas[k]), total->maos_manilhas[k]);
+
+    printf("\nVitórias de um time pela maior manilha recebida:\n");
+    for (int m = 0; m < 5; m++)
+        printf("  %-8s %6.2f%% de %lld mãos\n", NOMES_MANILHAS[m], percentual(total->vitorias_maior_manilha[m], total->maos_maior_manilha[m]), total->maos_maior_manilha[m]);
+
+    printf("\nPedidos de truco:\n");
+    for (int n = 1; n < 5; n++)
+    {
+        long long maos = total->maos_truco_aceito[n];
+        printf("  %-9s %lld pedidos, %.2f%% aceitos, %.2f%% recusados; jogada até o fim, quem pediu vence %.2f%% (saldo médio %+.2f pontos)\n",
+               NOMES_NIVEIS[n], total->pedidos_truco[n], percentual(total->aceites_truco[n], total->pedidos_truco[n]), percentual(total->recusas_truco[n], total->pedidos_truco[n]),
+               percentual(total->vitorias_quem_pediu[n], maos), maos > 0 ? (double)total->saldo_quem_pediu[n] / (double)maos : 0);
+    }
+
+    printf("\nPrimeira vaza empatada: %lld mãos (%.2f%%)\n", total->empates_primeira, percentual(total->empates_primeira, total->maos));
+    printf("  Decididas na segunda vaza: %.2f%%, na terceira: %.2f%%, por truco recusado: %.2f%%\n",
+           percentual(total->empates_decididos[2], total->empates_primeira), percentual(total->empates_decididos[3], total->empates_primeira),
+           percentual(total->empates_decididos[0], total->empates_primeira));
+    printf("  Vencidas pelo time que começou: %.2f%%\n", percentual(total->empates_vitorias_inicio, total->empates_primeira));
+}
+
+bool analisar_historicos(const char *caminhos[], int qtd_arquivos, int qtd_threads)
+{
+    struct contexto_analise *analise = calloc(1, sizeof(*analise));
+    struct estatisticas_historico total;
+    struct cabecalho_historico esperado = {"TRUCOHS1", 1, sizeof(struct registro_historico)};
+    long long bytes = 0;
+    double segundos = 0;
+    bool leu_todos = true;
+
+    if (analise == NULL)
+    {
+        printf("Memória insuficiente para a análise.\n");
+        return false;
+    }
+
+    for (int a = 0; a < qtd_arquivos; a++)
+    {
+        size_t tamanho;
+        void *dados;
+
+#ifdef _WIN32
+        // Sem mmap no Windows: lê o arquivo inteiro uma única vez
+        FILE *arquivo = fopen(caminhos[a], "rb");
+        dados = NULL;
+        if (arquivo != NULL && fseek(arquivo, 0, SEEK_END) == 0)
+        {
+            tamanho = (size_t)ftell(arquivo);
+            rewind(arquivo);
+            dados = malloc(tamanho > 0 ? tamanho : 1);
+            if (dados != NULL && fread(dados, 1, tamanho, arquivo) != tamanho)
+            {
+                free(dados);
+                dados = NULL;
+            }
+        }
+        if (arquivo != NULL)
+            fclose(arquivo);
+#else
+        int descritor = open(caminhos[a], O_RDONLY);
+        struct stat informacoes;
+        dados = NULL;
+        if (descritor >= 0 && fstat(descritor, &informacoes) == 0 && informacoes.st_size > 0)
+        {
+            tamanho = (size_t)informacoes.st_size;
+            dados = mmap(NULL, tamanho, PROT_READ, MAP_SHARED, descritor, 0);
+            if (dados == MAP_FAILED)
+                dados = NULL;
+            else
+                madvise(dados, tamanho, MADV_SEQUENTIAL);
+        }
+        if (descritor >= 0)
+            close(descritor);
+#endif
+
+        if (dados == NULL || tamanho < sizeof(esperado) || memcmp(dados, &esperado, sizeof(esperado)) != 0 ||
+            (tamanho - sizeof(esperado)) % sizeof(struct registro_historico) != 0)
+        {
+            printf("Histórico inválido ou ilegível: %s\n", caminhos[a]);
+            leu_todos = false;
+        }
+        else
+        {
+            analise->registros = (const struct registro_historico *)((const struct cabecalho_historico *)dados + 1);
+            analise->qtd = (long long)((tamanho - sizeof(esperado)) / sizeof(struct registro_historico));
+            iniciar_distribuidor(&analise->distribuidor, analise->qtd, qtd_threads, TAMANHO_LOTE_REGISTROS);
+
+            double inicio = tempo_atual();
+            executar_em_paralelo(qtd_threads, tarefa_analise, analise);
+            segundos += tempo_atual() - inicio;
+            bytes += (long long)tamanho;
+        }
+
+        if (dados != NULL)
+        {
+#ifdef _WIN32
+            free(dados);
+#else
+            munmap(dados, tamanho);
+#endif
+        }
+    }
+
+    // Junta as estatísticas de cada thread só no final; todos os campos são contadores
+    memset(&total, 0, sizeof(total));
+    for (int t = 0; t < qtd_threads; t++)
+    {
+        const long long *parcial = (const long long *)&analise->estatisticas[t];
+        long long *soma = (long long *)&total;
+        for (size_t c = 0; c < sizeof(total) / sizeof(long long); c++)
+            soma[c] += parcial[c];
+    }
+    free(analise);
+
+    exibir_estatisticas_historico(&total, bytes, segundos);
+    return leu_todos;
+}
+
+double tempo_atual(void)
+{
+    struct timespec agora;
+    timespec_get(&agora, TIME_UTC);
+    return (double)agora.tv_sec + (double)agora.tv_nsec / 1e9;
+}
+
+#ifdef INSTRUMENTACAO
+static struct instrumentacao instrumentacao_total;                          // Soma das threads de trabalho que já terminaram.
+static pthread_mutex_t trava_instrumentacao = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t relogio_inicio_instrumentacao;                             // Relógio da instrumentação no início da execução.
+static double segundos_inicio_instrumentacao;                              // 'tempo_atual' no mesmo instante.
+
+static const char *const NOMES_FASES[QTD_FASES_INSTRUMENTACAO] = {"distribuicao", "troca_repetida", "comparacao", "decisao", "vaza", "saida"};
+
+void registrar_medicao(enum fase_instrumentacao fase, uint64_t tiques)
+{
+    instrumentacao_thread.contagens[fase]++;
+    instrumentacao_thread.tiques[fase] += tiques;
+    if (fase == FASE_DECISAO)
+    {
+        int faixa = tiques == 0 ? 0 : 63 - __builtin_clzll(tiques);
+        instrumentacao_thread.latencias_decisao[faixa < QTD_FAIXAS_LATENCIA ? faixa : QTD_FAIXAS_LATENCIA - 1]++;
+    }
+}
+
+void somar_instrumentacao_thread(void)
+{
+    pthread_mutex_lock(&trava_instrumentacao);
+    for (int f = 0; f < QTD_FASES_INSTRUMENTACAO; f++)
+    {
+        instrumentacao_total.contagens[f] += instrumentacao_thread.contagens[f];
+        instrumentacao_total.tiques[f] += instrumentacao_thread.tiques[f];
+    }
+    for (int i = 0; i < QTD_FAIXAS_LATENCIA; i++)
+        instrumentacao_total.latencias_decisao[i] += instrumentacao_thread.latencias_decisao[i];
+    pthread_mutex_unlock(&trava_instrumentacao);
+    memset(&instrumentacao_thread, 0, sizeof(instrumentacao_thread));
+}
+
+void iniciar_instrumentacao(void)
+{
+    relogio_inicio_instrumentacao = ler_relogio_instrumentacao();
+    segundos_inicio_instrumentacao = tempo_atual();
+}
+
+bool gravar_instrumentacao(const char *caminho)
+{
+    size_t tamanho = strlen(caminho);
+    bool csv = tamanho >= 4 && strcmp(caminho + tamanho - 4, ".csv") == 0;
+
+    // A thread principal também trabalha (é a thread 0 das tarefas paralelas, o servidor e o jogo interativo)
+    somar_instrumentacao_thread();
+    double segundos = tempo_atual() - segundos_inicio_instrumentacao;
+    double ns_por_tique = segundos > 0 ? segundos * 1e9 / (double)(ler_relogio_instrumentacao() - relogio_inicio_instrumentacao) : 1.0;
+    const struct instrumentacao *total = &instrumentacao_total;
+
+    FILE *arquivo = fopen(caminho, "w");
+    if (arquivo == NULL)
+    {
+        printf("Não foi possível gravar %s.\n", caminho);
+        return false;
+    }
+
+    // Os tempos saem em nanossegundos; o relógio e a conversão ficam no arquivo para comparar execuções
+    if (csv)
+        fprintf(arquivo, "secao,nome,contagem,ns_total,ns_por_op\nrelogio,%s,,,\n", RELOGIO_INSTRUMENTACAO);
+    else
+        fprintf(arquivo, "{\n  \"segundos\": %.3f,\n  \"relogio\": \"%s\",\n  \"ns_por_tique\": %.6f,\n  \"fases\": [\n", segundos,
+                RELOGIO_INSTRUMENTACAO, ns_por_tique);
+    for (int f = 0; f < QTD_FASES_INSTRUMENTACAO; f++)
+    {
+        double ns = (double)total->tiques[f] * ns_por_tique;
+        double ns_por_op = total->contagens[f] > 0 ? ns / (double)total->contagens[f] : 0.0;
+        if (csv)
+            fprintf(arquivo, "fase,%s,%lld,%.0f,%.1f\n", NOMES_FASES[f], total->contagens[f], ns, ns_por_op);
+        else
+            fprintf(arquivo, "    {\"fase\": \"%s\", \"contagem\": %lld, \"ns_total\": %.0f, \"ns_por_op\": %.1f}%s\n",
+                    NOMES_FASES[f], total->contagens[f], ns, ns_por_op, f + 1 < QTD_FASES_INSTRUMENTACAO ? "," : "");
+    }
+
+    // Só as faixas com alguma decisão, cada uma com o seu limite superior em nanossegundos
+    int ultima = -1;
+    for (int i = 0; i < QTD_FAIXAS_LATENCIA; i++)
+        if (total->latencias_decisao[i] > 0)
+            ultima = i;
+    if (!csv)
+        fprintf(arquivo, "  ],\n  \"latencia_decisao\": [\n");
+    for (int i = 0; i <= ultima; i++)
+    {
+        double ate_ns = ldexp(1.0, i + 1) * ns_por_tique;
+        if (total->latencias_decisao[i] == 0)
+            continue;
+        if (csv)
+            fprintf(arquivo, "latencia_decisao,ate_%.0f_ns,%lld,,\n", ate_ns, total->latencias_decisao[i]);
+        else
+            fprintf(arquivo, "    {\"ate_ns\": %.0f, \"decisoes\": %lld}%s\n", ate_ns, total->latencias_decisao[i], i < ultima ? "," : "");
+    }
+    if (!csv)
+        fprintf(arquivo, "  ]\n}\n");
+
+    if (fclose(arquivo) != 0)
+    {
+        printf("Não foi possível gravar %s.\n", caminho);
+        return false;
+    }
+    printf("Instrumentação gravada em %s.\n", caminho);
+    return true;
+}
+#endif
+
+double registrar_benchmark(struct relatorio_benchmark *relatorio, const char *nome, int jogadores, long long repeticoes, double segundos)
+{
+    double ns_por_op = segundos * 1e9 / (double)repeticoes;
+    if (relatorio->qtd < MAX_RESULTADOS_BENCHMARK)
+    {
+        struct resultado_benchmark *resultado = &relatorio->resultados[relatorio->qtd++];
+        resultado->nome = nome;
+        resultado->jogadores = jogadores;
+        resultado->repeticoes = repeticoes;
+        resultado->ns_por_op = ns_por_op;
+    }
+    return ns_por_op;
+}
+
+void executar_benchmark_distribuicao(struct relatorio_benchmark *relatorio)
+{
+    const int repeticoes = 200000;
+    uint64_t maos_1[MAX_JOGADORES_TIME];
+    uint64_t maos_2[MAX_JOGADORES_TIME];
+    struct baralho baralho;
+    struct gerador gerador;
+    struct carta vira;
+    long soma_viras = 0; // Usa o resultado para que o laço não seja descartado pelo compilador
+
+    montar_baralho(&baralho);
+    semear_gerador(&gerador, 1, 0);
+
+    printf("\n------ Benchmark de distribuição ------\n");
+    printf("Jogadores | Sorteio (ns) | Baralho (ns) | Ganho\n");
+    for (int numero_jogadores = 2; numero_jogadores <= 6; numero_jogadores += 2)
+    {
+        int qtd_jogadores_cada_time = numero_jogadores / 2;
+        double inicio = tempo_atual();
+        for (int r = 0; r < repeticoes; r++)
+        {
+            embaralhar_por_sorteio(maos_1, maos_2, qtd_jogadores_cada_time, &gerador, &vira);
+            soma_viras += vira.indice;
+        }
+        double ns_sorteio = registrar_benchmark(relatorio, "distribuicao_sorteio", numero_jogadores, repeticoes, tempo_atual() - inicio);
+
+        inicio = tempo_atual();
+        for (int r = 0; r < repeticoes; r++)
+        {
+            embaralhar(maos_1, maos_2, qtd_jogadores_cada_time, &baralho, &gerador, &vira);
+            soma_viras += vira.indice;
+        }
+        double ns_baralho = registrar_benchmark(relatorio, "distribuicao_baralho", numero_jogadores, repeticoes, tempo_atual() - inicio);
+
+        printf("%9d | %12.1f | %12.1f | %4.1fx\n", numero_jogadores, ns_sorteio, ns_baralho, ns_sorteio / ns_baralho);
+    }
+    printf("(soma de controle: %ld)\n", soma_viras);
+    printf("---------------------------------------\n");
+}
+
+void executar_benchmark_comparacao(struct relatorio_benchmark *relatorio)
+{
+    enum
+    {
+        QTD_PARES = 4096,
+        REPETICOES = 5000
+    };
+    static struct carta a[QTD_PARES], b[QTD_PARES], vira[QTD_PARES];
+    struct gerador gerador;
+    long soma_regras = 0, soma_tabela = 0;
+
+    semear_gerador(&gerador, 1, 0);
+    for (int i = 0; i < QTD_PARES; i++)
+    {
+        a[i].indice = (uint8_t)sortear_limitado(&gerador, QTD_CARTAS_BARALHO);
+        b[i].indice = (uint8_t)sortear_limitado(&gerador, QTD_CARTAS_BARALHO);
+        vira[i].indice = (uint8_t)sortear_limitado(&gerador, QTD_CARTAS_BARALHO);
+    }
+
+    double inicio = tempo_atual();
+    for (int r = 0; r < REPETICOES; r++)
+        for (int i = 0; i < QTD_PARES; i++)
+            soma_regras += comparar_cartas_por_regras(a[i], b[i], vira[i]) == '>';
+    double ns_regras = registrar_benchmark(relatorio, "comparacao_regras", 0, (long long)REPETICOES * QTD_PARES, tempo_atual() - inicio);
+
+    inicio = tempo_atual();
+    for (int r = 0; r < REPETICOES; r++)
+        for (int i = 0; i < QTD_PARES; i++)
+            soma_tabela += comparar_cartas(a[i], b[i], vira[i]) > 0;
+    double ns_tabela = registrar_benchmark(relatorio, "comparacao_tabela", 0, (long long)REPETICOES * QTD_PARES, tempo_atual() - inicio);
+
+    printf("\n------ Benchmark de comparação ------\n");
+    printf("Regras: %6.2f ns/comparação (%.0f milhões/s)\n", ns_regras, 1e3 / ns_regras);
+    printf("Tabela: %6.2f ns/comparação (%.0f milhões/s)\n", ns_tabela, 1e3 / ns_tabela);
+    printf("Ganho: %.1fx (resultados %s)\n", ns_regras / ns_tabela, soma_regras == soma_tabela ? "iguais" : "DIFERENTES");
+    printf("-------------------------------------\n");
+}
+
+void executar_benchmark_motor(struct relatorio_benchmark *relatorio)
+{
+    enum
+    {
+        QTD_MAOS_PRONTAS = 1024,
+        REPETICOES_VAZA = 400000,
+        REPETICOES_MAO = 200000,
+        REPETICOES_PARTIDA = 20000
+    };
+    static struct estado_mao prontas[QTD_MAOS_PRONTAS];
+    struct jogador time_1[MAX_JOGADORES_TIME];
+    struct jogador time_2[MAX_JOGADORES_TIME];
+    struct partida partida;
+    long soma = 0; // Usa os resultados para que os laços não sejam descartados pelo compilador
+
+    for (int i = 0; i < MAX_JOGADORES_TIME; i++)
+    {
+        char nome[TAMANHO_NOME];
+        snprintf(nome, sizeof(nome), "Robô %d", 2 * i + 1);
+        time_1[i].nome = internar_nome(nome);
+        snprintf(nome, sizeof(nome), "Robô %d", 2 * i + 2);
+        time_2[i].nome = internar_nome(nome);
+        time_1[i].decidir = escolher_acao_aleatoria;
+        time_2[i].decidir = escolher_acao_aleatoria;
+    }
+
+    printf("\n------ Benchmark do motor ------\n");
+    printf("Jogadores | Vaza (ns) | Mão (ns) | Partida (us) | Partidas/s\n");
+    for (int numero_jogadores = 2; numero_jogadores <= 6; numero_jogadores += 2)
+    {
+        int qtd_jogadores_cada_time = numero_jogadores / 2;
+
+        // Vaza: copia uma mão já distribuída e joga a primeira carta de cada jogador até fechar a vaza
+        iniciar_partida(&partida, time_1, time_2, qtd_jogadores_cada_time, NULL, 1, 0);
+        for (int i = 0; i < QTD_MAOS_PRONTAS; i++)
+            iniciar_mao(&prontas[i], &partida);
+        double inicio = tempo_atual();
+        for (int r = 0; r < REPETICOES_VAZA; r++)
+        {
+            struct estado_mao mao = prontas[r % QTD_MAOS_PRONTAS];
+            enum resultado_acao resultado = ACAO_CONTINUA;
+            while (resultado == ACAO_CONTINUA)
+            {
+                struct acao acao = {ACAO_JOGAR_CARTA, primeira_carta(cartas_do_assento(&mao, assento_da_vez(&mao))), 0};
+                resultado = aplicar_acao(&mao, acao);
+            }
+            soma += mao.resultado_vaza;
+        }
+        double ns_vaza = registrar_benchmark(relatorio, "vaza", numero_jogadores, REPETICOES_VAZA, tempo_atual() - inicio);
+
+        // Mão: distribuição e todas as decisões dos robôs até o fim da mão
+        iniciar_partida(&partida, time_1, time_2, qtd_jogadores_cada_time, NULL, 1, 0);
+        inicio = tempo_atual();
+        for (int r = 0; r < REPETICOES_MAO; r++)
+        {
+            soma += jogar_mao(&partida);
+            partida.pontuacao_time_1 = 0;
+            partida.pontuacao_time_2 = 0;
+        }
+        double ns_mao = registrar_benchmark(relatorio, "mao_completa", numero_jogadores, REPETICOES_MAO, tempo_atual() - inicio);
+
+        // Partida: uma partida de 12 pontos por repetição, cada uma com sua semente
+        inicio = tempo_atual();
+        for (int r = 0; r < REPETICOES_PARTIDA; r++)
+        {
+            iniciar_partida(&partida, time_1, time_2, qtd_jogadores_cada_time, NULL, 1, (uint64_t)r);
+            soma += jogar_partida(&partida);
+        }
+        double ns_partida = registrar_benchmark(relatorio, "partida", numero_jogadores, REPETICOES_PARTIDA, tempo_atual() - inicio);
+
+        printf("%9d | %9.1f | %8.1f | %12.2f | %10.0f\n", numero_jogadores, ns_vaza, ns_mao, ns_partida / 1e3, 1e9 / ns_partida);
+    }
+    printf("(soma de controle: %ld)\n", soma);
+    printf("--------------------------------\n");
+}
+
+void executar_benchmark_lote(struct relatorio_benchmark *relatorio)
+{
+    enum
+    {
+        QTD_LOTES = 8192
+    };
+    static struct lote_maos lotes[QTD_LOTES];
+    uint8_t vencedores[PISTAS_LOTE];
+    struct baralho baralho;
+    struct gerador gerador;
+    long soma = 0; // Usa os resultados para que os laços não sejam descartados pelo compilador
+    long long divergencias = 0;
+    const char *caminho = "escalar";
+
+#ifdef AVALIADOR_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        caminho = "AVX2";
+#endif
+
+    montar_baralho(&baralho);
+    printf("\n------ Benchmark do avaliador em lote (%d pistas, %s) ------\n", PISTAS_LOTE, caminho);
+    printf("Jogadores | Carta a carta (ns) | Lote (ns) | Ganho | Maior primeiro (ns) | Com distribuição (ns)\n");
+    for (int numero_jogadores = 2; numero_jogadores <= 6; numero_jogadores += 2)
+    {
+        int qtd_jogadores_cada_time = numero_jogadores / 2;
+        long long qtd_maos = (long long)QTD_LOTES * PISTAS_LOTE;
+
+        // Distribuição e escolha das cartas fora da medição, que compara apenas a resolução das mãos
+        semear_gerador(&gerador, 1, (uint64_t)numero_jogadores);
+        double inicio = tempo_atual();
+        for (int l = 0; l < QTD_LOTES; l++)
+            distribuir_lote_maos(&lotes[l], qtd_jogadores_cada_time, POLITICA_LOTE_ALEATORIA, &baralho, &gerador);
+        double ns_distribuicao = (tempo_atual() - inicio) * 1e9 / (double)qtd_maos;
+
+        inicio = tempo_atual();
+        for (int l = 0; l < QTD_LOTES; l++)
+            for (int pista = 0; pista < PISTAS_LOTE; pista++)
+                soma += jogar_pista_do_lote(&lotes[l], pista);
+        double ns_carta = registrar_benchmark(relatorio, "mao_carta_a_carta", numero_jogadores, qtd_maos, tempo_atual() - inicio);
+
+        inicio = tempo_atual();
+        for (int l = 0; l < QTD_LOTES; l++)
+        {
+            resolver_lote_maos(&lotes[l], vencedores);
+            for (int pista = 0; pista < PISTAS_LOTE; pista++)
+                soma += vencedores[pista];
+        }
+        double ns_lote = registrar_benchmark(relatorio, "mao_lote", numero_jogadores, qtd_maos, tempo_atual() - inicio);
+
+        // Conferência: o lote precisa dar o mesmo vencedor que o motor em todas as pistas
+        for (int l = 0; l < QTD_LOTES; l++)
+        {
+            resolver_lote_maos(&lotes[l], vencedores);
+            for (int pista = 0; pista < PISTAS_LOTE; pista++)
+                divergencias += vencedores[pista] != jogar_pista_do_lote(&lotes[l], pista);
+        }
+
+        for (int l = 0; l < QTD_LOTES; l++)
+            distribuir_lote_maos(&lotes[l], qtd_jogadores_cada_time, POLITICA_LOTE_MAIOR_PRIMEIRO, &baralho, &gerador);
+        inicio = tempo_atual();
+        for (int l = 0; l < QTD_LOTES; l++)
+        {
+            resolver_lote_maos(&lotes[l], vencedores);
+            for (int pista = 0; pista < PISTAS_LOTE; pista++)
+                soma += vencedores[pista];
+        }
+        double ns_maior = registrar_benchmark(relatorio, "mao_lote_maior_primeiro", numero_jogadores, qtd_maos, tempo_atual() - inicio);
+        for (int l = 0; l < QTD_LOTES; l++)
+        {
+            resolver_lote_maos(&lotes[l], vencedores);
+            for (int pista = 0; pista < PISTAS_LOTE; pista++)
+                divergencias += vencedores[pista] != jogar_pista_do_lote(&lotes[l], pista);
+        }
+
+        printf("%9d | %18.1f | %9.2f | %4.0fx | %19.2f | %21.1f\n", numero_jogadores, ns_carta, ns_lote, ns_carta / ns_lote, ns_maior, ns_distribuicao + ns_lote);
+    }
+    printf("Conferência com o motor: %lld divergências\n", divergencias);
+    printf("(soma de controle: %ld)\n", soma);
+    printf("------------------------------------------------------\n");
+}
+
+bool gravar_benchmark_json(const struct relatorio_benchmark *relatorio, const char *caminho)
+{
+    FILE *arquivo = fopen(caminho, "w");
+    if (arquivo == NULL)
+    {
+        printf("Não foi possível gravar %s.\n", caminho);
+        return false;
+    }
+
+    fprintf(arquivo, "{\n  \"benchmarks\": [\n");
+    for (int i = 0; i < relatorio->qtd; i++)
+    {
+        const struct resultado_benchmark *resultado = &relatorio->resultados[i];
+        fprintf(arquivo, "    {\"nome\": \"%s\", \"jogadores\": %d, \"repeticoes\": %lld, \"ns_por_op\": %.3f, \"ops_por_s\": %.1f}%s\n",
+                resultado->nome, resultado->jogadores, resultado->repeticoes, resultado->ns_por_op,
+                1e9 / resultado->ns_por_op, i + 1 < relatorio->qtd ? "," : "");
+    }
+    fprintf(arquivo, "  ]\n}\n");
+
+    if (fclose(arquivo) != 0)
+    {
+        printf("Não foi possível gravar %s.\n", caminho);
+        return false;
+    }
+    printf("Resultados gravados em %s.\n", caminho);
+    return true;
+}
+
+bool vence_mao_ordenada(const uint8_t nossas[3], const uint8_t deles[3], bool comecamos)
+{
+    int vitorias_nos = 0, vitorias_eles = 0, valendo = 1, fez_primeira = 0;
+
+    for (int i = 0; i < 3; i++)
+    {
+        int resultado = nossas[i] - deles[i];
+        if (resultado == 0)
+        {
+            if (i == 0)
+                valendo = 2;
+            else
+            {
+                vitorias_nos++;
+                vitorias_eles++;
+            }
+        }
+        else if (resultado > 0)
+        {
+            vitorias_nos += valendo;
+            if (i == 0)
+                fez_primeira = 1;
+        }
+        else
+        {
+            vitorias_eles += valendo;
+            if (i == 0)
+                fez_primeira = 2;
+        }
+
+        if (vitorias_nos >= 2 && vitorias_eles >= 2)
+            return fez_primeira != 0 ? fez_primeira == 1 : comecamos;
+        if (vitorias_nos >= 2)
+            return true;
+        if (vitorias_eles >= 2)
+            return false;
+    }
+    return comecamos;
+}
+
+/**
+ * @brief Soma, para um trio de forças do adversário, o peso (quantas mãos reais o formam) das vitórias.
+ */
+static double pontuar_trio(const uint8_t nossas[3], uint8_t a, uint8_t b, uint8_t c, double peso)
+{
+    const uint8_t deles[3] = {a, b, c};
+    return peso * ((vence_mao_ordenada(nossas, deles, true) ? 0.5 : 0.0) + (vence_mao_ordenada(nossas, deles, false) ? 0.5 : 0.0));
+}
+
+double calcular_equidade(uint64_t mao, struct carta vira)
+{
+    const uint8_t *forcas = forcas_da_vira(vira);
+    int disponiveis[15] = {0}; // Cartas restantes por força (1 a 14)
+    uint8_t nossas[3];
+    int n = 0;
+
+    for (int c = 0; c < QTD_CARTAS_BARALHO; c++)
+    {
+        struct carta carta = {(uint8_t)c};
+        if (mao & bit_carta(carta))
+            nossas[n++] = forcas[c];
+        else if (!cartas_iguais(carta, vira))
+            disponiveis[forcas[c]]++;
+    }
+
+    // Ordena as nossas forças em ordem decrescente
+    for (int i = 0; i < 2; i++)
+        for (int j = i + 1; j < 3; j++)
+            if (nossas[j] > nossas[i])
+            {
+                uint8_t t = nossas[i];
+                nossas[i] = nossas[j];
+                nossas[j] = t;
+            }
+
+    // Percorre os trios de forças a >= b >= c do adversário, pesados pelo número de mãos reais
+    double vitorias = 0, total = 0;
+    for (int a = 14; a >= 1; a--)
+        for (int b = a; b >= 1; b--)
+            for (int c = b; c >= 1; c--)
+            {
+                double peso;
+                int na = disponiveis[a], nb = disponiveis[b], nc = disponiveis[c];
+                if (a == b && b == c)
+                    peso = na * (na - 1) * (na - 2) / 6.0;
+                else if (a == b)
+                    peso = na * (na - 1) / 2.0 * nc;
+                else if (b == c)
+                    peso = na * (nb * (nb - 1) / 2.0);
+                else
+                    peso = (double)na * nb * nc;
+                if (peso <= 0)
+                    continue;
+                vitorias += pontuar_trio(nossas, (uint8_t)a, (uint8_t)b, (uint8_t)c, peso);
+                total += peso;
+            }
+
+    return vitorias / total;
+}
+
+/**
+ * @brief Número de combinações C(n, k) para k de 1 a 3.
+ */
+static size_t combinacoes_ate_3(int n, int k)
+{
+    if (n < k)
+        return 0;
+    if (k == 1)
+        return (size_t)n;
+    if (k == 2)
+        return (size_t)n * (n - 1) / 2;
+    return (size_t)n * (n - 1) * (n - 2) / 6;
+}
+
+size_t indice_equidade(uint64_t mao, struct carta vira)
+{
+    int numero_vira = numero_carta(vira);
+    int naipe_vira = naipe_carta(vira);
+    int cartas[3];
+    int n = 0;
+
+    for (uint64_t resto = mao; resto != 0; resto &= resto - 1)
+    {
+        struct carta carta = primeira_carta(resto);
+        // Troca Ouros pelo naipe da vira nas cartas do número da vira
+        if (numero_carta(carta) == numero_vira)
+        {
+            int naipe = naipe_carta(carta);
+            naipe = naipe == naipe_vira ? 0 : (naipe == 0 ? naipe_vira : naipe);
+            carta = criar_carta(numero_vira, naipe);
+        }
+        cartas[n++] = carta.indice;
+    }
+
+    for (int i = 0; i < 2; i++)
+        for (int j = i + 1; j < 3; j++)
+            if (cartas[j] < cartas[i])
+            {
+                int t = cartas[i];
+                cartas[i] = cartas[j];
+                cartas[j] = t;
+            }
+
+    // Posição da combinação no sistema numérico combinatório
+    size_t posicao = combinacoes_ate_3(cartas[0], 1) + combinacoes_ate_3(cartas[1], 2) + combinacoes_ate_3(cartas[2], 3);
+    return (size_t)(numero_vira - 1) * QTD_MAOS_POSSIVEIS + posicao;
+}
+
+indice_distribuicao qtd_distribuicoes(int qtd_jogadores_cada_time)
+{
+    indice_distribuicao total = QTD_CARTAS_BARALHO;
+    for (int k = 0; k < 2 * qtd_jogadores_cada_time; k++)
+        total *= combinacoes_ate_3(QTD_CARTAS_BARALHO - 1 - 3 * k, 3);
+    return total;
+}
+
+/**
+ * @brief Posição de uma mão entre as combinações de 3 das cartas 'disponiveis', contando só as disponíveis.
+ */
+static size_t numerar_mao(uint64_t mao, uint64_t disponiveis)
+{
+    size_t posicao = 0;
+    int k = 1;
+    for (uint64_t resto = mao; resto != 0; resto &= resto - 1, k++)
+    {
+        int relativa = qtd_cartas(disponiveis & ((resto & -resto) - 1));
+        posicao += combinacoes_ate_3(relativa, k);
+    }
+    return posicao;
+}
+
+/**
+ * @brief A carta de ordem 'relativa' (a partir de 0) entre as 'disponiveis', como conjunto de um bit.
+ */
+static uint64_t carta_disponivel(uint64_t disponiveis, int relativa)
+{
+    for (; relativa > 0; relativa--)
+        disponiveis &= disponiveis - 1;
+    return disponiveis & -disponiveis;
+}
+
+/**
+ * @brief A mão de uma posição entre as combinações de 3 das cartas 'disponiveis', o inverso de 'numerar_mao'.
+ */
+static uint64_t gerar_mao(size_t posicao, uint64_t disponiveis)
+{
+    uint64_t mao = 0;
+    for (int k = 3; k >= 1; k--)
+    {
+        int relativa = k - 1;
+        while (combinacoes_ate_3(relativa + 1, k) <= posicao)
+            relativa++;
+        posicao -= combinacoes_ate_3(relativa, k);
+        mao |= carta_disponivel(disponiveis, relativa);
+    }
+    return mao;
+}
+
+indice_distribuicao numerar_distribuicao(const struct distribuicao *distribuicao)
+{
+    uint64_t disponiveis = BARALHO_COMPLETO & ~bit_carta(distribuicao->vira);
+    indice_distribuicao indice = distribuicao->vira.indice;
+
+    for (int k = 0; k < 2 * distribuicao->qtd_jogadores_cada_time; k++)
+    {
+        uint64_t mao = distribuicao->maos[k % 2][k / 2];
+        indice = indice * combinacoes_ate_3(qtd_cartas(disponiveis), 3) + numerar_mao(mao, disponiveis);
+        disponiveis &= ~mao;
+    }
+    return indice;
+}
+
+bool gerar_distribuicao(indice_distribuicao indice, int qtd_jogadores_cada_time, struct distribuicao *distribuicao)
+{
+    size_t posicoes[2 * MAX_JOGADORES_TIME];
+
+    // Os dígitos saem do menos significativo (a última mão) para o mais significativo (a vira)
+    for (int k = 2 * qtd_jogadores_cada_time - 1; k >= 0; k--)
+    {
+        size_t base = combinacoes_ate_3(QTD_CARTAS_BARALHO - 1 - 3 * k, 3);
+        posicoes[k] = (size_t)(indice % base);
+        indice /= base;
+    }
+    if (indice >= QTD_CARTAS_BARALHO)
+        return false;
+
+    distribuicao->qtd_jogadores_cada_time = qtd_jogadores_cada_time;
+    distribuicao->vira.indice = (uint8_t)indice;
+    uint64_t disponiveis = BARALHO_COMPLETO & ~bit_carta(distribuicao->vira);
+    for (int k = 0; k < 2 * qtd_jogadores_cada_time; k++)
+    {
+        distribuicao->maos[k % 2][k / 2] = gerar_mao(posicoes[k], disponiveis);
+        disponiveis &= ~distribuicao->maos[k % 2][k / 2];
+    }
+    return true;
+}
+
+/**
+ * @brief Próxima combinação de 3 das cartas 'disponiveis' na ordem colexicográfica (a de 'numerar_mao').
+ * @return Falso se 'mao' já era a última.
+ */
+static bool avancar_mao(uint64_t *mao, uint64_t disponiveis)
+{
+    uint64_t a = *mao & -*mao;
+    uint64_t b = (*mao & ~a) & -(*mao & ~a);
+    uint64_t c = *mao & ~a & ~b;
+    uint64_t depois_a = disponiveis & ~((a << 1) - 1), depois_b = disponiveis & ~((b << 1) - 1), depois_c = disponiveis & ~((c << 1) - 1);
+    uint64_t menores = disponiveis & (disponiveis - 1);
+
+    // Aumenta a menor carta que pode aumentar e volta as anteriores para as menores disponíveis
+    if ((depois_a & -depois_a) < b)
+        *mao = (depois_a & -depois_a) | b | c;
+    else if ((depois_b & -depois_b) < c)
+        *mao = (disponiveis & -disponiveis) | (depois_b & -depois_b) | c;
+    else if (depois_c != 0)
+        *mao = (disponiveis & -disponiveis) | (menores & -menores) | (depois_c & -depois_c);
+    else
+        return false;
+    return true;
+}
+
+/**
+ * @brief As 3 menores cartas de 'disponiveis': a primeira combinação na ordem de 'numerar_mao'.
+ */
+static uint64_t primeira_mao(uint64_t disponiveis)
+{
+    uint64_t mao = 0;
+    for (int k = 0; k < 3; k++)
+    {
+        mao |= disponiveis & -disponiveis;
+        disponiveis &= disponiveis - 1;
+    }
+    return mao;
+}
+
+bool avancar_distribuicao(struct distribuicao *distribuicao)
+{
+    int qtd_maos = 2 * distribuicao->qtd_jogadores_cada_time;
+    uint64_t disponiveis[2 * MAX_JOGADORES_TIME + 1]; // Cartas livres antes de cada mão
+
+    disponiveis[0] = BARALHO_COMPLETO & ~bit_carta(distribuicao->vira);
+    for (int k = 0; k < qtd_maos; k++)
+        disponiveis[k + 1] = disponiveis[k] & ~distribuicao->maos[k % 2][k / 2];
+
+    // Como um odômetro: a última mão que ainda pode avançar avança e as seguintes recomeçam
+    int k = qtd_maos - 1;
+    while (k >= 0 && !avancar_mao(&distribuicao->maos[k % 2][k / 2], disponiveis[k]))
+        k--;
+    if (k < 0)
+    {
+        if (distribuicao->vira.indice + 1 >= QTD_CARTAS_BARALHO)
+            return false;
+        distribuicao->vira.indice++;
+        disponiveis[0] = BARALHO_COMPLETO & ~bit_carta(distribuicao->vira);
+    }
+    for (int j = k + 1; j < qtd_maos; j++)
+    {
+        if (j > 0)
+            disponiveis[j] = disponiveis[j - 1] & ~distribuicao->maos[(j - 1) % 2][(j - 1) / 2];
+        distribuicao->maos[j % 2][j / 2] = primeira_mao(disponiveis[j]);
+    }
+    return true;
+}
+
+bool testar_numeracao_distribuicoes(void)
+{
+    struct gerador gerador;
+    bool ok = true;
+    semear_gerador(&gerador, 19, 0);
+
+    for (int qtd = 1; qtd <= MAX_JOGADORES_TIME; qtd++)
+    {
+        indice_distribuicao total = qtd_distribuicoes(qtd);
+        struct distribuicao distribuicao;
+
+        for (int n = 0; n < 2000; n++)
+        {
+            indice_distribuicao indice = n == 0 ? 0 : n == 1 ? total - 1 : ((indice_distribuicao)proximo_aleatorio(&gerador) << 64 | proximo_aleatorio(&gerador)) % total;
+            char texto[48];
+            escrever_indice_distribuicao(texto, indice);
+
+            if (!gerar_distribuicao(indice, qtd, &distribuicao) || numerar_distribuicao(&distribuicao) != indice)
+            {
+                printf("Numeração de distribuições (%d jogadores): o número %s não volta a ele mesmo.\n", 2 * qtd, texto);
+                ok = false;
+                continue;
+            }
+            bool avancou = avancar_distribuicao(&distribuicao);
+            if (avancou != (indice + 1 < total) || (avancou && numerar_distribuicao(&distribuicao) != indice + 1))
+            {
+                printf("Numeração de distribuições (%d jogadores): a seguinte a %s não é a de número seguinte.\n", 2 * qtd, texto);
+                ok = false;
+            }
+        }
+        if (gerar_distribuicao(total, qtd, &distribuicao))
+        {
+            printf("Numeração de distribuições (%d jogadores): um número fora da faixa foi aceito.\n", 2 * qtd);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void escrever_indice_distribuicao(char *destino, indice_distribuicao indice)
+{
+    char digitos[40];
+    int n = 0;
+    do
+    {
+        digitos[n++] = (char)('0' + (int)(indice % 10));
+        indice /= 10;
+    } while (indice != 0);
+    for (int i = 0; i < n; i++)
+        destino[i] = digitos[n - 1 - i];
+    destino[n] = '\0';
+}
 
-struct carta
+bool ler_indice_distribuicao(const char *texto, indice_distribuicao *indice)
 {
-    int numero; // O valor numérico da carta, correspondendo ao índice em SIMBOLOS.
-    int naipe;  // O naipe da carta, correspondendo ao índice em NAIPES.
+    const indice_distribuicao maximo = ~(indice_distribuicao)0;
+    *indice = 0;
+    if (*texto == '\0')
+        return false;
+    for (; *texto != '\0'; texto++)
+    {
+        if (*texto < '0' || *texto > '9' || *indice > (maximo - (indice_distribuicao)(*texto - '0')) / 10)
+            return false;
+        *indice = *indice * 10 + (indice_distribuicao)(*texto - '0');
+    }
+    return true;
+}
+
+struct contexto_distribuicoes
+{
+    struct distribuidor_trabalho distribuidor;
+    struct resultado_simulacao resultados[MAX_THREADS];
+    indice_distribuicao inicio; // Número da distribuição do item 0.
+    int numero_jogadores;
+    bool sem_memoria;
 };
 
-// ---
+static void tarefa_distribuicoes(int thread, void *contexto)
+{
+    struct contexto_distribuicoes *analise = contexto;
+    int qtd_jogadores_cada_time = analise->numero_jogadores / 2;
+    struct resolvedor *resolvedor = malloc(sizeof(*resolvedor));
+    struct jogador time_1[MAX_JOGADORES_TIME];
+    struct jogador time_2[MAX_JOGADORES_TIME];
+    struct resultado_simulacao *resultado = &analise->resultados[thread];
+    struct partida partida;
+    struct estado_mao mao;
+    struct distribuicao distribuicao;
+    long long inicio, fim;
 
-struct jogador
+    if (resolvedor == NULL)
+    {
+        analise->sem_memoria = true;
+        return;
+    }
+    for (int i = 0; i < qtd_jogadores_cada_time; i++)
+    {
+        time_1[i] = (struct jogador){internar_nome("Jogador"), escolher_acao_aleatoria, -1};
+        time_2[i] = time_1[i];
+    }
+
+    iniciar_resolvedor(resolvedor);
+    iniciar_partida(&partida, time_1, time_2, qtd_jogadores_cada_time, NULL, 0, 0);
+    while (pegar_lote(&analise->distribuidor, thread, &inicio, &fim))
+    {
+        // Só a primeira distribuição do lote é reconstruída pelo número; as outras vêm de 'avancar_distribuicao'
+        gerar_distribuicao(analise->inicio + (indice_distribuicao)inicio, qtd_jogadores_cada_time, &distribuicao);
+        for (long long n = inicio; n < fim; n++)
+        {
+            iniciar_mao_distribuida(&mao, &partida, &distribuicao);
+            resultado->vitorias[resolver_mao(resolvedor, &mao)]++;
+            resultado->partidas++;
+            avancar_distribuicao(&distribuicao);
+        }
+    }
+    resultado->maos += resolvedor->nos;
+    free(resolvedor);
+}
+
+bool analisar_distribuicoes(indice_distribuicao inicio, indice_distribuicao fim, int numero_jogadores, int qtd_threads)
 {
-    char nome[50];            // Nome do jogador.
-    struct carta mao[3];      // As 3 cartas que o jogador possui na mão.
-    int qtd_cartas_restantes; // Quantidade de cartas que o jogador ainda possui na mão.
-};
+    struct contexto_distribuicoes *analise;
+    indice_distribuicao total = qtd_distribuicoes(numero_jogadores / 2);
+    struct resultado_simulacao soma = {0};
+    char texto[3][40];
 
-// Protótipos das Funções
+    if (fim > total)
+        fim = total;
+    escrever_indice_distribuicao(texto[0], total);
+    if (inicio >= fim || fim - inicio > (indice_distribuicao)(INT64_MAX / 2))
+    {
+        printf("A faixa precisa estar dentro de [0, %s) e ter ao menos uma distribuição.\n", texto[0]);
+        return false;
+    }
+    analise = calloc(1, sizeof(*analise));
+    if (analise == NULL)
+    {
+        printf("Memória insuficiente para a análise.\n");
+        return false;
+    }
 
-/**
- * @brief Gera um número aleatório dentro de um intervalo específico, semeando o gerador uma vez.
- * @param max O valor máximo inclusivo.
- * @return Um número inteiro aleatório entre 0 e 'max'.
- */
-int gerar_numero_aleatorio(int max);
+    long long qtd = (long long)(fim - inicio);
+    analise->inicio = inicio;
+    analise->numero_jogadores = numero_jogadores;
+    iniciar_distribuidor(&analise->distribuidor, qtd, qtd_threads, TAMANHO_LOTE_PARTIDAS);
 
-/**
- * @brief Atribui um número aleatório à carta.
- * @param carta Um ponteiro para a estrutura 'carta'.
- */
-void sorteio_numero_carta(struct carta *carta);
+    double comeco = tempo_atual();
+    executar_em_paralelo(qtd_threads, tarefa_distribuicoes, analise);
+    double segundos = tempo_atual() - comeco;
 
-/**
- * @brief Atribui um naipe aleatório à carta.
- * @param carta Um ponteiro para a estrutura 'carta'.
- */
-void sorteio_naipe(struct carta *carta);
+    for (int t = 0; t < qtd_threads; t++)
+    {
+        soma.partidas += analise->resultados[t].partidas;
+        soma.vitorias[1] += analise->resultados[t].vitorias[1];
+        soma.vitorias[2] += analise->resultados[t].vitorias[2];
+        soma.maos += analise->resultados[t].maos;
+    }
+    bool sucesso = !analise->sem_memoria;
+    free(analise);
+    if (!sucesso)
+    {
+        printf("Memória insuficiente para o resolvedor.\n");
+        return false;
+    }
 
-/**
- * @brief Cria uma nova carta com número e naipe aleatórios.
- * @return A estrutura 'carta' criada.
- */
-struct carta criar_carta_aleatoria(void);
+    escrever_indice_distribuicao(texto[1], inicio);
+    escrever_indice_distribuicao(texto[2], fim);
+    printf("\n------ Distribuições resolvidas (informação perfeita) ------\n");
+    printf("Jogadores: %d | distribuições possíveis: %s\n", numero_jogadores, texto[0]);
+    printf("Faixa: [%s, %s), %lld distribuições\n", texto[1], texto[2], soma.partidas);
+    printf("Vence quem começa (Time 1): %lld (%.4f%%)\n", soma.vitorias[1], 100.0 * (double)soma.vitorias[1] / (double)soma.partidas);
+    printf("Estados por mão: %.1f\n", (double)soma.maos / (double)soma.partidas);
+    printf("Tempo: %.3f s (%.0f distribuições/s)\n", segundos, segundos > 0 ? (double)soma.partidas / segundos : 0.0);
+    printf("Continuar a partir de: %s\n", fim < total ? texto[2] : "fim (todas as distribuições foram analisadas)");
+    printf("------------------------------------------------------------\n");
+    return true;
+}
 
-/**
- * @brief Solicita ao usuário o nome de um jogador e o armazena.
- * @param jogador Um ponteiro para a estrutura 'jogador'.
- */
-void adicionar_nome_jogador(struct jogador *jogador);
+struct contexto_equidade
+{
+    struct distribuidor_trabalho distribuidor;
+    uint16_t *tabela;
+};
 
-/**
- * @brief Distribui 3 cartas aleatórias para a mão de um jogador.
- * @param jogador Um ponteiro para a estrutura 'jogador'.
- * @param cartas_em_jogo Um array das cartas já distribuídas ou em uso no jogo, para evitar repetições.
- * @param j Um ponteiro para o índice da próxima carta disponível em 'cartas_em_jogo'.
- */
-void distribuir_cartas_jogador(struct jogador *jogador, struct carta cartas_em_jogo[], int *j);
+static void tarefa_equidade(int thread, void *contexto)
+{
+    struct contexto_equidade *equidade = contexto;
+    long long inicio, fim;
 
-/**
- * @brief Adiciona jogadores a uma equipe, obtém seus nomes e distribui as cartas iniciais.
- * @param time Um array de estruturas 'jogador'.
- * @param quantidade_jogadores O número de jogadores na equipe.
- */
-void adicionar_equipe(struct jogador time[], int quantidade_jogadores);
+    // Cada item é uma vira e a maior carta da mão; as duas menores são enumeradas aqui
+    while (pegar_lote(&equidade->distribuidor, thread, &inicio, &fim))
+        for (long long item = inicio; item < fim; item++)
+        {
+            struct carta vira = criar_carta((int)(item / QTD_CARTAS_BARALHO) + 1, 0);
+            int maior = (int)(item % QTD_CARTAS_BARALHO);
+            for (int meio = 0; meio < maior; meio++)
+                for (int menor = 0; menor < meio; menor++)
+                {
+                    uint64_t mao = (1ULL << maior) | (1ULL << meio) | (1ULL << menor);
+                    if (mao & bit_carta(vira))
+                        continue;
+                    double valor = calcular_equidade(mao, vira);
+                    equidade->tabela[indice_equidade(mao, vira)] = (uint16_t)(valor * 65535.0 + 0.5);
+                }
+        }
+}
 
-/**
- * @brief Exibe uma única carta no formato "númeroNaipe".
- * @param carta A estrutura 'carta' a ser exibida.
- */
-void exibir_carta(struct carta carta);
+bool gerar_tabela_equidade(const char *caminho, int qtd_threads)
+{
+    struct cabecalho_equidade cabecalho = {"TRUCOEQ1", 10, QTD_MAOS_POSSIVEIS, 65535, 0};
+    struct contexto_equidade *equidade = calloc(1, sizeof(*equidade));
+    size_t qtd_entradas = (size_t)10 * QTD_MAOS_POSSIVEIS;
+    uint16_t *tabela = calloc(qtd_entradas, sizeof(uint16_t));
 
-/**
- * @brief Exibe todas as cartas na mão de um jogador.
- * @param mao Um array de estruturas 'carta' representando a mão.
- * @param qtd_cartas O número de cartas na mão.
- */
-void exibir_mao(struct carta mao[], int qtd_cartas);
+    if (equidade == NULL || tabela == NULL)
+    {
+        printf("Memória insuficiente para a tabela de equidade.\n");
+        free(equidade);
+        free(tabela);
+        return false;
+    }
 
-/**
- * @brief Exibe informações detalhadas de todos os jogadores em uma equipe.
- * @param time Um array de estruturas 'jogador'.
- * @param quantidade_jogadores O número de jogadores na equipe.
- */
-void exibir_time(struct jogador time[], int quantidade_jogadores);
+    double inicio = tempo_atual();
+    equidade->tabela = tabela;
+    iniciar_distribuidor(&equidade->distribuidor, 10 * QTD_CARTAS_BARALHO, qtd_threads, 1);
+    executar_em_paralelo(qtd_threads, tarefa_equidade, equidade);
+    double segundos = tempo_atual() - inicio;
 
-/**
- * @brief Exibe a equipe vencedora.
- * @param time Um array de estruturas 'jogador' representando a equipe vencedora.
- * @param quantidade_jogadores O número de jogadores na equipe vencedora.
- */
-void exibir_ganhador(struct jogador time[], int quantidade_jogadores);
+    FILE *arquivo = fopen(caminho, "wb");
+    bool gravou = arquivo != NULL &&
+                  fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+                  fwrite(tabela, sizeof(uint16_t), qtd_entradas, arquivo) == qtd_entradas;
+    if (arquivo != NULL && fclose(arquivo) != 0)
+        gravou = false;
 
-/**
- * @brief Exibe as pontuações finais de ambas as equipes.
- * @param pontuacao_time_1 A pontuação final da Equipe 1.
- * @param pontuacao_time_2 A pontuação final da Equipe 2.
- */
-void exibir_pontuacao_final(int pontuacao_time_1, int pontuacao_time_2);
+    if (gravou)
+        printf("Tabela de equidade gravada em %s (%zu mãos, %.2f s, %d threads).\n", caminho, qtd_entradas, segundos, qtd_threads);
+    else
+        printf("Não foi possível gravar %s.\n", caminho);
 
-/**
- * @brief Exibe as pontuações atuais de ambas as equipes durante a partida.
- * @param pontuacao_time_1 A pontuação atual da Equipe 1.
- * @param pontuacao_time_2 A pontuacao atual da Equipe 2.
- */
-void exibir_pontuacao_partida(int pontuacao_time_1, int pontuacao_time_2);
+    free(equidade);
+    free(tabela);
+    return gravou;
+}
 
 /**
- * @brief Gerencia a conclusão do jogo, anunciando o vencedor e as pontuações finais.
- * @param time_1 Array de 'jogador' para a Equipe 1.
- * @param time_2 Array de 'jogador' para a Equipe 2.
- * @param pontuacao_time_1 Pontuação final da Equipe 1.
- * @param pontuacao_time_2 Pontuação final da Equipe 2.
- * @param qtd_jagadores_cada_time Número de jogadores por equipe.
+ * @brief Avisa que o arquivo de uma tabela é inválido e libera os dados de 'mapear_tabela'.
+ * @return Sempre falso, para o carregador devolver.
  */
-void finalizar_jogo(struct jogador time_1[], struct jogador time_2[], int pontuacao_time_1, int pontuacao_time_2, int qtd_jagadores_cada_time);
+static bool rejeitar_tabela(const void *dados, size_t tamanho, const char *descricao, const char *caminho)
+{
+    printf("Arquivo %s inválido: %s\n", descricao, caminho);
+#ifdef _WIN32
+    (void)tamanho;
+    free((void *)dados);
+#else
+    munmap((void *)dados, tamanho);
+#endif
+    return false;
+}
 
 /**
- * @brief Gerencia a lógica principal de uma rodada de Truco.
+ * @brief Mapeia para a memória um arquivo de tabela de tamanho conhecido (no Windows, lê o arquivo inteiro).
  *
- * Esta função orquestra todas as etapas de uma rodada de Truco, desde a distribuição
- * das cartas até a determinação do vencedor e a atualização das pontuações.
+ * Os carregadores das tabelas conferem o resto do cabeçalho e, se ele não servir, chamam 'rejeitar_tabela'.
  *
- * @param time_1 Array de estruturas 'jogador' representando a Equipe 1.
- * @param time_2 Array de estruturas 'jogador' representando a Equipe 2.
- * @param qtd_jogadores_cada_time Número de jogadores em cada equipe (e.g., 1 para manilha, 2 para truco de dupla).
- * @param qtd_pontos_time1 Ponteiro para a pontuação atual da Equipe 1.
- * @param qtd_pontos_time2 Ponteiro para a pontuação atual da Equipe 2.
- * @param valor_partida Ponteiro para o valor atual em pontos da mão (e.g., 1, 3, 6, 9, 12).
- * @param vira Ponteiro para a carta "vira" da rodada, que define as manilhas.
- * @param aceitou_truco Ponteiro para um booleano que indica se a aposta de truco foi aceita.
- * @param time_que_pediu_truco Ponteiro para o identificador do time que pediu o truco (1 ou 2).
- * @param pontos_valendo Ponteiro para o número de pontos que a rodada está valendo no momento.
- * @param time_ganhador Ponteiro para o identificador do time que ganhou a rodada (1, 2 ou 0 para empate/não definido).
+ * @param caminho O arquivo.
+ * @param magica Os 8 bytes que abrem o cabeçalho.
+ * @param tamanho O tamanho exato do arquivo.
+ * @param descricao O nome da tabela nas mensagens, como "de equidade".
+ * @return Os dados do arquivo, ou NULL se ele não existe, tem outro tamanho ou não é uma tabela desse tipo.
  */
-void rodada_truco(struct jogador time_1[], struct jogador time_2[], int qtd_jogadores_cada_time, int *qtd_pontos_time1, int *qtd_pontos_time2, int *valor_partida, struct carta *vira, bool *aceitou_truco, int *time_que_pediu_truco, int *time_ganhador, int*pontos_valendo);
+static const void *mapear_tabela(const char *caminho, const char *magica, size_t tamanho, const char *descricao)
+{
+#ifdef _WIN32
+    // Sem mmap no Windows: lê o arquivo inteiro uma única vez
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL)
+        return NULL;
+    void *dados = malloc(tamanho);
+    bool leu = dados != NULL && fread(dados, 1, tamanho, arquivo) == tamanho;
+    fclose(arquivo);
+    if (!leu)
+    {
+        free(dados);
+        return NULL;
+    }
+#else
+    int descritor = open(caminho, O_RDONLY);
+    struct stat informacoes;
+    if (descritor < 0)
+        return NULL;
+    if (fstat(descritor, &informacoes) != 0 || (size_t)informacoes.st_size != tamanho)
+    {
+        close(descritor);
+        return NULL;
+    }
+    void *dados = mmap(NULL, tamanho, PROT_READ, MAP_SHARED, descritor, 0);
+    close(descritor);
+    if (dados == MAP_FAILED)
+        return NULL;
+#endif
 
-/**
- * @brief Solicita a um jogador que escolha uma carta para jogar.
- * @param jogador A estrutura 'jogador' do jogador atual.
- */
-void pedir_carta_jogar(struct jogador jogador);
+    if (memcmp(dados, magica, 8) != 0)
+    {
+        rejeitar_tabela(dados, tamanho, descricao, caminho);
+        return NULL;
+    }
+    return dados;
+}
 
-/**
- * @brief Retira uma carta da mão do jogador após ela ter sido jogada.
- * @param jogador Um ponteiro para a estrutura 'jogador'.
- * @param posicao_carta_jogada A posição (índice) da carta jogada na mão do jogador.
- */
-void retirar_carta_jogada(struct jogador *jogador, int posicao_carta_jogada);
+static const uint16_t *tabela_equidade = NULL; // Tabela mapeada do arquivo, ou NULL se não foi carregada.
 
-/**
- * @brief Lida com a jogada de uma carta por um jogador, incluindo a validação da entrada.
- * @param jogador Um ponteiro para a estrutura 'jogador'.
- * @return A estrutura 'carta' jogada pelo jogador.
- */
-struct carta jogar_carta(struct jogador *jogador);
+bool carregar_tabela_equidade(const char *caminho)
+{
+    size_t tamanho = sizeof(struct cabecalho_equidade) + (size_t)10 * QTD_MAOS_POSSIVEIS * sizeof(uint16_t);
+    const struct cabecalho_equidade *cabecalho = mapear_tabela(caminho, "TRUCOEQ1", tamanho, "de equidade");
+    if (cabecalho == NULL)
+        return false;
 
-/**
- * @brief Lógica para o pedido de 'truco', atualizando o valor da rodada.
- * @param qtd_pontos_valendo Ponteiro para o valor atual dos pontos da rodada.
- */
-void pedir_truco(int *qtd_pontos_valendo);
+    if (cabecalho->qtd_viras != 10 || cabecalho->qtd_maos != QTD_MAOS_POSSIVEIS)
+        return rejeitar_tabela(cabecalho, tamanho, "de equidade", caminho);
 
-/**
- * @brief Lógica para aceitar um pedido de truco.
- * @param aceitou_truco Ponteiro para um booleano que indica se o truco foi aceito.
- */
-void aceitar_truco(bool *aceitou_truco, struct jogador jogador_que_responde);
+    tabela_equidade = (const uint16_t *)(cabecalho + 1);
+    return true;
+}
 
-/**
- * @brief Permite que um jogador escolha entre jogar uma carta ou pedir truco.
- * @param jogador Um ponteiro para a estrutura 'jogador' do jogador atual.
- * @param valor_partida Ponteiro para o valor atual dos pontos em jogo na rodada.
- * @param vira A carta "vira" da rodada.
- * @param aceitou_truco Ponteiro para um booleano que indica se o truco foi aceito.
- * @param time_que_pediu_truco Ponteiro para o identificador do time que pediu truco (1 ou 2).
- * @param time_atual O identificador do time do jogador atual (1 ou 2).
- * @param proximo_jogador A estrutura 'jogador' do próximo jogador a jogar, utilizada para algumas lógicas de decisão.
- * @return A carta jogada pelo jogador, se ele escolher jogar.
- */
-struct carta escolher_acao(struct jogador *jogador, int *valor_partida, struct carta vira, bool *aceitou_truco, int *time_que_pediu_truco, int time_atual, struct jogador proximo_jogador);
+double equidade_mao(uint64_t mao, struct carta vira)
+{
+    if (tabela_equidade == NULL)
+        return -1;
+    return tabela_equidade[indice_equidade(mao, vira)] / 65535.0;
+}
 
 /**
- * @brief Aumenta o valor da aposta do truco na partida.
- * @param valor_partida Ponteiro para o valor atual dos pontos em jogo na rodada, que será incrementado.
+ * @brief Faixa de força das cartas de um jogador: 5 pela maior carta, mais 5 se a segunda também é um 2, um 3 ou uma manilha.
  */
-void aumentar_truco(int *valor_partida);
+static int faixa_forca_mao(uint64_t cartas, const uint8_t *forcas)
+{
+    uint8_t maior = 0, segunda = 0;
+
+    for (uint64_t resto = cartas; resto != 0; resto &= resto - 1)
+    {
+        uint8_t forca = forcas[primeira_carta(resto).indice];
+        if (forca > maior)
+        {
+            segunda = maior;
+            maior = forca;
+        }
+        else if (forca > segunda)
+            segunda = forca;
+    }
+
+    // Até o A, o 2, o 3, as manilhas de ouros e espadas e as de copas e paus
+    int faixa = maior >= 13 ? 4 : maior >= 11 ? 3 : maior == 10 ? 2 : maior == 9 ? 1 : 0;
+    return segunda >= 9 ? faixa + 5 : faixa;
+}
 
 /**
- * @brief Embaralha e distribui as cartas para os jogadores e define a carta "vira".
- * @param time_1 Array de 'jogador' para a Equipe 1.
- * @param time_2 Array de 'jogador' para a Equipe 2.
- * @param numero_jogadores_cada_time O número de jogadores em cada equipe.
- * @param cartas_em_jogo Um array para armazenar as cartas que estão em uso no jogo.
- * @param qtd_cartas O número total de cartas no baralho que será usado.
- * @param vira Ponteiro para a carta "vira" da rodada.
+ * @brief Estado de vaza de um time: a vaza atual (1 a 3) e se ele está atrás, empatado ou à frente nas vitórias.
  */
-void embaralhar(struct jogador time_1[], struct jogador time_2[], int numero_jogadores_cada_time, struct carta cartas_em_jogo[], int qtd_cartas, struct carta *vira);
+static int estado_vaza(const struct estado_mao *mao, int time)
+{
+    int saldo = time == 1 ? mao->vitorias_time1 - mao->vitorias_time2 : mao->vitorias_time2 - mao->vitorias_time1;
+    return (mao->rodadas_jogadas - 1) * 3 + (saldo < 0 ? 0 : saldo == 0 ? 1 : 2);
+}
 
 /**
- * @brief Compara o valor de duas cartas para determinar qual é a maior, considerando a carta "vira".
- * @param carta_maior A carta atualmente considerada a maior.
- * @param carta_jogada A carta que está sendo comparada.
- * @param vira A carta "vira" da rodada.
- * @return Um caractere indicando o resultado da comparação ('M' se carta_jogada for maior, 'm' se carta_maior for maior, 'E' se forem iguais).
+ * @brief Posição da primeira decisão de uma entrada na tabela de apostas.
+ * @param nivel O valor da mão antes do pedido: 0 para 1 ponto, 1 para 3, 2 para 6 e 3 para 9.
  */
-char comparar_cartas(struct carta carta_maior, struct carta carta_jogada, struct carta vira);
+static size_t indice_aposta(int qtd_jogadores_cada_time, int faixa, int vira, int estado, int nivel, int placar_nosso, int placar_deles)
+{
+    size_t indice = (size_t)(qtd_jogadores_cada_time - 1);
+    indice = indice * QTD_FAIXAS_FORCA + (size_t)faixa;
+    indice = indice * 10 + (size_t)vira;
+    indice = indice * QTD_ESTADOS_VAZA + (size_t)estado;
+    indice = indice * QTD_NIVEIS_APOSTA + (size_t)nivel;
+    indice = indice * PONTOS_PARA_VENCER + (size_t)placar_nosso;
+    indice = indice * PONTOS_PARA_VENCER + (size_t)placar_deles;
+    return indice * QTD_DECISOES_APOSTA;
+}
 
-void trocar_comeca(struct jogador time1[], struct jogador time2[], int posicao_nova, int time_novo, int qtd_jogadores);
+struct contagem_apostas
+{
+    long long vitorias[2][QTD_FAIXAS_FORCA][10][QTD_ESTADOS_VAZA]; // Mãos vencidas: [papel][faixa][vira][estado]; papel 0 pede, 1 responde.
+    long long amostras[2][QTD_FAIXAS_FORCA][10][QTD_ESTADOS_VAZA]; // Vezes em que cada situação apareceu.
+};
 
-/**
- * @brief Gera uma nova carta aleatória e a retorna se ela já não estiver presente no array de cartas em jogo.
- * @param nova_carta A carta que se deseja verificar e potencialmente substituir.
- * @param cartas_em_jogo Um array das cartas já distribuídas ou em uso no jogo.
- * @return Uma nova estrutura 'carta' que não é repetida.
- */
-struct carta troca_repetida(struct carta nova_carta, struct carta cartas_em_jogo[]);
+struct contexto_apostas
+{
+    struct distribuidor_trabalho distribuidor;
+    int qtd_jogadores_cada_time;
+    uint64_t semente;
+    struct contagem_apostas *contagens; // Uma por thread, somadas no final.
+};
+
+static void tarefa_apostas(int thread, void *contexto)
+{
+    struct contexto_apostas *apostas = contexto;
+    struct contagem_apostas *contagem = &apostas->contagens[thread];
+    int qtd_jogadores_cada_time = apostas->qtd_jogadores_cada_time;
+    struct jogador time_1[MAX_JOGADORES_TIME], time_2[MAX_JOGADORES_TIME];
+    long long *registros[4 * 3 * MAX_JOGADORES_TIME];
+    int times[4 * 3 * MAX_JOGADORES_TIME];
+    struct partida partida;
+    struct estado_mao mao;
+    long long inicio, fim;
+
+    for (int i = 0; i < qtd_jogadores_cada_time; i++)
+    {
+        time_1[i] = (struct jogador){"Robô", escolher_acao_cautelosa, -1};
+        time_2[i] = (struct jogador){"Robô", escolher_acao_cautelosa, -1};
+    }
+    iniciar_partida(&partida, time_1, time_2, qtd_jogadores_cada_time, NULL, apostas->semente, 0);
+
+    while (pegar_lote(&apostas->distribuidor, thread, &inicio, &fim))
+        for (long long item = inicio; item < fim; item++)
+        {
+            int vira, qtd = 0;
+
+            // Cada mão depende só de (semente, item), qualquer que seja a divisão entre as threads
+            semear_gerador(&partida.gerador, apostas->semente, (uint64_t)item);
+            partida.proximo_time = item % 2 == 0 ? 1 : 2;
+            iniciar_mao(&mao, &partida);
+            vira = numero_carta(mao.vira) - 1;
+
+            // Antes de cada carta, quem está na vez poderia pedir, e o próximo assento (do outro time) responderia
+            while (mao.time_vencedor == 0)
+            {
+                int assento = assento_da_vez(&mao);
+                for (int papel = 0; papel < 2; papel++)
+                {
+                    int quem = (assento + papel) % (2 * qtd_jogadores_cada_time);
+                    int time = time_do_assento(&mao, quem);
+                    int faixa = faixa_forca_mao(cartas_do_assento(&mao, quem), mao.forcas);
+                    int estado = estado_vaza(&mao, time);
+                    contagem->amostras[papel][faixa][vira][estado]++;
+                    registros[qtd] = &contagem->vitorias[papel][faixa][vira][estado];
+                    times[qtd++] = time;
+                }
+                aplicar_acao(&mao, escolher_acao_cautelosa(&mao, jogador_do_assento(&mao, assento)));
+            }
+            for (int i = 0; i < qtd; i++)
+                if (times[i] == mao.time_vencedor)
+                    (*registros[i])++;
+        }
+}
+
+bool gerar_tabela_apostas(const char *caminho, long long qtd_maos, uint64_t semente, int qtd_threads)
+{
+    struct cabecalho_apostas cabecalho = {"TRUCOAP1", 3, QTD_FAIXAS_FORCA, 10, QTD_ESTADOS_VAZA, QTD_NIVEIS_APOSTA, PONTOS_PARA_VENCER, QTD_DECISOES_APOSTA, 65535};
+    size_t qtd_entradas = indice_aposta(MAX_JOGADORES_TIME + 1, 0, 0, 0, 0, 0, 0);
+    struct contexto_apostas *apostas = calloc(1, sizeof(*apostas));
+    struct contagem_apostas *contagens = calloc((size_t)qtd_threads, sizeof(struct contagem_apostas));
+    uint16_t *tabela = calloc(qtd_entradas, sizeof(uint16_t));
+    double chances[2 * PONTOS_PARA_VENCER][2 * PONTOS_PARA_VENCER];
+
+    if (apostas == NULL || contagens == NULL || tabela == NULL)
+    {
+        printf("Memória insuficiente para a tabela de apostas.\n");
+        free(apostas);
+        free(contagens);
+        free(tabela);
+        return false;
+    }
+
+    // Chance de vencer a partida a partir de cada placar, supondo as próximas mãos de 1 ponto e equilibradas
+    for (int nosso = 2 * PONTOS_PARA_VENCER - 1; nosso >= 0; nosso--)
+        for (int deles = 2 * PONTOS_PARA_VENCER - 1; deles >= 0; deles--)
+        {
+            if (nosso >= PONTOS_PARA_VENCER)
+                chances[nosso][deles] = 1.0;
+            else if (deles >= PONTOS_PARA_VENCER)
+                chances[nosso][deles] = 0.0;
+            else
+                chances[nosso][deles] = 0.5 * (chances[nosso + 1][deles] + chances[nosso][deles + 1]);
+        }
+
+    double inicio = tempo_atual();
+    apostas->semente = semente;
+    apostas->contagens = contagens;
+    for (int qtd_jogadores_cada_time = 1; qtd_jogadores_cada_time <= MAX_JOGADORES_TIME; qtd_jogadores_cada_time++)
+    {
+        struct contagem_apostas soma = {0};
+
+        memset(contagens, 0, (size_t)qtd_threads * sizeof(struct contagem_apostas));
+        apostas->qtd_jogadores_cada_time = qtd_jogadores_cada_time;
+        iniciar_distribuidor(&apostas->distribuidor, qtd_maos, qtd_threads, TAMANHO_LOTE_PARTIDAS);
+        executar_em_paralelo(qtd_threads, tarefa_apostas, apostas);
+        for (int t = 0; t < qtd_threads; t++)
+            for (int papel = 0; papel < 2; papel++)
+                for (int faixa = 0; faixa < QTD_FAIXAS_FORCA; faixa++)
+                    for (int vira = 0; vira < 10; vira++)
+                        for (int estado = 0; estado < QTD_ESTADOS_VAZA; estado++)
+                        {
+                            soma.vitorias[papel][faixa][vira][estado] += contagens[t].vitorias[papel][faixa][vira][estado];
+                            soma.amostras[papel][faixa][vira][estado] += contagens[t].amostras[papel][faixa][vira][estado];
+                        }
+
+        for (int faixa = 0; faixa < QTD_FAIXAS_FORCA; faixa++)
+            for (int vira = 0; vira < 10; vira++)
+                for (int estado = 0; estado < QTD_ESTADOS_VAZA; estado++)
+                {
+                    // Chance de vencer a mão de quem pede e de quem responde; situações raras ficam perto de 1/2
+                    double pede = (soma.vitorias[0][faixa][vira][estado] + 1.0) / (soma.amostras[0][faixa][vira][estado] + 2.0);
+                    double responde = (soma.vitorias[1][faixa][vira][estado] + 1.0) / (soma.amostras[1][faixa][vira][estado] + 2.0);
+
+                    for (int nivel = 0; nivel < QTD_NIVEIS_APOSTA; nivel++)
+                        for (int nosso = 0; nosso < PONTOS_PARA_VENCER; nosso++)
+                            for (int deles = 0; deles < PONTOS_PARA_VENCER; deles++)
+                            {
+                                int valor = nivel == 0 ? 1 : 3 * nivel, novo = valor + (valor == 1 ? 2 : 3);
+                                double valores[QTD_DECISOES_APOSTA], aceito;
+
+                                // Sem novos pedidos até o fim da mão; quem recebe o pedido escolhe o que for pior para quem pediu
+                                valores[APOSTA_CONTINUAR] = pede * chances[nosso + valor][deles] + (1 - pede) * chances[nosso][deles + valor];
+                                aceito = pede * chances[nosso + novo][deles] + (1 - pede) * chances[nosso][deles + novo];
+                                valores[APOSTA_PEDIR] = aceito < chances[nosso + valor][deles] ? aceito : chances[nosso + valor][deles];
+                                valores[APOSTA_ACEITAR] = responde * chances[nosso + novo][deles] + (1 - responde) * chances[nosso][deles + novo];
+                                valores[APOSTA_RECUSAR] = chances[nosso][deles + valor];
+
+                                uint16_t *entrada = tabela + indice_aposta(qtd_jogadores_cada_time, faixa, vira, estado, nivel, nosso, deles);
+                                for (int d = 0; d < QTD_DECISOES_APOSTA; d++)
+                                    entrada[d] = (uint16_t)(valores[d] * 65535.0 + 0.5);
+                            }
+                }
+    }
+    double segundos = tempo_atual() - inicio;
+
+    FILE *arquivo = fopen(caminho, "wb");
+    bool gravou = arquivo != NULL &&
+                  fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+                  fwrite(tabela, sizeof(uint16_t), qtd_entradas, arquivo) == qtd_entradas;
+    if (arquivo != NULL && fclose(arquivo) != 0)
+        gravou = false;
+
+    if (gravou)
+        printf("Tabela de apostas gravada em %s (%zu entradas, %lld mãos por mesa, %.2f s, %d threads).\n",
+               caminho, qtd_entradas / QTD_DECISOES_APOSTA, qtd_maos, segundos, qtd_threads);
+    else
+        printf("Não foi possível gravar %s.\n", caminho);
+
+    free(apostas);
+    free(contagens);
+    free(tabela);
+    return gravou;
+}
+
+static const uint16_t *tabela_apostas = NULL; // Tabela mapeada do arquivo, ou NULL se não foi carregada.
+
+bool carregar_tabela_apostas(const char *caminho)
+{
+    size_t tamanho = sizeof(struct cabecalho_apostas) + indice_aposta(MAX_JOGADORES_TIME + 1, 0, 0, 0, 0, 0, 0) * sizeof(uint16_t);
+    const struct cabecalho_apostas *cabecalho = mapear_tabela(caminho, "TRUCOAP1", tamanho, "de apostas");
+    if (cabecalho == NULL)
+        return false;
+
+    if (cabecalho->qtd_mesas != 3 || cabecalho->qtd_faixas != QTD_FAIXAS_FORCA ||
+        cabecalho->qtd_viras != 10 || cabecalho->qtd_estados != QTD_ESTADOS_VAZA || cabecalho->qtd_niveis != QTD_NIVEIS_APOSTA ||
+        cabecalho->qtd_placares != PONTOS_PARA_VENCER || cabecalho->qtd_decisoes != QTD_DECISOES_APOSTA)
+        return rejeitar_tabela(cabecalho, tamanho, "de apostas", caminho);
+
+    tabela_apostas = (const uint16_t *)(cabecalho + 1);
+    return true;
+}
+
+bool consultar_apostas(const struct estado_mao *mao, int assento, double valores[QTD_DECISOES_APOSTA])
+{
+    if (tabela_apostas == NULL)
+        return false;
+
+    int time = time_do_assento(mao, assento);
+    int valor = mao->truco_pendente ? mao->valor_anterior : mao->valor_partida;
+    int nivel = valor >= 9 ? 3 : valor / 3;
+    int placar_nosso = mao->placar[time - 1], placar_deles = mao->placar[2 - time];
+    const uint16_t *entrada = tabela_apostas + indice_aposta(mao->qtd_jogadores_cada_time,
+                                                             faixa_forca_mao(cartas_do_assento(mao, assento), mao->forcas),
+                                                             numero_carta(mao->vira) - 1, estado_vaza(mao, time), nivel,
+                                                             placar_nosso < PONTOS_PARA_VENCER ? placar_nosso : PONTOS_PARA_VENCER - 1,
+                                                             placar_deles < PONTOS_PARA_VENCER ? placar_deles : PONTOS_PARA_VENCER - 1);
+    for (int d = 0; d < QTD_DECISOES_APOSTA; d++)
+        valores[d] = entrada[d] / 65535.0;
+    return true;
+}
+
+struct acao escolher_acao_tabela(const struct estado_mao *mao, const struct jogador *jogador)
+{
+    struct acao acao = {ACAO_JOGAR_CARTA, {0}, 0};
+    double valores[QTD_DECISOES_APOSTA];
+    int assento = assento_da_vez(mao);
+
+    if (!consultar_apostas(mao, assento, valores))
+        return escolher_acao_gulosa(mao, jogador);
+
+    if (mao->truco_pendente)
+    {
+        acao.tipo = valores[APOSTA_ACEITAR] >= valores[APOSTA_RECUSAR] ? ACAO_ACEITAR_TRUCO : ACAO_RECUSAR_TRUCO;
+        return acao;
+    }
+    if (valores[APOSTA_PEDIR] > valores[APOSTA_CONTINUAR] && pode_pedir_truco(mao, time_do_assento(mao, assento)))
+    {
+        acao.tipo = ACAO_PEDIR_TRUCO;
+        acao.valor = mao->valor_partida == 1 ? 3 : mao->valor_partida + 3;
+        return acao;
+    }
+
+    // As cartas saem como as do robô cauteloso, que nunca pede truco
+    return decidir_pela_forca(mao, 7, 3);
+}
 
 /**
- * @brief Verifica se uma dada carta já existe no array de cartas em jogo.
- * @param nova_carta A carta a ser verificada.
- * @param cartas_em_jogo Um array das cartas já distribuídas ou em uso no jogo.
- * @return Verdadeiro se a carta for repetida, Falso caso contrário.
+ * @brief Ações de um conjunto de informação do CFR: a carta (ou aceitar) e o pedido (ou recusar).
+ *
+ * As cartas são sempre as do robô cauteloso; o CFR só escolhe as apostas.
+ *
+ * @return 2 se o jogador escolhe uma aposta, ou 1 se ele só tem a carta a jogar.
  */
-bool eh_repetida(struct carta nova_carta, struct carta cartas_em_jogo[]);
+static int acoes_cfr(const struct estado_mao *mao, int assento, struct acao acoes[2])
+{
+    if (mao->truco_pendente)
+    {
+        acoes[0] = (struct acao){ACAO_ACEITAR_TRUCO, {0}, 0};
+        acoes[1] = (struct acao){ACAO_RECUSAR_TRUCO, {0}, 0};
+        return 2;
+    }
+    acoes[0] = decidir_pela_forca(mao, 7, 3);
+    if (!pode_pedir_truco(mao, time_do_assento(mao, assento)))
+        return 1;
+    acoes[1] = (struct acao){ACAO_PEDIR_TRUCO, {0}, mao->valor_partida == 1 ? 3 : mao->valor_partida + 3};
+    return 2;
+}
 
 /**
- * @brief Zera (limpa) um array de cartas, geralmente usado para reiniciar as cartas em jogo.
- * @param cartas Um ponteiro para o início do array de estruturas 'carta'.
- * @param qtd O número de cartas no array a serem zeradas.
+ * @brief Posição das duas ações do conjunto de informação do jogador de um assento nas tabelas do CFR.
+ *
+ * A abstração guarda o tamanho da mesa, a faixa de força das cartas, o estado de vaza, se a
+ * vaza atual está sem cartas, perdida ou ganha (ou empatada), o valor da mão antes do pedido,
+ * quem pediu por último (ninguém, o próprio time ou o adversário) e se há um pedido a responder.
  */
-void zerar_cartas_em_jogo(struct carta *cartas, int qtd);
+static size_t indice_cfr(const struct estado_mao *mao, int assento)
+{
+    int time = time_do_assento(mao, assento);
+    int jogadas = mao->jogadas_na_rodada;
+    bool nos_jogamos = time == mao->time_ganhador ? jogadas >= 1 : jogadas >= 2;
+    bool eles_jogaram = time == mao->time_ganhador ? jogadas >= 2 : jogadas >= 1;
+    uint8_t nossa = nos_jogamos ? (time == 1 ? mao->forca_maior_1 : mao->forca_maior_2) : 0;
+    uint8_t deles = eles_jogaram ? (time == 1 ? mao->forca_maior_2 : mao->forca_maior_1) : 0;
+    int valor = mao->truco_pendente ? mao->valor_anterior : mao->valor_partida;
+
+    size_t indice = (size_t)(mao->qtd_jogadores_cada_time - 1);
+    indice = indice * QTD_FAIXAS_FORCA + (size_t)faixa_forca_mao(cartas_do_assento(mao, assento), mao->forcas);
+    indice = indice * QTD_ESTADOS_VAZA + (size_t)estado_vaza(mao, time);
+    indice = indice * 3 + (size_t)(jogadas == 0 ? 0 : deles > nossa ? 1 : 2);
+    indice = indice * QTD_NIVEIS_APOSTA + (size_t)(valor >= 9 ? 3 : valor / 3);
+    indice = indice * 3 + (size_t)(mao->time_que_pediu_truco == NINGUEM_PEDIU_TRUCO ? 0 : mao->time_que_pediu_truco == time ? 1 : 2);
+    indice = indice * 2 + (size_t)mao->truco_pendente;
+    return indice * 2;
+}
+
+struct treino_cfr
+{
+    struct distribuidor_trabalho distribuidor;
+    _Atomic int32_t *arrependimentos;   // Arrependimento acumulado de cada ação, em pontos * ESCALA_CFR.
+    _Atomic uint32_t *contagens;        // Vezes em que cada ação foi sorteada pelo adversário de quem treina (a estratégia média).
+    uint64_t semente;
+    uint64_t primeira_iteracao;         // Iterações de execuções anteriores, lidas do checkpoint.
+    long long qtd_iteracoes;            // Iterações desta execução.
+    atomic_llong concluidas;            // Iterações desta execução já terminadas.
+    const char *caminho;
+    double segundos_checkpoint;
+    double inicio;
+    double ultimo_checkpoint;
+};
 
 /**
- * @brief Compara duas estruturas 'carta' para verificar se são idênticas (mesmo número e naipe).
- * @param primeira_carta A primeira estrutura 'carta' para comparação.
- * @param segunda_carta A segunda estrutura 'carta' para comparação.
- * @return Verdadeiro se as cartas forem iguais, Falso caso contrário.
+ * @brief Estratégia atual de um conjunto de informação por casamento de arrependimentos.
  */
-bool cartas_iguais(struct carta primeira_carta, struct carta segunda_carta);
+static void estrategia_cfr(_Atomic int32_t *arrependimentos, double estrategia[2])
+{
+    int32_t a = atomic_load_explicit(&arrependimentos[0], memory_order_relaxed);
+    int32_t b = atomic_load_explicit(&arrependimentos[1], memory_order_relaxed);
+    double positivo_a = a > 0 ? a : 0, positivo_b = b > 0 ? b : 0;
 
-void copiar_time(struct jogador timea[], struct jogador timeb[], int quantidade_de_jogadoores);
+    if (positivo_a + positivo_b <= 0)
+    {
+        estrategia[0] = estrategia[1] = 0.5;
+        return;
+    }
+    estrategia[0] = positivo_a / (positivo_a + positivo_b);
+    estrategia[1] = 1.0 - estrategia[0];
+}
 
 /**
- * @brief Função principal do programa.
+ * @brief Soma um arrependimento, limitado a [-LIMITE_ARREPENDIMENTO, LIMITE_ARREPENDIMENTO].
+ *
+ * As threads somam sem trava; um limite perdido por uma corrida só atrasa o corte até a próxima soma.
  */
-int main(void)
+static void somar_arrependimento(_Atomic int32_t *arrependimento, double valor)
 {
-    int pontuacao_time_1 = 0;
-    int pontuacao_time_2 = 0;
-    int numero_jogadores;
-    int qtd_jogadores_cada_time;
-
-    setlocale(LC_ALL, "Portuguese");
+    int32_t delta = (int32_t)lround(valor * ESCALA_CFR);
+    int32_t novo = atomic_fetch_add_explicit(arrependimento, delta, memory_order_relaxed) + delta;
 
-    printf("Bem-vindo ao jogo de Truco!\n");
-    printf("Por favor, informe o número de jogadores (2, 4 ou 6): ");
-    scanf("%d", &numero_jogadores);
+    if (novo > LIMITE_ARREPENDIMENTO)
+        atomic_store_explicit(arrependimento, LIMITE_ARREPENDIMENTO, memory_order_relaxed);
+    else if (novo < -LIMITE_ARREPENDIMENTO)
+        atomic_store_explicit(arrependimento, -LIMITE_ARREPENDIMENTO, memory_order_relaxed);
+}
 
-    while (getchar() != '\n')
-        ;
+/**
+ * @brief Percorre a mão com amostragem externa: abre todas as apostas do time treinado e sorteia as do adversário.
+ * @return Os pontos da mão para o time treinado (positivos se ele vence).
+ */
+static double percorrer_cfr(struct treino_cfr *treino, const struct estado_mao *mao, int time_treinado, struct gerador *gerador)
+{
+    struct acao acoes[2];
+    struct estado_mao filho;
+    double estrategia[2];
 
-    qtd_jogadores_cada_time = numero_jogadores / 2;
-    int qtd_carta = numero_jogadores * 3 + 1;
-    struct carta cartas_em_jogo[qtd_carta];
-    struct carta vira;
-    int rodada = 1;
-    int proximo_time = 1;
+    if (mao->time_vencedor != 0)
+        return mao->time_vencedor == time_treinado ? mao->valor_partida : -mao->valor_partida;
 
-    struct jogador time_1_jogadores[qtd_jogadores_cada_time];
-    struct jogador time_2_jogadores[qtd_jogadores_cada_time];
+    int assento = assento_da_vez(mao);
+    int qtd = acoes_cfr(mao, assento, acoes);
+    if (qtd == 1)
+    {
+        filho = *mao;
+        aplicar_acao(&filho, acoes[0]);
+        return percorrer_cfr(treino, &filho, time_treinado, gerador);
+    }
 
-    printf("\n--- Configurando o Time 1 ---\n");
-    adicionar_equipe(time_1_jogadores, qtd_jogadores_cada_time);
+    size_t indice = indice_cfr(mao, assento);
+    estrategia_cfr(&treino->arrependimentos[indice], estrategia);
 
-    printf("\n--- Configurando o Time 2 ---\n");
-    adicionar_equipe(time_2_jogadores, qtd_jogadores_cada_time);
+    if (time_do_assento(mao, assento) == time_treinado)
+    {
+        double valores[2], valor = 0;
+        for (int a = 0; a < 2; a++)
+        {
+            filho = *mao;
+            aplicar_acao(&filho, acoes[a]);
+            valores[a] = percorrer_cfr(treino, &filho, time_treinado, gerador);
+            valor += estrategia[a] * valores[a];
+        }
+        for (int a = 0; a < 2; a++)
+            somar_arrependimento(&treino->arrependimentos[indice + a], valores[a] - valor);
+        return valor;
+    }
 
-    struct jogador time_1_jogadores_original[qtd_jogadores_cada_time];
-    struct jogador time_2_jogadores_original[qtd_jogadores_cada_time];
+    // O adversário segue a estratégia atual, e o sorteio entra na estratégia média; a contagem é dividida por 2 antes de estourar
+    int escolhida = (double)(proximo_aleatorio(gerador) >> 11) * 0x1.0p-53 < estrategia[1];
+    if (atomic_fetch_add_explicit(&treino->contagens[indice + escolhida], 1, memory_order_relaxed) >= UINT32_MAX / 2)
+        for (int a = 0; a < 2; a++)
+            atomic_store_explicit(&treino->contagens[indice + a], atomic_load_explicit(&treino->contagens[indice + a], memory_order_relaxed) / 2, memory_order_relaxed);
+    filho = *mao;
+    aplicar_acao(&filho, acoes[escolhida]);
+    return percorrer_cfr(treino, &filho, time_treinado, gerador);
+}
 
-    copiar_time(time_1_jogadores_original, time_1_jogadores, qtd_jogadores_cada_time);
-    copiar_time(time_2_jogadores_original, time_2_jogadores, qtd_jogadores_cada_time);
+/**
+ * @brief Grava as tabelas do treino em um arquivo temporário e o renomeia, para que um checkpoint interrompido não estrague o anterior.
+ */
+static bool gravar_cfr(struct treino_cfr *treino, uint64_t iteracoes)
+{
+    struct cabecalho_cfr cabecalho = {"TRUCOCF1", QTD_CONJUNTOS_CFR, 2, ESCALA_CFR, 0, iteracoes};
+    size_t qtd = (size_t)QTD_CONJUNTOS_CFR * 2;
+    int32_t *arrependimentos = malloc(qtd * sizeof(int32_t));
+    uint32_t *contagens = malloc(qtd * sizeof(uint32_t));
+    char temporario[1024];
+    bool gravou = false;
 
-    // Loop principal do jogo (atualmente comentado, pois a lógica central do jogo não está implementada)
-    while (pontuacao_time_1 < 12 && pontuacao_time_2 < 12)
+    snprintf(temporario, sizeof(temporario), "%s.tmp", treino->caminho);
+    if (arrependimentos != NULL && contagens != NULL)
     {
-        printf("--------Geral--------");
-        exibir_pontuacao_final(pontuacao_time_1, pontuacao_time_2);
-
-        int valor_round = 1;
-        int pontos_valendo = 1;
-        int fez_primeira = 0;
-        int vitorias_time1 = 0;
-        int vitorias_time2 = 0;
-        int rodadas_jogadas = 1;
+        for (size_t i = 0; i < qtd; i++)
+        {
+            arrependimentos[i] = atomic_load_explicit(&treino->arrependimentos[i], memory_order_relaxed);
+            contagens[i] = atomic_load_explicit(&treino->contagens[i], memory_order_relaxed);
+        }
+        FILE *arquivo = fopen(temporario, "wb");
+        gravou = arquivo != NULL &&
+                 fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+                 fwrite(arrependimentos, sizeof(int32_t), qtd, arquivo) == qtd &&
+                 fwrite(contagens, sizeof(uint32_t), qtd, arquivo) == qtd;
+        if (arquivo != NULL && fclose(arquivo) != 0)
+            gravou = false;
+#ifdef _WIN32
+        if (gravou)
+            remove(treino->caminho);
+#endif
+        gravou = gravou && rename(temporario, treino->caminho) == 0;
+    }
+    if (!gravou)
+        printf("Não foi possível gravar %s.\n", treino->caminho);
+    free(arrependimentos);
+    free(contagens);
+    return gravou;
+}
 
-        embaralhar(time_1_jogadores, time_2_jogadores, qtd_jogadores_cada_time, cartas_em_jogo, qtd_carta, &vira);
+static void tarefa_cfr(int thread, void *contexto)
+{
+    struct treino_cfr *treino = contexto;
+    struct jogador time_1[MAX_JOGADORES_TIME], time_2[MAX_JOGADORES_TIME];
+    struct partida partidas[MAX_JOGADORES_TIME];
+    struct estado_mao mao;
+    long long inicio, fim;
 
-        bool aceitou_truco = false;
+    for (int i = 0; i < MAX_JOGADORES_TIME; i++)
+    {
+        time_1[i] = (struct jogador){"Robô", escolher_acao_cautelosa, -1};
+        time_2[i] = (struct jogador){"Robô", escolher_acao_cautelosa, -1};
+    }
+    for (int qtd_jogadores_cada_time = 1; qtd_jogadores_cada_time <= MAX_JOGADORES_TIME; qtd_jogadores_cada_time++)
+        iniciar_partida(&partidas[qtd_jogadores_cada_time - 1], time_1, time_2, qtd_jogadores_cada_time, NULL, treino->semente, 0);
 
-        int time_que_pediu_truco = NINGUEM_PEDIU_TRUCO;
+    while (pegar_lote(&treino->distribuidor, thread, &inicio, &fim))
+    {
+        for (long long item = inicio; item < fim; item++)
+        {
+            // As iterações se alternam entre os tamanhos de mesa, e cada distribuição treina os dois times
+            uint64_t iteracao = treino->primeira_iteracao + (uint64_t)item;
+            struct partida *partida = &partidas[iteracao % MAX_JOGADORES_TIME];
+            semear_gerador(&partida->gerador, treino->semente, iteracao);
+            partida->gerador_decisoes = partida->gerador;
+            saltar_gerador(&partida->gerador_decisoes);
+            partida->proximo_time = (iteracao / MAX_JOGADORES_TIME) % 2 == 0 ? 1 : 2;
+            iniciar_mao(&mao, partida);
+            percorrer_cfr(treino, &mao, 1, &partida->gerador_decisoes);
+            percorrer_cfr(treino, &mao, 2, &partida->gerador_decisoes);
+        }
+        long long concluidas = atomic_fetch_add_explicit(&treino->concluidas, fim - inicio, memory_order_relaxed) + (fim - inicio);
 
-        while (vitorias_time1 < 2 && vitorias_time2 < 2)
+        double agora = tempo_atual();
+        if (thread == 0 && agora - treino->ultimo_checkpoint >= treino->segundos_checkpoint)
         {
-            printf("-------------- Inicio da rodada interna %d-------------\n", rodadas_jogadas);
-            rodada_truco(time_1_jogadores, time_2_jogadores, qtd_jogadores_cada_time, &vitorias_time1, &vitorias_time2, &valor_round, &vira, &aceitou_truco, &time_que_pediu_truco, &proximo_time, &pontos_valendo);
+            treino->ultimo_checkpoint = agora;
+            if (gravar_cfr(treino, treino->primeira_iteracao + (uint64_t)concluidas))
+                printf("%5.1f%% | %lld iterações | %.0f iterações/s | checkpoint em %s\n",
+                       100.0 * (double)concluidas / (double)treino->qtd_iteracoes, concluidas,
+                       (double)concluidas / (agora - treino->inicio), treino->caminho);
+            fflush(stdout);
+        }
+    }
+}
 
-            exibir_pontuacao_final(vitorias_time1, vitorias_time2);
+bool treinar_cfr(const char *caminho, long long qtd_iteracoes, double segundos_checkpoint, uint64_t semente, int qtd_threads)
+{
+    size_t qtd = (size_t)QTD_CONJUNTOS_CFR * 2;
+    struct treino_cfr *treino = calloc(1, sizeof(*treino));
+    _Atomic int32_t *arrependimentos = calloc(qtd, sizeof(*arrependimentos));
+    _Atomic uint32_t *contagens = calloc(qtd, sizeof(*contagens));
 
-            if (vitorias_time1 == 2 && vitorias_time2 == 2)
-            {
-                if (fez_primeira == 1)
-                    pontuacao_time_1 += valor_round;
-                else
-                    pontuacao_time_2 += valor_round;
-            }
-            else if (vitorias_time1 == 2)
-                pontuacao_time_1 += valor_round;
-            else if (vitorias_time2 == 2)
-                pontuacao_time_2 += valor_round;
+    if (treino == NULL || arrependimentos == NULL || contagens == NULL)
+    {
+        printf("Memória insuficiente para o treino do CFR.\n");
+        free(treino);
+        free(arrependimentos);
+        free(contagens);
+        return false;
+    }
 
-            if (rodadas_jogadas == 1)
+    // Um checkpoint compatível no mesmo caminho é retomado de onde parou
+    FILE *anterior = fopen(caminho, "rb");
+    if (anterior != NULL)
+    {
+        struct cabecalho_cfr cabecalho;
+        int32_t *arrependimentos_lidos = malloc(qtd * sizeof(int32_t));
+        uint32_t *contagens_lidas = malloc(qtd * sizeof(uint32_t));
+        bool leu = arrependimentos_lidos != NULL && contagens_lidas != NULL &&
+                   fread(&cabecalho, sizeof(cabecalho), 1, anterior) == 1 &&
+                   memcmp(cabecalho.magica, "TRUCOCF1", 8) == 0 && cabecalho.qtd_conjuntos == QTD_CONJUNTOS_CFR &&
+                   cabecalho.qtd_acoes == 2 && cabecalho.escala == ESCALA_CFR &&
+                   fread(arrependimentos_lidos, sizeof(int32_t), qtd, anterior) == qtd &&
+                   fread(contagens_lidas, sizeof(uint32_t), qtd, anterior) == qtd;
+        fclose(anterior);
+        if (leu)
+        {
+            for (size_t i = 0; i < qtd; i++)
             {
-                if (vitorias_time1 == 1)
-                    fez_primeira = 1;
-                if (vitorias_time2 == 1)
-                    fez_primeira = 2;
+                atomic_init(&arrependimentos[i], arrependimentos_lidos[i]);
+                atomic_init(&contagens[i], contagens_lidas[i]);
             }
-            rodadas_jogadas++;
+            treino->primeira_iteracao = cabecalho.iteracoes;
+            printf("Retomando o treino de %s após %llu iterações.\n", caminho, (unsigned long long)cabecalho.iteracoes);
         }
-        rodada++;
-        if (rodada % 2 == 0)
+        free(arrependimentos_lidos);
+        free(contagens_lidas);
+        if (!leu)
         {
-            proximo_time = 2;
-            trocar_comeca(time_1_jogadores_original, time_2_jogadores_original, 0, 2, qtd_jogadores_cada_time);
+            printf("Arquivo de CFR inválido: %s\n", caminho);
+            free(treino);
+            free(arrependimentos);
+            free(contagens);
+            return false;
         }
-        else
-        {
-            proximo_time = 1;
-            trocar_comeca(time_2_jogadores_original, time_1_jogadores_original, 0, 2, qtd_jogadores_cada_time);
-        }
-        copiar_time(time_1_jogadores, time_1_jogadores_original, qtd_jogadores_cada_time);
-        copiar_time(time_2_jogadores, time_2_jogadores_original, qtd_jogadores_cada_time);
     }
 
-    finalizar_jogo(time_1_jogadores, time_2_jogadores, pontuacao_time_1, pontuacao_time_2, qtd_jogadores_cada_time);
+    treino->arrependimentos = arrependimentos;
+    treino->contagens = contagens;
+    treino->semente = semente;
+    treino->qtd_iteracoes = qtd_iteracoes;
+    treino->caminho = caminho;
+    treino->segundos_checkpoint = segundos_checkpoint;
+    treino->inicio = tempo_atual();
+    treino->ultimo_checkpoint = treino->inicio;
+    atomic_init(&treino->concluidas, 0);
+    printf("Treinando o CFR: %lld iterações, %d conjuntos de informação (%zu KB), %d threads.\n",
+           qtd_iteracoes, QTD_CONJUNTOS_CFR, qtd * (sizeof(int32_t) + sizeof(uint32_t)) / 1024, qtd_threads);
+    fflush(stdout);
 
-    printf("\n--- Fim do jogo ---\n");
+    iniciar_distribuidor(&treino->distribuidor, qtd_iteracoes, qtd_threads, TAMANHO_LOTE_PARTIDAS);
+    executar_em_paralelo(qtd_threads, tarefa_cfr, treino);
+    double segundos = tempo_atual() - treino->inicio;
 
-    return 0;
+    bool gravou = gravar_cfr(treino, treino->primeira_iteracao + (uint64_t)qtd_iteracoes);
+    if (gravou)
+    {
+        int visitados = 0;
+        for (int i = 0; i < QTD_CONJUNTOS_CFR; i++)
+            visitados += atomic_load_explicit(&contagens[2 * i], memory_order_relaxed) + atomic_load_explicit(&contagens[2 * i + 1], memory_order_relaxed) > 0;
+        printf("Estratégia gravada em %s (%llu iterações no total, %d de %d conjuntos visitados, %.2f s, %.0f iterações/s).\n",
+               caminho, (unsigned long long)(treino->primeira_iteracao + (uint64_t)qtd_iteracoes), visitados, QTD_CONJUNTOS_CFR,
+               segundos, segundos > 0 ? (double)qtd_iteracoes / segundos : 0.0);
+    }
+
+    free(treino);
+    free(arrependimentos);
+    free(contagens);
+    return gravou;
+}
+
+static const uint32_t *tabela_cfr = NULL; // Contagens da estratégia média mapeadas do arquivo, ou NULL se não foi carregado.
+
+bool carregar_tabela_cfr(const char *caminho)
+{
+    size_t tamanho = sizeof(struct cabecalho_cfr) + (size_t)QTD_CONJUNTOS_CFR * 2 * (sizeof(int32_t) + sizeof(uint32_t));
+    const struct cabecalho_cfr *cabecalho = mapear_tabela(caminho, "TRUCOCF1", tamanho, "de CFR");
+    if (cabecalho == NULL)
+        return false;
+
+    if (cabecalho->qtd_conjuntos != QTD_CONJUNTOS_CFR || cabecalho->qtd_acoes != 2 || cabecalho->escala != ESCALA_CFR)
+        return rejeitar_tabela(cabecalho, tamanho, "de CFR", caminho);
+
+    // Os arrependimentos só servem para retomar o treino; o robô usa as contagens da estratégia média
+    tabela_cfr = (const uint32_t *)((const int32_t *)(cabecalho + 1) + (size_t)QTD_CONJUNTOS_CFR * 2);
+    return true;
+}
+
+struct acao escolher_acao_cfr(const struct estado_mao *mao, const struct jogador *jogador)
+{
+    struct acao acoes[2];
+    int assento = assento_da_vez(mao);
+
+    if (tabela_cfr == NULL)
+        return escolher_acao_gulosa(mao, jogador);
+    if (acoes_cfr(mao, assento, acoes) == 1)
+        return acoes[0];
+
+    const uint32_t *contagens = tabela_cfr + indice_cfr(mao, assento);
+    double soma = (double)contagens[0] + contagens[1];
+    double segunda = soma > 0 ? contagens[1] / soma : 0.5;
+    return gerar_numero_aleatorio(mao->gerador, 65535) < segunda * 65536.0 ? acoes[1] : acoes[0];
 }
 
-int gerar_numero_aleatorio(int max)
+ESPECIALIZADA void embaralhar_fixa(uint64_t maos_1[], uint64_t maos_2[], struct baralho *baralho, struct gerador *gerador, struct carta *vira, const int qtd)
 {
-    if (!gerador_semeado)
+    INICIAR_MEDICAO(inicio);
+
+    // O baralho volta à ordem original para que a distribuição dependa só do estado do gerador
+    montar_baralho(baralho);
+    for (int i = 0; i < qtd; i++)
     {
-        srand((unsigned int)time(NULL));
-        gerador_semeado = 1;
+        distribuir_cartas_jogador(&maos_1[i], baralho, gerador);
+        distribuir_cartas_jogador(&maos_2[i], baralho, gerador);
     }
-    return (rand() % (max + 1));
+    *vira = comprar_carta(baralho, gerador);
+    ENCERRAR_MEDICAO(FASE_DISTRIBUICAO, inicio);
 }
 
-void sorteio_numero_carta(struct carta *carta)
+void embaralhar(uint64_t maos_1[], uint64_t maos_2[], int numero_jogadores_cada_time, struct baralho *baralho, struct gerador *gerador, struct carta *vira)
 {
-    carta->numero = gerar_numero_aleatorio(9) + 1;
+    embaralhar_fixa(maos_1, maos_2, baralho, gerador, vira, numero_jogadores_cada_time);
 }
 
-void sorteio_naipe(struct carta *carta)
+void embaralhar_por_sorteio(uint64_t maos_1[], uint64_t maos_2[], int numero_jogadores_cada_time, struct gerador *gerador, struct carta *vira)
 {
-    carta->naipe = gerar_numero_aleatorio(3);
+    INICIAR_MEDICAO(inicio);
+    uint64_t cartas_em_jogo = 0;
+    for (int i = 0; i < numero_jogadores_cada_time; i++)
+    {
+        distribuir_cartas_por_sorteio(&maos_1[i], &cartas_em_jogo, gerador);
+        distribuir_cartas_por_sorteio(&maos_2[i], &cartas_em_jogo, gerador);
+    }
+    *vira = troca_repetida(criar_carta_aleatoria(gerador), cartas_em_jogo, gerador);
+    ENCERRAR_MEDICAO(FASE_DISTRIBUICAO, inicio);
 }
 
-struct carta criar_carta_aleatoria(void)
+int comparar_cartas(struct carta a, struct carta b, struct carta vira)
 {
-    struct carta nova_carta;
-    sorteio_numero_carta(&nova_carta);
-    sorteio_naipe(&nova_carta);
-    return nova_carta;
+    CONTAR_FASE(FASE_COMPARACAO);
+    const uint8_t *forcas = forcas_da_vira(vira);
+    return forcas[a.indice] - forcas[b.indice];
 }
 
-void adicionar_nome_jogador(struct jogador *jogador)
+char comparar_cartas_por_regras(struct carta a, struct carta b, struct carta vira)
 {
-    printf("Digite o nome do jogador: ");
-    fgets(jogador->nome, sizeof(jogador->nome), stdin);
-    jogador->nome[strcspn(jogador->nome, "\n")] = '\0';
+    int manilha;
+    if (numero_carta(vira) == 10)
+    {
+        manilha = 1;
+    }
+    else
+    {
+        manilha = numero_carta(vira) + 1;
+    }
+
+    char resultado;
+    if (numero_carta(a) == manilha && numero_carta(b) == manilha)
+    {
+        if (naipe_carta(a) > naipe_carta(b))
+        {
+            resultado = '>';
+        }
+        else
+        {
+            resultado = '<';
+        }
+    }
+    else if (numero_carta(a) == manilha)
+    {
+        resultado = '>';
+    }
+    else if (numero_carta(b) == manilha)
+    {
+        resultado = '<';
+    }
+    else if (numero_carta(a) > numero_carta(b))
+    {
+        resultado = '>';
+    }
+    else if (numero_carta(b) > numero_carta(a))
+    {
+        resultado = '<';
+    }
+    else
+    {
+        resultado = '=';
+    }
+    return resultado;
 }
 
-void distribuir_cartas_jogador(struct jogador *jogador, struct carta cartas_em_jogo[], int *j)
+void distribuir_lote_maos(struct lote_maos *lote, int qtd_jogadores_cada_time, enum politica_lote politica, struct baralho *baralho, struct gerador *gerador)
 {
-    for (int i = 0; i < 3; i++)
+    // As 6 ordens de 3 cartas, sorteadas com um único número por jogador
+    static const uint8_t PERMUTACOES[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+    uint64_t maos[2][MAX_JOGADORES_TIME];
+    struct carta vira;
+
+    lote->qtd_jogadores_cada_time = qtd_jogadores_cada_time;
+    for (int pista = 0; pista < PISTAS_LOTE; pista++)
     {
-        struct carta nova = criar_carta_aleatoria();
-        nova = troca_repetida(nova, cartas_em_jogo);
-        jogador->mao[i] = nova;
-        cartas_em_jogo[*j] = nova;
-        (*j)++;
+        embaralhar(maos[0], maos[1], qtd_jogadores_cada_time, baralho, gerador, &vira);
+        lote->vira[pista] = vira.indice;
+        lote->time_que_iniciou[pista] = (uint8_t)(1 + gerar_numero_aleatorio(gerador, 1));
+
+        const uint8_t *forcas = forcas_da_vira(vira);
+        for (int t = 0; t < 2; t++)
+            for (int i = 0; i < qtd_jogadores_cada_time; i++)
+            {
+                uint8_t cartas[3];
+                uint64_t resto = maos[t][i];
+                for (int k = 0; k < 3; k++, resto &= resto - 1)
+                    cartas[k] = primeira_carta(resto).indice;
+
+                const uint8_t *ordem = PERMUTACOES[0];
+                if (politica == POLITICA_LOTE_ALEATORIA)
+                    ordem = PERMUTACOES[sortear_limitado(gerador, 6)];
+                else
+                {
+                    // Ordena as 3 cartas pela força, da maior para a menor
+                    uint8_t troca;
+                    if (forcas[cartas[0]] < forcas[cartas[1]])
+                        troca = cartas[0], cartas[0] = cartas[1], cartas[1] = troca;
+                    if (forcas[cartas[1]] < forcas[cartas[2]])
+                        troca = cartas[1], cartas[1] = cartas[2], cartas[2] = troca;
+                    if (forcas[cartas[0]] < forcas[cartas[1]])
+                        troca = cartas[0], cartas[0] = cartas[1], cartas[1] = troca;
+                }
+                for (int vaza = 0; vaza < 3; vaza++)
+                    lote->cartas[t][i][vaza][pista] = cartas[ordem[vaza]];
+            }
     }
-    jogador->qtd_cartas_restantes = 3;
 }
 
-void adicionar_equipe(struct jogador time[], int quantidade_jogadores)
+/**
+ * @brief Caminho pista a pista de 'resolver_lote_maos', com as mesmas operações do caminho AVX2.
+ */
+static void resolver_lote_maos_escalar(const struct lote_maos *lote, uint8_t vencedores[PISTAS_LOTE])
 {
-    for (int i = 0; i < quantidade_jogadores; i++)
+    for (int pista = 0; pista < PISTAS_LOTE; pista++)
     {
-        adicionar_nome_jogador(&time[i]);
+        int numero_vira = lote->vira[pista] >> 2;
+        int manilha = numero_vira == 9 ? 0 : numero_vira + 1; // Número - 1 da manilha
+        int vitorias_1 = 0, vitorias_2 = 0, valendo = 1, fez_primeira = 0, vencedor = 0;
+
+        for (int vaza = 0; vaza < 3 && vencedor == 0; vaza++)
+        {
+            int maior[2] = {0, 0};
+            for (int t = 0; t < 2; t++)
+                for (int i = 0; i < lote->qtd_jogadores_cada_time; i++)
+                {
+                    int carta = lote->cartas[t][i][vaza][pista];
+                    int forca = (carta >> 2) == manilha ? 11 + (carta & 3) : (carta >> 2) + 1;
+                    maior[t] = forca > maior[t] ? forca : maior[t];
+                }
+
+            // Mesmas regras de 'rodada_truco'
+            int resultado = maior[0] > maior[1] ? 1 : maior[1] > maior[0] ? 2 : 0;
+            if (vaza == 0)
+            {
+                valendo = resultado == 0 ? 2 : 1;
+                fez_primeira = resultado;
+                vitorias_1 = resultado == 1;
+                vitorias_2 = resultado == 2;
+            }
+            else
+            {
+                vitorias_1 += resultado == 1 ? valendo : resultado == 0;
+                vitorias_2 += resultado == 2 ? valendo : resultado == 0;
+            }
+
+            if (vitorias_1 >= 2 && vitorias_2 >= 2)
+                vencedor = fez_primeira != 0 ? fez_primeira : lote->time_que_iniciou[pista];
+            else if (vitorias_1 >= 2)
+                vencedor = 1;
+            else if (vitorias_2 >= 2)
+                vencedor = 2;
+        }
+        vencedores[pista] = (uint8_t)vencedor;
     }
 }
 
-void exibir_carta(struct carta carta)
+#ifdef AVALIADOR_AVX2
+/**
+ * @brief Caminho AVX2 de 'resolver_lote_maos': cada byte de um registrador é uma pista.
+ */
+__attribute__((target("avx2"))) static void resolver_lote_maos_avx2(const struct lote_maos *lote, uint8_t vencedores[PISTAS_LOTE])
 {
-    printf("%c%c ", SIMBOLOS[carta.numero], NAIPES[carta.naipe]);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i um = _mm256_set1_epi8(1);
+    const __m256i dois = _mm256_set1_epi8(2);
+    const __m256i tres = _mm256_set1_epi8(3);
+    const __m256i nove = _mm256_set1_epi8(9);
+    const __m256i onze = _mm256_set1_epi8(11);
+    const __m256i quinze = _mm256_set1_epi8(15);
+
+    // Não há deslocamento de bytes no AVX2: desloca palavras de 16 bits e descarta os bits que vieram do byte vizinho
+    __m256i numero_vira = _mm256_and_si256(_mm256_srli_epi16(_mm256_load_si256((const __m256i *)lote->vira), 2), quinze);
+    __m256i manilha = _mm256_andnot_si256(_mm256_cmpeq_epi8(numero_vira, nove), _mm256_add_epi8(numero_vira, um));
+    __m256i iniciou = _mm256_load_si256((const __m256i *)lote->time_que_iniciou);
+    __m256i vitorias_1 = zero, vitorias_2 = zero, valendo = um, fez_primeira = zero, vencedor = zero;
+
+    for (int vaza = 0; vaza < 3; vaza++)
+    {
+        __m256i maior[2] = {zero, zero};
+        for (int t = 0; t < 2; t++)
+            for (int i = 0; i < lote->qtd_jogadores_cada_time; i++)
+            {
+                __m256i carta = _mm256_load_si256((const __m256i *)lote->cartas[t][i][vaza]);
+                __m256i numero = _mm256_and_si256(_mm256_srli_epi16(carta, 2), quinze);
+                __m256i eh_manilha = _mm256_cmpeq_epi8(numero, manilha);
+                __m256i forca = _mm256_blendv_epi8(_mm256_add_epi8(numero, um), _mm256_add_epi8(_mm256_and_si256(carta, tres), onze), eh_manilha);
+                maior[t] = _mm256_max_epu8(maior[t], forca);
+            }
+
+        __m256i ganhou_1 = _mm256_cmpgt_epi8(maior[0], maior[1]);
+        __m256i ganhou_2 = _mm256_cmpgt_epi8(maior[1], maior[0]);
+        __m256i empate = _mm256_cmpeq_epi8(maior[0], maior[1]);
+        __m256i ativa = _mm256_cmpeq_epi8(vencedor, zero);
+        if (vaza == 0)
+        {
+            valendo = _mm256_blendv_epi8(um, dois, empate);
+            fez_primeira = _mm256_or_si256(_mm256_and_si256(ganhou_1, um), _mm256_and_si256(ganhou_2, dois));
+            vitorias_1 = _mm256_and_si256(ganhou_1, um);
+            vitorias_2 = _mm256_and_si256(ganhou_2, um);
+        }
+        else
+        {
+            __m256i empate_vale = _mm256_and_si256(empate, um);
+            vitorias_1 = _mm256_add_epi8(vitorias_1, _mm256_and_si256(ativa, _mm256_or_si256(_mm256_and_si256(ganhou_1, valendo), empate_vale)));
+            vitorias_2 = _mm256_add_epi8(vitorias_2, _mm256_and_si256(ativa, _mm256_or_si256(_mm256_and_si256(ganhou_2, valendo), empate_vale)));
+        }
+
+        __m256i fez_2_1 = _mm256_cmpgt_epi8(vitorias_1, um);
+        __m256i fez_2_2 = _mm256_cmpgt_epi8(vitorias_2, um);
+        __m256i desempate = _mm256_blendv_epi8(fez_primeira, iniciou, _mm256_cmpeq_epi8(fez_primeira, zero));
+        __m256i novo = _mm256_blendv_epi8(_mm256_and_si256(fez_2_2, dois), um, fez_2_1);
+        novo = _mm256_blendv_epi8(novo, desempate, _mm256_and_si256(fez_2_1, fez_2_2));
+        vencedor = _mm256_blendv_epi8(vencedor, novo, ativa);
+
+        // Termina assim que todas as pistas têm vencedor
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(vencedor, zero)) == 0)
+            break;
+    }
+    _mm256_storeu_si256((__m256i *)vencedores, vencedor);
 }
+#endif
 
-void exibir_mao(struct carta mao[], int qtd_cartas)
+void resolver_lote_maos(const struct lote_maos *lote, uint8_t vencedores[PISTAS_LOTE])
 {
-    printf("Mão: ");
-    for (int i = 0; i < qtd_cartas; i++)
+#ifdef AVALIADOR_AVX2
+    if (__builtin_cpu_supports("avx2"))
     {
-        exibir_carta(mao[i]);
+        resolver_lote_maos_avx2(lote, vencedores);
+        return;
     }
-    printf("\n");
+#endif
+    resolver_lote_maos_escalar(lote, vencedores);
 }
 
-void exibir_time(struct jogador time[], int quantidade_jogadores)
+int jogar_pista_do_lote(const struct lote_maos *lote, int pista)
 {
-    for (int i = 0; i < quantidade_jogadores; i++)
+    struct estado_jogo jogo;
+    int n = lote->qtd_jogadores_cada_time;
+
+    memset(&jogo, 0, sizeof(jogo));
+    for (int t = 0; t < 2; t++)
+        for (int i = 0; i < n; i++)
+            for (int vaza = 0; vaza < 3; vaza++)
+                jogo.maos[t][i] |= 1ULL << lote->cartas[t][i][vaza][pista];
+    jogo.qtd_jogadores_cada_time = (uint8_t)n;
+    jogo.vira = lote->vira[pista];
+    jogo.valor_partida = 1;
+    jogo.valor_anterior = 1;
+    jogo.time_que_pediu_truco = NINGUEM_PEDIU_TRUCO;
+    jogo.time_que_iniciou = lote->time_que_iniciou[pista];
+    jogo.time_ganhador = lote->time_que_iniciou[pista];
+    jogo.pontos_valendo = 1;
+    jogo.rodadas_jogadas = 1;
+
+    while (jogo.time_vencedor == 0)
     {
-        printf("--- Jogador: %s ---\n", time[i].nome);
+        int assento = assento_da_vez_jogo(&jogo);
+        int time = time_do_assento_jogo(&jogo, assento);
+        uint64_t mao = jogo.maos[time - 1][assento / 2];
+
+        // As posições giram a cada vaza; o dono da mão é quem ainda tem a carta que escolheu para esta vaza
+        int vaza = jogo.rodadas_jogadas - 1, jogador = 0;
+        while (jogador < n - 1 && (mao & 1ULL << lote->cartas[time - 1][jogador][vaza][pista]) == 0)
+            jogador++;
+        struct acao acao = {ACAO_JOGAR_CARTA, {lote->cartas[time - 1][jogador][vaza][pista]}, 0};
+        fazer_jogada(&jogo, acao, NULL);
     }
+    return jogo.time_vencedor;
 }
 
-void exibir_ganhador(struct jogador time[], int quantidade_jogadores)
+struct carta troca_repetida(struct carta nova_carta, uint64_t cartas_em_jogo, struct gerador *gerador)
 {
-    printf("\n--- Ganhador do Jogo ---\n");
-    exibir_time(time, quantidade_jogadores);
+    while (eh_repetida(nova_carta, cartas_em_jogo))
+    {
+        CONTAR_FASE(FASE_TROCA_REPETIDA);
+        nova_carta = criar_carta_aleatoria(gerador);
+    }
+    return nova_carta;
 }
 
-void exibir_pontuacao_final(int pontuacao_time_1, int pontuacao_time_2)
+bool eh_repetida(struct carta nova_carta, uint64_t cartas_em_jogo)
 {
-    printf("\n------ Pontuação Global ------\n");
-    printf("Time 1: %d pontos\n", pontuacao_time_1);
-    printf("Time 2: %d pontos\n", pontuacao_time_2);
-    printf("------------------------\n\n");
+    return (cartas_em_jogo & bit_carta(nova_carta)) != 0;
 }
 
-void exibir_pontuacao_partida(int pontuacao_time_1, int pontuacao_time_2)
+bool cartas_iguais(struct carta primeira_carta, struct carta segunda_carta)
 {
-    printf("\n------ Pontuação da Partida ------\n");
-    printf("Time 1: %d pontos\n", pontuacao_time_1);
-    printf("Time 2: %d pontos\n", pontuacao_time_2);
-    printf("------------------------\n\n");
+    return primeira_carta.indice == segunda_carta.indice;
 }
 
-void finalizar_jogo(struct jogador time_1[], struct jogador time_2[], int pontuacao_time_1, int pontuacao_time_2, int qtd_jagadores_cada_time)
+#ifdef __linux__
+
+static volatile sig_atomic_t servidor_interrompido = 0;
+
+static void interromper_servidor(int sinal)
 {
-    if (pontuacao_time_1 > pontuacao_time_2)
-        exibir_ganhador(time_1, qtd_jagadores_cada_time);
-    else
-        exibir_ganhador(time_2, qtd_jagadores_cada_time);
+    (void)sinal;
+    servidor_interrompido = 1;
+}
 
-    exibir_pontuacao_final(pontuacao_time_1, pontuacao_time_2);
+/**
+ * @brief Eleva o limite de descritores abertos até o máximo permitido e o retorna.
+ */
+static int elevar_limite_descritores(void)
+{
+    struct rlimit limite;
+    if (getrlimit(RLIMIT_NOFILE, &limite) != 0)
+        return 1024;
+    limite.rlim_cur = limite.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limite);
+    getrlimit(RLIMIT_NOFILE, &limite);
+    return limite.rlim_cur > 1 << 20 ? 1 << 20 : (int)limite.rlim_cur;
 }
 
-void rodada_truco(struct jogador time_1[], struct jogador time_2[], int qtd_jogadores_cada_time, int *qtd_pontos_time1, int *qtd_pontos_time2, int *valor_partida, struct carta *vira, bool *aceitou_truco, int *time_que_pediu_truco, int *time_ganhador, int *pontos_valendo)
+/**
+ * @brief Interpreta o endereço: só dígitos é uma porta TCP; qualquer outra coisa, o caminho de um socket Unix.
+ */
+static bool endereco_tcp(const char *endereco)
 {
+    if (*endereco == '\0')
+        return false;
+    for (const char *c = endereco; *c != '\0'; c++)
+        if (*c < '0' || *c > '9')
+            return false;
+    return true;
+}
 
-    struct carta carta_maior_1, carta_maior_2;
-    struct carta atual_1, atual_2;
-    int maior_posicao_1 = 0, maior_posicao_2 = 0;
+/**
+ * @brief Abre um socket no endereço: escutando, para o servidor, ou conectado, para o cliente.
+ * @return O descritor, já não bloqueante, ou -1 em caso de erro.
+ */
+static int abrir_socket(const char *endereco, bool escutar)
+{
+    int descritor;
 
-    // Jogadores jogam suas cartas
-    if (*time_ganhador == 2)
+    if (endereco_tcp(endereco))
     {
-        // Time 2 começa (ganhou a rodada anterior)
-        for (int i = 0; i < qtd_jogadores_cada_time; i++)
+        struct sockaddr_in tcp = {0};
+        int sim = 1;
+        tcp.sin_family = AF_INET;
+        tcp.sin_port = htons((uint16_t)atoi(endereco));
+        tcp.sin_addr.s_addr = htonl(escutar ? INADDR_ANY : INADDR_LOOPBACK);
+        descritor = socket(AF_INET, SOCK_STREAM, 0);
+        if (descritor < 0)
+            return -1;
+        if (escutar)
+            setsockopt(descritor, SOL_SOCKET, SO_REUSEADDR, &sim, sizeof(sim));
+        else
+            setsockopt(descritor, IPPROTO_TCP, TCP_NODELAY, &sim, sizeof(sim));
+        if ((escutar ? bind(descritor, (struct sockaddr *)&tcp, sizeof(tcp)) : connect(descritor, (struct sockaddr *)&tcp, sizeof(tcp))) != 0)
         {
-            atual_2 = escolher_acao(&time_2[i], valor_partida, *vira, aceitou_truco, time_que_pediu_truco, TIME_ADVERSARIO, i + 1 != qtd_jogadores_cada_time ? time_1[i] : time_1[0]);
-            atual_1 = escolher_acao(&time_1[i], valor_partida, *vira, aceitou_truco, time_que_pediu_truco, 1, i + 1 != qtd_jogadores_cada_time ? time_2[i] : time_2[0]);
-
-            // Verifica maior carta do time 2
-            if (i == 0 || comparar_cartas(atual_2, carta_maior_2, *vira) == '>')
-            {
-                carta_maior_2 = atual_2;
-                maior_posicao_2 = i;
-            }
-
-            // Verifica maior carta do time 1
-            if (i == 0 || comparar_cartas(atual_1, carta_maior_1, *vira) == '>')
-            {
-                carta_maior_1 = atual_1;
-                maior_posicao_1 = i;
-            }
+            close(descritor);
+            return -1;
         }
     }
     else
     {
-        // Time 1 começa (padrão ou ganhou a rodada anterior)
-        for (int i = 0; i < qtd_jogadores_cada_time; i++)
+        struct sockaddr_un unix_local = {0};
+        if (strlen(endereco) >= sizeof(unix_local.sun_path))
+            return -1;
+        unix_local.sun_family = AF_UNIX;
+        strcpy(unix_local.sun_path, endereco);
+        descritor = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (descritor < 0)
+            return -1;
+        if (escutar)
+            unlink(endereco);
+        if ((escutar ? bind(descritor, (struct sockaddr *)&unix_local, sizeof(unix_local)) : connect(descritor, (struct sockaddr *)&unix_local, sizeof(unix_local))) != 0)
         {
-            atual_1 = escolher_acao(&time_1[i], valor_partida, *vira, aceitou_truco, time_que_pediu_truco, 1, i + 1 != qtd_jogadores_cada_time ? time_2[i] : time_2[0]);
-            atual_2 = escolher_acao(&time_2[i], valor_partida, *vira, aceitou_truco, time_que_pediu_truco, TIME_ADVERSARIO, i + 1 != qtd_jogadores_cada_time ? time_1[i] : time_1[0]);
+            close(descritor);
+            return -1;
+        }
+    }
 
-            // Verifica maior carta do time 1
-            if (i == 0 || comparar_cartas(atual_1, carta_maior_1, *vira) == '>')
-            {
-                carta_maior_1 = atual_1;
-                maior_posicao_1 = i;
-            }
+    if (escutar && listen(descritor, SOMAXCONN) != 0)
+    {
+        close(descritor);
+        return -1;
+    }
+    fcntl(descritor, F_SETFL, fcntl(descritor, F_GETFL) | O_NONBLOCK);
+    return descritor;
+}
 
-            // Verifica maior carta do time 2
-            if (i == 0 || comparar_cartas(atual_2, carta_maior_2, *vira) == '>')
-            {
-                carta_maior_2 = atual_2;
-                maior_posicao_2 = i;
-            }
-        }
+/**
+ * @brief Escreve uma carta no formato do protocolo ("7O", "AP"...) e retorna quantos bytes usou.
+ */
+static int escrever_carta(char *destino, struct carta carta)
+{
+    destino[0] = SIMBOLOS[numero_carta(carta)];
+    destino[1] = NAIPES[naipe_carta(carta)];
+    destino[2] = '\0';
+    return 2;
+}
+
+/**
+ * @brief Lê uma carta no formato do protocolo; retorna falso se o texto não for uma carta.
+ */
+static bool ler_carta(const char *texto, struct carta *carta)
+{
+    const char *simbolo = memchr(SIMBOLOS + 1, texto[0], sizeof(SIMBOLOS) - 1);
+    const char *naipe = texto[0] != '\0' ? memchr(NAIPES, texto[1], sizeof(NAIPES)) : NULL;
+    if (simbolo == NULL || naipe == NULL || texto[1] == '\0')
+        return false;
+    *carta = criar_carta((int)(simbolo - SIMBOLOS), (int)(naipe - NAIPES));
+    return true;
+}
+
+/**
+ * @brief Acrescenta uma mensagem à saída da conexão; ela é enviada ao fim da volta do laço.
+ */
+static void enviar(struct servidor *servidor, int descritor, const char *formato, ...) __attribute__((format(printf, 3, 4)));
+
+static void enviar(struct servidor *servidor, int descritor, const char *formato, ...)
+{
+    struct conexao_servidor *conexao = &servidor->conexoes[descritor];
+    int livre = TAMANHO_SAIDA_CONEXAO - conexao->qtd_saida;
+    va_list argumentos;
+
+    if (!conexao->aberta)
+        return;
+
+    va_start(argumentos, formato);
+    int escritos = vsnprintf(conexao->saida + conexao->qtd_saida, (size_t)livre, formato, argumentos);
+    va_end(argumentos);
+
+    // Um cliente que não lê o que recebe é desconectado na próxima volta do laço
+    if (escritos < 0 || escritos >= livre)
+        conexao->qtd_saida = TAMANHO_SAIDA_CONEXAO;
+    else
+        conexao->qtd_saida += escritos;
+
+    if (!conexao->na_fila_envio)
+    {
+        conexao->na_fila_envio = true;
+        servidor->fila_envio[servidor->qtd_fila_envio++] = descritor;
     }
+}
+
+/**
+ * @brief Envia a mesma mensagem a todas as conexões de uma mesa.
+ */
+static void anunciar(struct servidor *servidor, const struct mesa_servidor *mesa, const char *mensagem)
+{
+    for (int i = 0; i < mesa->conectados; i++)
+        if (mesa->conexoes[i] >= 0)
+            enviar(servidor, mesa->conexoes[i], "%s", mensagem);
+}
+
+static void inserir_prazo(struct servidor *servidor, int indice)
+{
+    struct mesa_servidor *mesa = servidor->mesas[indice];
+
+    // Todos os prazos têm a mesma duração, então a mesa nova sempre vai para o fim da fila
+    mesa->prazo = tempo_atual() + servidor->segundos_por_turno;
+    mesa->prazo_anterior = servidor->ultimo_prazo;
+    mesa->prazo_proximo = -1;
+    mesa->na_fila_prazos = true;
+    if (servidor->ultimo_prazo >= 0)
+        servidor->mesas[servidor->ultimo_prazo]->prazo_proximo = indice;
+    else
+        servidor->primeiro_prazo = indice;
+    servidor->ultimo_prazo = indice;
+}
+
+static void remover_prazo(struct servidor *servidor, int indice)
+{
+    struct mesa_servidor *mesa = servidor->mesas[indice];
+    if (!mesa->na_fila_prazos)
+        return;
+    if (mesa->prazo_anterior >= 0)
+        servidor->mesas[mesa->prazo_anterior]->prazo_proximo = mesa->prazo_proximo;
+    else
+        servidor->primeiro_prazo = mesa->prazo_proximo;
+    if (mesa->prazo_proximo >= 0)
+        servidor->mesas[mesa->prazo_proximo]->prazo_anterior = mesa->prazo_anterior;
+    else
+        servidor->ultimo_prazo = mesa->prazo_anterior;
+    mesa->na_fila_prazos = false;
+}
+
+/**
+ * @brief Aplica a ação do jogador da vez e anuncia o efeito a todos na mesa.
+ * @return Falso se a ação era inválida (nada muda).
+ */
+static bool executar_acao_mesa(struct servidor *servidor, struct mesa_servidor *mesa, struct acao acao)
+{
+    int time = time_do_assento(&mesa->mao, assento_da_vez(&mesa->mao));
+    enum resultado_acao resultado = aplicar_acao(&mesa->mao, acao);
+    char mensagem[64];
 
-    // Determina o vencedor da rodada
-    char resultado = comparar_cartas(carta_maior_1, carta_maior_2, *vira);
+    if (resultado == ACAO_INVALIDA)
+        return false;
+    servidor->acoes++;
 
-    if (resultado == '=')
+    switch (acao.tipo)
     {
-        // Empate
-        if (*qtd_pontos_time1 == 0 && *qtd_pontos_time2 == 0)
-        {
-            *pontos_valendo = 2; // Empate na primeira rodada vale 2 pontos
-        }
-        else
-        {
-            (*qtd_pontos_time1)++;
-            (*qtd_pontos_time2)++;
-        }
-        printf("\n\n--------------------------------------------\n");
-        printf("   Empate entre %s (%c%c) e %s (%c%c)\n",
-               time_1[maior_posicao_1].nome, SIMBOLOS[carta_maior_1.numero], NAIPES[carta_maior_1.naipe],
-               time_2[maior_posicao_2].nome, SIMBOLOS[carta_maior_2.numero], NAIPES[carta_maior_2.naipe]);
-        printf("--------------------------------------------\n");
-    }
-    else if (resultado == '>')
+    case ACAO_JOGAR_CARTA:
     {
-        *qtd_pontos_time1 += *pontos_valendo;
-        // Time 1 ganhou
-        printf("\n\n----------------------------------\n");
-        printf("   Vitória de %s (%c%c)\n",
-               time_1[maior_posicao_1].nome, SIMBOLOS[carta_maior_1.numero], NAIPES[carta_maior_1.naipe]);
-        printf("----------------------------------\n");
-
-        // Atualiza times originais e troca ordem
-        if (*time_ganhador == 1)
-            trocar_comeca(time_1, time_2, maior_posicao_1, 1, qtd_jogadores_cada_time);
-        else
-            trocar_comeca(time_2, time_1, maior_posicao_1, 2, qtd_jogadores_cada_time);
-        *time_ganhador = 1;
+        char carta[3];
+        escrever_carta(carta, acao.carta);
+        snprintf(mensagem, sizeof(mensagem), "JOGOU %d %s\n", time, carta);
+        break;
     }
-    else
-    {
-        *qtd_pontos_time2 += *pontos_valendo;
-        // Time 2 ganhou
-        printf("\n\n----------------------------------\n");
-        printf("   Vitória de %s (%c%c)\n",
-               time_2[maior_posicao_2].nome, SIMBOLOS[carta_maior_2.numero], NAIPES[carta_maior_2.naipe]);
-        printf("----------------------------------\n");
-
-        // Atualiza times originais e troca ordem
-        if (*time_ganhador == 2)
-            trocar_comeca(time_2, time_1, maior_posicao_2, 1, qtd_jogadores_cada_time);
-        else
-            trocar_comeca(time_1, time_2, maior_posicao_2, 2, qtd_jogadores_cada_time);
-        *time_ganhador = 2;
+    case ACAO_PEDIR_TRUCO:
+        snprintf(mensagem, sizeof(mensagem), "TRUCO %d %d\n", time, acao.valor);
+        break;
+    case ACAO_ACEITAR_TRUCO:
+        snprintf(mensagem, sizeof(mensagem), "ACEITOU %d\n", time);
+        break;
+    default:
+        snprintf(mensagem, sizeof(mensagem), "CORREU %d\n", time);
+        break;
     }
+    anunciar(servidor, mesa, mensagem);
 
-    if (*time_que_pediu_truco == NINGUEM_PEDIU_TRUCO || (*time_que_pediu_truco == TIME_INICIANTE_PARTIDA && *aceitou_truco))
-        atual_2 = escolher_acao(&time_2[0], valor_partida, *vira, aceitou_truco, time_que_pediu_truco, TIME_ADVERSARIO, qtd_jogadores_cada_time > 1 ? time_1[1] : time_1[0]);
-    carta_maior_1 = atual_1;
-    carta_maior_2 = atual_2;
-    maior_posicao_1 = 0;
-    maior_posicao_2 = 0;
-    for (int i = 0; i < qtd_jogadores_cada_time; i++)
+    if (acao.tipo == ACAO_JOGAR_CARTA && resultado != ACAO_CONTINUA)
     {
-        if (*aceitou_truco || (!(*aceitou_truco) && *valor_partida == 1 && *time_que_pediu_truco == NINGUEM_PEDIU_TRUCO))
-        {
-            if (comparar_cartas(atual_1, carta_maior_1, *vira) == '>')
-            {
-                carta_maior_1 = atual_1;
-                maior_posicao_1 = i;
-            }
+        snprintf(mensagem, sizeof(mensagem), "VAZA %d\n", mesa->mao.resultado_vaza);
+        anunciar(servidor, mesa, mensagem);
+    }
+    return true;
+}
 
-            if (comparar_cartas(atual_2, carta_maior_2, *vira) == '>')
-            {
-                carta_maior_2 = atual_2;
-                maior_posicao_2 = i;
-            }
-            if (i + 1 < qtd_jogadores_cada_time)
-            {
-                atual_1 = escolher_acao(&time_1[i + 1], valor_partida, *vira, aceitou_truco, time_que_pediu_truco, TIME_INICIANTE_PARTIDA, time_2[i + 1]);
-                if (*time_que_pediu_truco == NINGUEM_PEDIU_TRUCO || (*time_que_pediu_truco == TIME_INICIANTE_PARTIDA && *aceitou_truco))
-                    atual_2 = escolher_acao(&time_2[i + 1], valor_partida, *vira, aceitou_truco, time_que_pediu_truco, TIME_ADVERSARIO, qtd_jogadores_cada_time > i + 2 ? time_1[i + 2] : time_1[0]);
-            }
-        }
-        else
+/**
+ * @brief Distribui uma nova mão e mostra a cada jogador remoto a vira e as suas cartas.
+ */
+static void comecar_mao_mesa(struct servidor *servidor, struct mesa_servidor *mesa)
+{
+    iniciar_mao(&mesa->mao, &mesa->partida);
+    for (int i = 0; i < mesa->mao.qtd_jogadores_cada_time; i++)
+    {
+        for (int k = 0; k < 2; k++)
         {
-            if (*time_que_pediu_truco == 1)
-                *qtd_pontos_time1 = 2;
-            else
-                *qtd_pontos_time2 = 2;
+            const struct jogador *jogador = &mesa->partida.jogadores[k][i];
+            if (jogador->decidir != NULL)
+                continue;
+            char vira[3], cartas[3][3];
+            int n = 0;
+            escrever_carta(vira, mesa->mao.vira);
+            for (uint64_t resto = mesa->mao.maos[k][i]; resto != 0; resto &= resto - 1)
+                escrever_carta(cartas[n++], primeira_carta(resto));
+            enviar(servidor, jogador->conexao, "MAO VIRA %s CARTAS %s %s %s\n", vira, cartas[0], cartas[1], cartas[2]);
         }
     }
+}
+
+static void encerrar_mesa(struct servidor *servidor, int indice)
+{
+    struct mesa_servidor *mesa = servidor->mesas[indice];
 
-    if (*time_que_pediu_truco == 1 && !(*aceitou_truco))
-        *qtd_pontos_time1 = 2;
-    if (*time_que_pediu_truco == 2 && !(*aceitou_truco))
-        *qtd_pontos_time2 = 2;
+    remover_prazo(servidor, indice);
+    for (int i = 0; i < mesa->conectados; i++)
+        if (mesa->conexoes[i] >= 0)
+            servidor->conexoes[mesa->conexoes[i]].mesa = -1;
+    if (mesa->em_andamento)
+        servidor->mesas_em_andamento--;
+    mesa->em_andamento = false;
+    mesa->conectados = 0;
+    servidor->mesas_livres[servidor->qtd_mesas_livres++] = indice;
+}
+
+/**
+ * @brief Faz os robôs jogarem até chegar a vez de um jogador remoto (a quem pede a jogada) ou o fim da partida.
+ */
+static void avancar_mesa(struct servidor *servidor, int indice)
+{
+    struct mesa_servidor *mesa = servidor->mesas[indice];
+    char mensagem[64];
 
-    if (*aceitou_truco || (!(*aceitou_truco) && *valor_partida == 1 && *time_que_pediu_truco == NINGUEM_PEDIU_TRUCO))
+    for (;;)
     {
-        resultado = comparar_cartas(carta_maior_1, carta_maior_2, *vira);
-        if (resultado == '=')
+        if (mesa->mao.time_vencedor != 0)
         {
-            if (*qtd_pontos_time1 == 0 && *qtd_pontos_time2 == 0)
-            {
-                *pontos_valendo = 2; // Empate na primeira rodada vale 2 pontos
-            }
-            else
+            int vencedor = encerrar_mao(&mesa->partida, &mesa->mao);
+            snprintf(mensagem, sizeof(mensagem), "FIM_MAO %d %d %d %d\n", vencedor, mesa->mao.valor_partida,
+                     mesa->partida.pontuacao_time_1, mesa->partida.pontuacao_time_2);
+            anunciar(servidor, mesa, mensagem);
+
+            if (mesa->partida.pontuacao_time_1 >= PONTOS_PARA_VENCER || mesa->partida.pontuacao_time_2 >= PONTOS_PARA_VENCER)
             {
-                (*qtd_pontos_time1)++;
-                (*qtd_pontos_time2)++;
+                snprintf(mensagem, sizeof(mensagem), "FIM %d\n", mesa->partida.pontuacao_time_1 >= PONTOS_PARA_VENCER ? 1 : 2);
+                anunciar(servidor, mesa, mensagem);
+                encerrar_mesa(servidor, indice);
+                return;
             }
-            printf("\n\n--------------------------------------------\n");
-            printf("   Empate entre %s (%c%c) e %s (%c%c)\n",
-                    time_1[maior_posicao_1].nome, SIMBOLOS[carta_maior_1.numero], NAIPES[carta_maior_1.naipe],
-                    time_2[maior_posicao_2].nome, SIMBOLOS[carta_maior_2.numero], NAIPES[carta_maior_2.naipe]);
-            printf("--------------------------------------------\n");
+            comecar_mao_mesa(servidor, mesa);
         }
-        else if (resultado == '>')
-        {
-            *qtd_pontos_time1 += *pontos_valendo;
-            // Time 1 ganhou
-            printf("\n\n----------------------------------\n");
-            printf("   Vitória de %s (%c%c)\n",
-                    time_1[maior_posicao_1].nome, SIMBOLOS[carta_maior_1.numero], NAIPES[carta_maior_1.naipe]);
-            printf("----------------------------------\n");
 
-            // Atualiza times originais e troca ordem
-            if (*time_ganhador == 1)
-                trocar_comeca(time_1, time_2, maior_posicao_1, 1, qtd_jogadores_cada_time);
-            else
-                trocar_comeca(time_2, time_1, maior_posicao_1, 2, qtd_jogadores_cada_time);
-            *time_ganhador = 1;
+        const struct jogador *jogador = jogador_do_assento(&mesa->mao, assento_da_vez(&mesa->mao));
+        if (jogador->decidir != NULL)
+        {
+            INICIAR_MEDICAO(inicio_decisao);
+            struct acao acao = jogador->decidir(&mesa->mao, jogador);
+            ENCERRAR_MEDICAO(FASE_DECISAO, inicio_decisao);
+            executar_acao_mesa(servidor, mesa, acao);
+            continue;
         }
+
+        // Vez de um jogador remoto: pede a jogada e espera até o prazo
+        if (mesa->mao.truco_pendente)
+            enviar(servidor, jogador->conexao, "VEZ RESPONDER %d\n", mesa->mao.valor_partida);
         else
         {
-            *qtd_pontos_time2 += *pontos_valendo;
-            // Time 2 ganhou
-            printf("\n\n----------------------------------\n");
-            printf("   Vitória de %s (%c%c)\n",
-                    time_2[maior_posicao_2].nome, SIMBOLOS[carta_maior_2.numero], NAIPES[carta_maior_2.naipe]);
-            printf("----------------------------------\n");
-
-            // Atualiza times originais e troca ordem
-            if (*time_ganhador == 2)
-                trocar_comeca(time_2, time_1, maior_posicao_2, 1, qtd_jogadores_cada_time);
-            else
-                trocar_comeca(time_1, time_2, maior_posicao_2, 2, qtd_jogadores_cada_time);
-            *time_ganhador = 2;
+            char cartas[3 * 3 + 1] = "";
+            int n = 0;
+            for (uint64_t resto = cartas_do_assento(&mesa->mao, assento_da_vez(&mesa->mao)); resto != 0; resto &= resto - 1)
+            {
+                cartas[n++] = ' ';
+                n += escrever_carta(cartas + n, primeira_carta(resto));
+            }
+            enviar(servidor, jogador->conexao, "VEZ JOGAR %d %d%s\n", mesa->mao.valor_partida,
+                   pode_pedir_truco(&mesa->mao, time_do_assento(&mesa->mao, assento_da_vez(&mesa->mao))) ? 1 : 0, cartas);
         }
+        inserir_prazo(servidor, indice);
+        return;
     }
 }
 
-void pedir_carta_jogar(struct jogador jogador)
+/**
+ * @brief Começa a partida de uma mesa completa: os lugares sem conexão ficam com o robô do servidor.
+ */
+static void comecar_partida_mesa(struct servidor *servidor, int indice)
 {
-    printf("Qual carta deseja jogar?: \n");
-    for (int i = 0; i < jogador.qtd_cartas_restantes; i++)
-        printf("Para carta %c%c digite - %d\n", SIMBOLOS[jogador.mao[i].numero], NAIPES[jogador.mao[i].naipe], i + 1);
-}
+    struct mesa_servidor *mesa = servidor->mesas[indice];
+    struct jogador time_1[MAX_JOGADORES_TIME];
+    struct jogador time_2[MAX_JOGADORES_TIME];
+    int qtd_jogadores_cada_time = mesa->numero_jogadores / 2;
 
-void retirar_carta_jogada(struct jogador *jogador, int posicao_carta_jogada)
-{
-    if (posicao_carta_jogada >= 0 && posicao_carta_jogada < jogador->qtd_cartas_restantes)
+    for (int lugar = 0; lugar < mesa->numero_jogadores; lugar++)
     {
-        // Passo 1: Trocar o valor da posição a ser removida
-        // pelo valor do último elemento válido.
-        // Isso simula a "remoção" sem deixar uma lacuna e sem mudar a ordem dos demais.
-        jogador->mao[posicao_carta_jogada] = jogador->mao[jogador->qtd_cartas_restantes - 1];
-
-        // Passo 2: Reduzir o tamanho lógico do array.
-        // O último elemento agora está na posição removida e não precisamos mais do duplicado.
-        jogador->qtd_cartas_restantes--;
+        struct jogador *jogador = lugar % 2 == 0 ? &time_1[lugar / 2] : &time_2[lugar / 2];
+        int conexao = lugar < mesa->conectados ? mesa->conexoes[lugar] : -1;
+        jogador->conexao = conexao;
+        jogador->decidir = conexao >= 0 ? NULL : servidor->robo;
+        char nome[TAMANHO_NOME];
+        snprintf(nome, sizeof(nome), conexao >= 0 ? "Remoto %d" : "Robô %d", lugar + 1);
+        jogador->nome = internar_nome(nome);
     }
+
+    iniciar_partida(&mesa->partida, time_1, time_2, qtd_jogadores_cada_time, NULL, servidor->semente, (uint64_t)servidor->partidas_iniciadas++);
+    mesa->em_andamento = true;
+    servidor->mesas_em_andamento++;
+
+    for (int lugar = 0; lugar < mesa->conectados; lugar++)
+        enviar(servidor, mesa->conexoes[lugar], "MESA %d %d TIME %d\n", indice, mesa->numero_jogadores, lugar % 2 + 1);
+    comecar_mao_mesa(servidor, mesa);
+    avancar_mesa(servidor, indice);
 }
 
-struct carta jogar_carta(struct jogador *jogador)
+/**
+ * @brief Coloca a conexão na mesa que espera jogadores com a mesma configuração, ou em uma mesa nova.
+ */
+static void entrar_mesa(struct servidor *servidor, int descritor, int numero_jogadores, int humanos)
 {
-    int posicao_carta;
-    do
+    int indice = servidor->aguardando[numero_jogadores][humanos];
+
+    if (indice < 0)
     {
-        pedir_carta_jogar(*jogador); // Exibe as opções
-        scanf("%d", &posicao_carta);
-        if (posicao_carta < 1 || posicao_carta > jogador->qtd_cartas_restantes)
+        if (servidor->qtd_mesas_livres > 0)
+            indice = servidor->mesas_livres[--servidor->qtd_mesas_livres];
+        else
         {
-            printf("Valor inválido, digite novamente se atentando a ele.\n");
-            // Limpa o buffer de entrada
-            while (getchar() != '\n')
-                ;
+            struct mesa_servidor **mesas = realloc(servidor->mesas, (size_t)(servidor->qtd_mesas + 1) * sizeof(*mesas));
+            int *livres = realloc(servidor->mesas_livres, (size_t)(servidor->qtd_mesas + 1) * sizeof(*livres));
+            struct mesa_servidor *nova = malloc(sizeof(*nova));
+            if (mesas != NULL)
+                servidor->mesas = mesas;
+            if (livres != NULL)
+                servidor->mesas_livres = livres;
+            if (mesas == NULL || livres == NULL || nova == NULL)
+            {
+                free(nova);
+                enviar(servidor, descritor, "ERRO servidor sem memória\n");
+                return;
+            }
+            indice = servidor->qtd_mesas++;
+            servidor->mesas[indice] = nova;
         }
-    } while (posicao_carta < 1 || posicao_carta > jogador->qtd_cartas_restantes);
-
-    struct carta carta_jogada = jogador->mao[posicao_carta - 1];
-
-    retirar_carta_jogada(jogador, posicao_carta - 1);
+        struct mesa_servidor *mesa = servidor->mesas[indice];
+        mesa->numero_jogadores = numero_jogadores;
+        mesa->humanos = humanos;
+        mesa->conectados = 0;
+        mesa->em_andamento = false;
+        mesa->na_fila_prazos = false;
+        servidor->aguardando[numero_jogadores][humanos] = indice;
+    }
 
-    return carta_jogada; // Ajusta para índice de array baseado em 0
-}
+    struct mesa_servidor *mesa = servidor->mesas[indice];
+    struct conexao_servidor *conexao = &servidor->conexoes[descritor];
+    conexao->mesa = indice;
+    conexao->time = mesa->conectados % 2 + 1;
+    mesa->conexoes[mesa->conectados++] = descritor;
 
-void pedir_truco(int *qtd_pontos_valendo)
-{
-    printf("Quanto deseja pedir: 3, 6, 9 ou 12?\n");
-    scanf("%d", qtd_pontos_valendo);
-    while (*qtd_pontos_valendo != 3 && *qtd_pontos_valendo != 6 && *qtd_pontos_valendo != 9 && *qtd_pontos_valendo != 12)
+    if (mesa->conectados < mesa->humanos)
     {
-        printf("Você inseriu um valor inválido, os valores válidos são 3, 6, 9 ou 12\n");
-        scanf("%d", qtd_pontos_valendo);
+        enviar(servidor, descritor, "AGUARDANDO %d %d %d\n", indice, mesa->conectados, mesa->humanos);
+        return;
     }
+    servidor->aguardando[numero_jogadores][humanos] = -1;
+    comecar_partida_mesa(servidor, indice);
 }
 
-void aceitar_truco(bool *aceitou_truco, struct jogador jogador_que_responde)
+/**
+ * @brief Fecha uma conexão; se ela estava em uma partida, um robô assume o seu lugar.
+ */
+static void fechar_conexao(struct servidor *servidor, int descritor)
 {
-    printf("\n\n--------------------------------------\n");
-    printf("----------Vez de %s----------\n", jogador_que_responde.nome);
-    printf("Deseja aceitar o truco? (S ou N):\n");
-    char resposta = 'A';
-    scanf(" %c", &resposta);
-    while (resposta != 'S' && resposta != 'N' && resposta != 's' && resposta != 'n')
-    {
-        printf("Valor indesejado, digite novamente!!\n");
-        printf("Deseja aceitar o truco? (S ou N):\n");
-        scanf("%c", &resposta);
-    }
-    *aceitou_truco = (resposta == 'S' || resposta == 's');
-}
+    struct conexao_servidor *conexao = &servidor->conexoes[descritor];
+    int indice = conexao->mesa;
 
-void aumentar_truco(int *valor_partida)
-{
-    if (*valor_partida == 12)
-        printf("Não é possível pedir pontuação maior que 12\n");
-    else
-        *valor_partida += 3;
-}
+    if (!conexao->aberta)
+        return;
+    conexao->aberta = false;
+    conexao->mesa = -1;
+    close(descritor);
 
-struct carta escolher_acao(struct jogador *jogador, int *valor_partida, struct carta vira, bool *aceitou_truco, int *time_que_pediu_truco, int time_atual, struct jogador proximo_jogador)
-{
-    int opcao = 0;
-    struct carta carta_jogada;
-    while (opcao != 2)
+    if (indice < 0)
+        return;
+    struct mesa_servidor *mesa = servidor->mesas[indice];
+
+    for (int i = 0; i < mesa->conectados; i++)
+        if (mesa->conexoes[i] == descritor)
+            mesa->conexoes[i] = -1;
+
+    if (!mesa->em_andamento)
     {
-        if (*valor_partida != 1 && !(*aceitou_truco))
-        {
-            aceitar_truco(aceitou_truco, proximo_jogador);
-            *valor_partida = !(*aceitou_truco) ? 1 : (*valor_partida);
-            if (!(*aceitou_truco))
-                opcao = 2;
-        }
-        else
-        {
-            printf("\n\n--------------------------------------\n");
-            printf("      Vira da rodada: %c%c\n", SIMBOLOS[vira.numero], NAIPES[vira.naipe]);
-            printf("--------------------------------------\n");
-            printf("----------Vez de %s----------\n", jogador->nome);
-            printf("O que você deseja fazer:\n 1:Exibir suas cartas\n 2:Jogar alguma carta\n ");
-            if (*aceitou_truco)
-                printf("3:Aumentar valor do truco\n");
-            else
-                printf("3:Pedir truco\n");
-            scanf("%d", &opcao);
-            switch (opcao)
-            {
-            case 1:
-            {
-                exibir_mao(jogador->mao, jogador->qtd_cartas_restantes);
-                break;
-            }
-            case 2:
+        // Mesa ainda esperando: libera o lugar para a próxima conexão
+        int ocupados = 0;
+        for (int i = 0; i < mesa->conectados; i++)
+            if (mesa->conexoes[i] >= 0)
             {
-                carta_jogada = jogar_carta(jogador);
-                printf("%s jogou: ", jogador->nome);
-                exibir_carta(carta_jogada);
-                printf("\n");
-                break;
-            }
-            case 3:
-                if (!(*aceitou_truco))
-                    pedir_truco(valor_partida);
-                else
-                    aumentar_truco(valor_partida);
-                *time_que_pediu_truco = time_atual;
-                printf("Agora a rodada vale %d pontos!\n", *valor_partida);
-                break;
-            default:
-                printf("Opção inválida!!!");
+                mesa->conexoes[ocupados] = mesa->conexoes[i];
+                servidor->conexoes[mesa->conexoes[ocupados]].time = ocupados % 2 + 1;
+                ocupados++;
             }
+        mesa->conectados = ocupados;
+        if (ocupados == 0)
+        {
+            servidor->aguardando[mesa->numero_jogadores][mesa->humanos] = -1;
+            encerrar_mesa(servidor, indice);
         }
+        return;
     }
-    return carta_jogada;
-}
 
-void embaralhar(struct jogador time_1[], struct jogador time_2[], int numero_jogadores_cada_time, struct carta cartas_em_jogo[], int qtd_cartas, struct carta *vira)
-{
-    int j = 0;
-    zerar_cartas_em_jogo(cartas_em_jogo, qtd_cartas);
-    for (int i = 0; i < numero_jogadores_cada_time; i++)
+    // A mão lê os jogadores do registro da partida, então basta trocá-los ali
+    for (int t = 0; t < 2; t++)
+        for (int i = 0; i < mesa->partida.qtd_jogadores_cada_time; i++)
+            if (mesa->partida.jogadores[t][i].decidir == NULL && mesa->partida.jogadores[t][i].conexao == descritor)
+                mesa->partida.jogadores[t][i].decidir = servidor->robo;
+
+    if (mesa->na_fila_prazos && jogador_do_assento(&mesa->mao, assento_da_vez(&mesa->mao))->decidir != NULL)
     {
-        distribuir_cartas_jogador(&time_1[i], cartas_em_jogo, &j);
-        distribuir_cartas_jogador(&time_2[i], cartas_em_jogo, &j);
+        remover_prazo(servidor, indice);
+        avancar_mesa(servidor, indice);
     }
-    *vira = cartas_em_jogo[j + 1] = troca_repetida(criar_carta_aleatoria(), cartas_em_jogo);
 }
 
-char comparar_cartas(struct carta a, struct carta b, struct carta vira)
+/**
+ * @brief Interpreta um comando de uma conexão (uma linha, sem a quebra).
+ */
+static void processar_comando(struct servidor *servidor, int descritor, char *linha)
 {
-    struct carta manilha;
-    if (vira.numero == 10)
+    struct conexao_servidor *conexao = &servidor->conexoes[descritor];
+    char comando[16] = "", argumento[16] = "";
+    int numero_jogadores = 0, humanos = 1;
+
+    sscanf(linha, "%15s %15s", comando, argumento);
+
+    if (strcmp(comando, "ENTRAR") == 0)
     {
-        manilha.numero = 1;
+        int lidos = sscanf(linha, "%*s %d %d", &numero_jogadores, &humanos);
+        if (lidos < 1 || (numero_jogadores != 2 && numero_jogadores != 4 && numero_jogadores != 6) || humanos < 1 || humanos > numero_jogadores)
+            enviar(servidor, descritor, "ERRO uso: ENTRAR <2|4|6> [humanos]\n");
+        else if (conexao->mesa >= 0)
+            enviar(servidor, descritor, "ERRO já está em uma mesa\n");
+        else
+            entrar_mesa(servidor, descritor, numero_jogadores, humanos);
+        return;
     }
-    else
+    if (strcmp(comando, "SAIR") == 0)
     {
-        manilha.numero = vira.numero + 1;
+        fechar_conexao(servidor, descritor);
+        return;
     }
 
-    char resultado;
-    if (a.numero == manilha.numero && b.numero == manilha.numero)
+    struct acao acao = {ACAO_JOGAR_CARTA, {0}, 0};
+    if (strcmp(comando, "JOGAR") == 0)
     {
-        if (a.naipe > b.naipe)
-        {
-            resultado = '>';
-        }
-        else
+        if (!ler_carta(argumento, &acao.carta))
         {
-            resultado = '<';
+            enviar(servidor, descritor, "ERRO carta inválida\n");
+            return;
         }
     }
-    else if (a.numero == manilha.numero)
-    {
-        resultado = '>';
-    }
-    else if (b.numero == manilha.numero)
+    else if (strcmp(comando, "TRUCO") == 0)
+        acao.tipo = ACAO_PEDIR_TRUCO;
+    else if (strcmp(comando, "ACEITAR") == 0)
+        acao.tipo = ACAO_ACEITAR_TRUCO;
+    else if (strcmp(comando, "CORRER") == 0)
+        acao.tipo = ACAO_RECUSAR_TRUCO;
+    else
     {
-        resultado = '<';
+        enviar(servidor, descritor, "ERRO comando desconhecido\n");
+        return;
     }
-    else if (a.numero > b.numero)
+
+    int indice = conexao->mesa;
+    struct mesa_servidor *mesa = indice >= 0 ? servidor->mesas[indice] : NULL;
+    if (mesa == NULL || !mesa->em_andamento)
     {
-        resultado = '>';
+        enviar(servidor, descritor, "ERRO não está em uma partida\n");
+        return;
     }
-    else if (b.numero > a.numero)
+
+    const struct jogador *jogador = jogador_do_assento(&mesa->mao, assento_da_vez(&mesa->mao));
+    if (jogador->decidir != NULL || jogador->conexao != descritor)
     {
-        resultado = '<';
+        enviar(servidor, descritor, "ERRO não é a sua vez\n");
+        return;
     }
-    else
+
+    if (acao.tipo == ACAO_PEDIR_TRUCO)
+        acao.valor = mesa->mao.valor_partida == 1 ? 3 : mesa->mao.valor_partida + 3;
+    if (!executar_acao_mesa(servidor, mesa, acao))
     {
-        resultado = '=';
+        enviar(servidor, descritor, "ERRO jogada inválida\n");
+        return;
     }
-    return resultado;
+    servidor->acoes_remotas++;
+    remover_prazo(servidor, indice);
+    avancar_mesa(servidor, indice);
 }
 
-struct carta troca_repetida(struct carta nova_carta, struct carta cartas_em_jogo[])
+static void ler_conexao(struct servidor *servidor, int descritor)
 {
-    while (eh_repetida(nova_carta, cartas_em_jogo))
+    struct conexao_servidor *conexao = &servidor->conexoes[descritor];
+
+    for (;;)
     {
-        nova_carta = criar_carta_aleatoria();
+        ssize_t lidos = read(descritor, conexao->entrada + conexao->qtd_entrada, (size_t)(TAMANHO_ENTRADA_CONEXAO - conexao->qtd_entrada));
+        if (lidos == 0 || (lidos < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            fechar_conexao(servidor, descritor);
+            return;
+        }
+        if (lidos < 0)
+            return;
+        conexao->qtd_entrada += (int)lidos;
+
+        // Processa cada linha completa; uma linha maior que o buffer encerra a conexão
+        int inicio = 0;
+        for (int i = 0; i < conexao->qtd_entrada && conexao->aberta; i++)
+        {
+            if (conexao->entrada[i] != '\n')
+                continue;
+            conexao->entrada[i] = '\0';
+            if (i > inicio && conexao->entrada[i - 1] == '\r')
+                conexao->entrada[i - 1] = '\0';
+            processar_comando(servidor, descritor, conexao->entrada + inicio);
+            inicio = i + 1;
+        }
+        if (!conexao->aberta)
+            return;
+        if (inicio == 0 && conexao->qtd_entrada == TAMANHO_ENTRADA_CONEXAO)
+        {
+            fechar_conexao(servidor, descritor);
+            return;
+        }
+        memmove(conexao->entrada, conexao->entrada + inicio, (size_t)(conexao->qtd_entrada - inicio));
+        conexao->qtd_entrada -= inicio;
     }
-    return nova_carta;
 }
 
-bool eh_repetida(struct carta nova_carta, struct carta cartas_em_jogo[])
+/**
+ * @brief Envia o que estiver pendente; o que não couber no socket espera o próximo EPOLLOUT.
+ */
+static void enviar_pendentes(struct servidor *servidor, int descritor)
 {
-    int i = 0;
-    while (cartas_em_jogo[i].numero != -1)
+    struct conexao_servidor *conexao = &servidor->conexoes[descritor];
+    int enviados = 0;
+
+    if (!conexao->aberta)
+        return;
+    if (conexao->qtd_saida >= TAMANHO_SAIDA_CONEXAO)
     {
-        if (cartas_iguais(nova_carta, cartas_em_jogo[i]))
+        fechar_conexao(servidor, descritor);
+        return;
+    }
+
+    while (enviados < conexao->qtd_saida)
+    {
+        ssize_t escritos = write(descritor, conexao->saida + enviados, (size_t)(conexao->qtd_saida - enviados));
+        if (escritos < 0)
         {
-            return true;
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                fechar_conexao(servidor, descritor);
+                return;
+            }
+            break;
         }
-        i++;
+        enviados += (int)escritos;
     }
-    return false;
-}
 
-void zerar_cartas_em_jogo(struct carta *cartas, int qtd)
-{
-    for (int i = 0; i < qtd; i++)
+    memmove(conexao->saida, conexao->saida + enviados, (size_t)(conexao->qtd_saida - enviados));
+    conexao->qtd_saida -= enviados;
+
+    if ((conexao->qtd_saida > 0) != conexao->esperando_escrita)
     {
-        cartas[i].numero = -1;
+        struct epoll_event evento = {.events = EPOLLIN | (conexao->qtd_saida > 0 ? EPOLLOUT : 0), .data.fd = descritor};
+        conexao->esperando_escrita = conexao->qtd_saida > 0;
+        epoll_ctl(servidor->epoll, EPOLL_CTL_MOD, descritor, &evento);
     }
 }
 
-bool cartas_iguais(struct carta primeira_carta, struct carta segunda_carta)
+static void aceitar_conexoes(struct servidor *servidor)
 {
-    return primeira_carta.numero == segunda_carta.numero && primeira_carta.naipe == segunda_carta.naipe;
+    for (;;)
+    {
+        int descritor = accept(servidor->escuta, NULL, NULL);
+        if (descritor < 0)
+            return;
+        fcntl(descritor, F_SETFL, fcntl(descritor, F_GETFL) | O_NONBLOCK);
+        if (descritor >= servidor->max_conexoes)
+        {
+            close(descritor);
+            continue;
+        }
+
+        int sim = 1;
+        setsockopt(descritor, IPPROTO_TCP, TCP_NODELAY, &sim, sizeof(sim)); // Ignorado em sockets Unix
+        struct conexao_servidor *conexao = &servidor->conexoes[descritor];
+        memset(conexao, 0, offsetof(struct conexao_servidor, entrada));
+        conexao->aberta = true;
+        conexao->mesa = -1;
+
+        struct epoll_event evento = {.events = EPOLLIN, .data.fd = descritor};
+        epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, descritor, &evento);
+    }
 }
 
-void copiar_time(struct jogador timea[], struct jogador timeb[], int qtd_jogadores)
+/**
+ * @brief Joga pelos jogadores remotos cujo prazo acabou, com o robô do servidor.
+ */
+static void verificar_prazos(struct servidor *servidor, double agora)
 {
-    for (int i = 0; i < qtd_jogadores; i++)
+    while (servidor->primeiro_prazo >= 0 && servidor->mesas[servidor->primeiro_prazo]->prazo <= agora)
     {
-        timea[i] = timeb[i];
+        int indice = servidor->primeiro_prazo;
+        struct mesa_servidor *mesa = servidor->mesas[indice];
+        const struct jogador *jogador = jogador_do_assento(&mesa->mao, assento_da_vez(&mesa->mao));
+
+        remover_prazo(servidor, indice);
+        enviar(servidor, jogador->conexao, "TEMPO\n");
+        executar_acao_mesa(servidor, mesa, servidor->robo(&mesa->mao, jogador));
+        servidor->jogadas_por_tempo++;
+        avancar_mesa(servidor, indice);
     }
 }
 
-void trocar_comeca(struct jogador time1[], struct jogador time2[], int posicao_nova, int time_novo, int qtd_jogadores)
- {
+int executar_servidor(const char *endereco, double segundos_por_turno, uint64_t semente, decisao_jogador robo)
+{
+    struct servidor servidor = {0};
+    struct epoll_event eventos[256];
+
+    servidor.max_conexoes = elevar_limite_descritores();
+    servidor.conexoes = calloc((size_t)servidor.max_conexoes, sizeof(*servidor.conexoes));
+    servidor.fila_envio = malloc((size_t)servidor.max_conexoes * sizeof(*servidor.fila_envio));
+    servidor.segundos_por_turno = segundos_por_turno;
+    servidor.semente = semente;
+    servidor.robo = robo;
+    servidor.primeiro_prazo = -1;
+    servidor.ultimo_prazo = -1;
+    memset(servidor.aguardando, -1, sizeof(servidor.aguardando));
 
-    struct jogador temp[qtd_jogadores];
-    int i, j = 0;
-    // Garante que posicao_nova está dentro dos limites
-    if (posicao_nova >= qtd_jogadores) {
-        posicao_nova = qtd_jogadores - 1;
+    servidor.escuta = abrir_socket(endereco, true);
+    servidor.epoll = epoll_create1(0);
+    if (servidor.conexoes == NULL || servidor.fila_envio == NULL || servidor.escuta < 0 || servidor.epoll < 0)
+    {
+        printf("Não foi possível iniciar o servidor em %s.\n", endereco);
+        free(servidor.conexoes);
+        free(servidor.fila_envio);
+        return 1;
     }
 
-    // Sempre troca o jogador inicial do time vencedor para a posição 0
-    if (time_novo == 1) {
+    struct epoll_event evento = {.events = EPOLLIN, .data.fd = servidor.escuta};
+    epoll_ctl(servidor.epoll, EPOLL_CTL_ADD, servidor.escuta, &evento);
+    signal(SIGINT, interromper_servidor);
+    signal(SIGTERM, interromper_servidor);
+    signal(SIGPIPE, SIG_IGN);
 
-        // Copia de posicao_escolhida até o fim
-        for (i = posicao_nova; i < qtd_jogadores; i++) {
-            temp[j++] = time1[i];
-        }
+    printf("Servidor em %s (prazo de %.0f ms por jogada, até %d conexões).\n", endereco, segundos_por_turno * 1e3, servidor.max_conexoes);
+    fflush(stdout);
 
-        // Depois, do início até posicao_escolhida - 1
-        for (i = 0; i < posicao_nova; i++) {
-            temp[j++] = time1[i];
-        }
+    double inicio = tempo_atual(), ultimo_relatorio = inicio;
+    long long acoes_relatorio = 0;
+    while (!servidor_interrompido)
+    {
+        // Dorme até o próximo prazo (ou até o próximo relatório)
+        double agora = tempo_atual();
+        double espera = ultimo_relatorio + 5.0 - agora;
+        if (servidor.primeiro_prazo >= 0 && servidor.mesas[servidor.primeiro_prazo]->prazo - agora < espera)
+            espera = servidor.mesas[servidor.primeiro_prazo]->prazo - agora;
+        int qtd = epoll_wait(servidor.epoll, eventos, 256, espera > 0 ? (int)(espera * 1e3) + 1 : 0);
 
-        // Copia de volta para o vetor original
-        copiar_time(time1, temp, qtd_jogadores);
+        for (int i = 0; i < qtd; i++)
+        {
+            int descritor = eventos[i].data.fd;
+            if (descritor == servidor.escuta)
+                aceitar_conexoes(&servidor);
+            else if (!servidor.conexoes[descritor].aberta)
+                continue;
+            else if (eventos[i].events & (EPOLLERR | EPOLLHUP) && !(eventos[i].events & EPOLLIN))
+                fechar_conexao(&servidor, descritor);
+            else
+            {
+                if (eventos[i].events & EPOLLIN)
+                    ler_conexao(&servidor, descritor);
+                if (eventos[i].events & EPOLLOUT)
+                    enviar_pendentes(&servidor, descritor);
+            }
+        }
 
-        j = 0;
+        agora = tempo_atual();
+        verificar_prazos(&servidor, agora);
 
-        // Copia de posicao_escolhida até o fim
-        for (i = posicao_nova; i < qtd_jogadores; i++) {
-            temp[j++] = time2[i];
+        // Envia tudo o que foi produzido nesta volta, uma escrita por conexão
+        for (int i = 0; i < servidor.qtd_fila_envio; i++)
+        {
+            servidor.conexoes[servidor.fila_envio[i]].na_fila_envio = false;
+            enviar_pendentes(&servidor, servidor.fila_envio[i]);
         }
+        servidor.qtd_fila_envio = 0;
 
-        // Depois, do início até posicao_escolhida - 1
-        for (i = 0; i < posicao_nova; i++) {
-            temp[j++] = time2[i];
+        if (agora - ultimo_relatorio >= 5.0)
+        {
+            printf("Mesas em andamento: %lld | ações/s: %.0f | jogadas por tempo: %lld\n", servidor.mesas_em_andamento,
+                   (double)(servidor.acoes - acoes_relatorio) / (agora - ultimo_relatorio), servidor.jogadas_por_tempo);
+            fflush(stdout);
+            acoes_relatorio = servidor.acoes;
+            ultimo_relatorio = agora;
         }
+    }
+
+    double segundos = tempo_atual() - inicio;
+    printf("\n------ Servidor ------\n");
+    printf("Partidas iniciadas: %lld\n", servidor.partidas_iniciadas);
+    printf("Ações: %lld (%lld remotas, %lld por tempo), %.0f ações/s\n", servidor.acoes, servidor.acoes_remotas, servidor.jogadas_por_tempo,
+           segundos > 0 ? (double)servidor.acoes / segundos : 0.0);
+    printf("----------------------\n");
+
+    for (int descritor = 0; descritor < servidor.max_conexoes; descritor++)
+        if (servidor.conexoes[descritor].aberta)
+            close(descritor);
+    for (int i = 0; i < servidor.qtd_mesas; i++)
+        free(servidor.mesas[i]);
+    free(servidor.mesas);
+    free(servidor.mesas_livres);
+    free(servidor.conexoes);
+    free(servidor.fila_envio);
+    close(servidor.escuta);
+    close(servidor.epoll);
+    if (!endereco_tcp(endereco))
+        unlink(endereco);
+    return 0;
+}
+
+struct cliente_carga
+{
+    int qtd_entrada;           // Bytes em 'entrada'.
+    bool aguardando;           // Uma jogada foi enviada e a resposta ainda não chegou.
+    double enviado_em;         // Instante do envio da última jogada.
+    char entrada[1024];        // Mensagens recebidas, até a próxima quebra de linha.
+};
+
+/**
+ * @brief Envia uma linha do cliente de carga; falhas contam como erro.
+ */
+static bool enviar_cliente(int descritor, const char *linha)
+{
+    size_t tamanho = strlen(linha);
+    return write(descritor, linha, tamanho) == (ssize_t)tamanho;
+}
 
-        // Copia de volta para o vetor original
-        copiar_time(time2, temp, qtd_jogadores);
+int executar_teste_carga(const char *endereco, int qtd_mesas, int numero_jogadores, double segundos, uint64_t semente)
+{
+    enum
+    {
+        BALDES_LATENCIA = 1000000 // Um balde por microssegundo, até 1 s
+    };
+    int limite = elevar_limite_descritores();
+    int *descritores = malloc((size_t)qtd_mesas * sizeof(int));
+    struct cliente_carga *clientes = calloc((size_t)limite, sizeof(*clientes));
+    long long *latencias = calloc(BALDES_LATENCIA + 1, sizeof(long long));
+    struct gerador gerador;
+    struct epoll_event eventos[256];
+    char entrar[32];
+    long long acoes = 0, partidas = 0, erros = 0, amostras = 0;
+    int epoll = epoll_create1(0);
+    int conectadas = 0;
+
+    if (descritores == NULL || clientes == NULL || latencias == NULL || epoll < 0)
+    {
+        printf("Memória insuficiente para o teste de carga.\n");
+        free(descritores);
+        free(clientes);
+        free(latencias);
+        return 1;
     }
-    else { // time_novo == 2
 
-        // Copia de posicao_escolhida até o fim
-        for (i = posicao_nova; i < qtd_jogadores; i++) {
-            temp[j++] = time2[i];
-        }
+    signal(SIGPIPE, SIG_IGN);
+    semear_gerador(&gerador, semente, 0);
+    snprintf(entrar, sizeof(entrar), "ENTRAR %d 1\n", numero_jogadores);
 
-        // Depois, do início até posicao_escolhida - 1
-        for (i = 0; i < posicao_nova; i++) {
-            temp[j++] = time2[i];
+    for (int i = 0; i < qtd_mesas; i++)
+    {
+        int descritor = abrir_socket(endereco, false);
+        if (descritor < 0 || descritor >= limite)
+        {
+            if (descritor >= 0)
+                close(descritor);
+            break;
         }
+        struct epoll_event evento = {.events = EPOLLIN, .data.fd = descritor};
+        epoll_ctl(epoll, EPOLL_CTL_ADD, descritor, &evento);
+        descritores[conectadas++] = descritor;
+    }
+    if (conectadas == 0)
+    {
+        printf("Não foi possível conectar a %s.\n", endereco);
+        free(descritores);
+        free(clientes);
+        free(latencias);
+        close(epoll);
+        return 1;
+    }
 
-        // Copia de volta para o vetor original
-        copiar_time(time2, temp, qtd_jogadores);
+    double inicio = tempo_atual();
+    double fim = inicio + segundos;
+    for (int i = 0; i < conectadas; i++)
+        erros += !enviar_cliente(descritores[i], entrar);
 
-        j = 0;
+    while (tempo_atual() < fim)
+    {
+        int qtd = epoll_wait(epoll, eventos, 256, 100);
+        for (int e = 0; e < qtd; e++)
+        {
+            int descritor = eventos[e].data.fd;
+            struct cliente_carga *cliente = &clientes[descritor];
+            ssize_t lidos = read(descritor, cliente->entrada + cliente->qtd_entrada, sizeof(cliente->entrada) - 1 - (size_t)cliente->qtd_entrada);
+            if (lidos <= 0)
+            {
+                if (lidos == 0 || (errno != EAGAIN && errno != EINTR))
+                {
+                    erros++;
+                    epoll_ctl(epoll, EPOLL_CTL_DEL, descritor, NULL);
+                }
+                continue;
+            }
+            cliente->qtd_entrada += (int)lidos;
+            cliente->entrada[cliente->qtd_entrada] = '\0';
 
-        if(posicao_nova == qtd_jogadores)
-            posicao_nova = 0;
-        else   
-            posicao_nova++;
-        
-         // Copia de posicao_escolhida até o fim
-        for (i = posicao_nova; i < qtd_jogadores; i++) {
-            temp[j++] = time1[i];
-        }
+            char *linha = cliente->entrada;
+            char *quebra;
+            while ((quebra = strchr(linha, '\n')) != NULL)
+            {
+                *quebra = '\0';
+                bool vez = strncmp(linha, "VEZ ", 4) == 0;
+                bool terminou = strncmp(linha, "FIM ", 4) == 0;
 
-        // Depois, do início até posicao_escolhida - 1
-        for (i = 0; i < posicao_nova; i++) {
-            temp[j++] = time1[i];
+                if ((vez || terminou) && cliente->aguardando)
+                {
+                    long long microssegundos = (long long)((tempo_atual() - cliente->enviado_em) * 1e6);
+                    latencias[microssegundos < BALDES_LATENCIA ? microssegundos : BALDES_LATENCIA]++;
+                    amostras++;
+                    cliente->aguardando = false;
+                }
+
+                if (strncmp(linha, "ERRO", 4) == 0)
+                    erros++;
+                else if (terminou)
+                {
+                    partidas++;
+                    erros += !enviar_cliente(descritor, entrar);
+                }
+                else if (vez)
+                {
+                    // Joga ao acaso: responde o truco com 50%, pede truco em 1 de 8 e senão joga uma carta qualquer
+                    char resposta[32];
+                    int valor, pode_truco, lidas;
+                    char cartas[3][3];
+                    if (strncmp(linha, "VEZ RESPONDER", 13) == 0)
+                        snprintf(resposta, sizeof(resposta), "%s\n", gerar_numero_aleatorio(&gerador, 1) ? "ACEITAR" : "CORRER");
+                    else if ((lidas = sscanf(linha, "VEZ JOGAR %d %d %2s %2s %2s", &valor, &pode_truco, cartas[0], cartas[1], cartas[2])) >= 3)
+                    {
+                        if (pode_truco && gerar_numero_aleatorio(&gerador, 7) == 0)
+                            snprintf(resposta, sizeof(resposta), "TRUCO\n");
+                        else
+                            snprintf(resposta, sizeof(resposta), "JOGAR %s\n", cartas[gerar_numero_aleatorio(&gerador, lidas - 3)]);
+                    }
+                    else
+                    {
+                        erros++;
+                        resposta[0] = '\0';
+                    }
+                    if (resposta[0] != '\0')
+                    {
+                        cliente->enviado_em = tempo_atual();
+                        cliente->aguardando = true;
+                        erros += !enviar_cliente(descritor, resposta);
+                        acoes++;
+                    }
+                }
+                linha = quebra + 1;
+            }
+            cliente->qtd_entrada = (int)strlen(linha);
+            memmove(cliente->entrada, linha, (size_t)cliente->qtd_entrada);
         }
+    }
+    double decorrido = tempo_atual() - inicio;
 
-        // Copia de volta para o vetor original
-        copiar_time(time1, temp, qtd_jogadores);
-        
+    // Percentis a partir do histograma de latências
+    long long p50 = -1, p99 = -1, maximo = 0, acumulado = 0;
+    for (long long b = 0; b <= BALDES_LATENCIA; b++)
+    {
+        if (latencias[b] == 0)
+            continue;
+        acumulado += latencias[b];
+        maximo = b;
+        if (p50 < 0 && acumulado * 100 >= amostras * 50)
+            p50 = b;
+        if (p99 < 0 && acumulado * 100 >= amostras * 99)
+            p99 = b;
     }
- }
+
+    printf("\n------ Teste de carga ------\n");
+    printf("Mesas simultâneas: %d (%d jogadores, 1 remoto por mesa) em %s\n", conectadas, numero_jogadores, endereco);
+    printf("Duração: %.2f s | partidas concluídas: %lld | erros: %lld\n", decorrido, partidas, erros);
+    printf("Ações remotas: %lld (%.0f ações/s)\n", acoes, (double)acoes / decorrido);
+    printf("Latência do turno: p50 %lld us, p99 %lld us, máx %lld us%s\n", p50, p99, maximo, maximo >= BALDES_LATENCIA ? "+" : "");
+    printf("----------------------------\n");
+
+    for (int i = 0; i < conectadas; i++)
+        close(descritores[i]);
+    close(epoll);
+    free(descritores);
+    free(clientes);
+    free(latencias);
+    return 0;
+}
+
+#else
+
+int executar_servidor(const char *endereco, double segundos_por_turno, uint64_t semente, decisao_jogador robo)
+{
+    (void)endereco;
+    (void)segundos_por_turno;
+    (void)semente;
+    (void)robo;
+    printf("O servidor usa epoll e só está disponível no Linux.\n");
+    return 1;
+}
+
+int executar_teste_carga(const char *endereco, int qtd_mesas, int numero_jogadores, double segundos, uint64_t semente)
+{
+    (void)endereco;
+    (void)qtd_mesas;
+    (void)numero_jogadores;
+    (void)segundos;
+    (void)semente;
+    printf("O teste de carga usa epoll e só está disponível no Linux.\n");
+    return 1;
+}
+
+#endif